@@ -3,51 +3,72 @@
  * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
  */
 
+#include <stdint.h>
 #include <string.h>
-#include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
 
 #include "buffer.h"
 
+// above this size buffers grow by half instead of doubling
+#define LARGE_BUFFER_SIZE (64 << 20)
+
 void init_char_buffer(struct CharBuffer* buffer, size_t initial_depth_buffer_size) {
     buffer->data = malloc(initial_depth_buffer_size);
-    buffer->memory_buffer_length = initial_depth_buffer_size;
+    // failed allocation is retried when the buffer is first written to
+    buffer->memory_buffer_length = buffer->data != NULL ? initial_depth_buffer_size : 0;
     buffer->index = 0;
+#ifdef CHOMPJS_STATS
+    buffer->growths = 0;
+#endif
 }
 
 void release_char_buffer(struct CharBuffer* buffer) {
     free(buffer->data);
 }
 
-void check_capacity(struct CharBuffer* buffer, size_t to_save) {
-    if(buffer->index + to_save >= buffer->memory_buffer_length) {
-        buffer->data = realloc(buffer->data, 2*buffer->memory_buffer_length);
-        buffer->memory_buffer_length *= 2;
+bool check_capacity(struct CharBuffer* buffer, size_t to_save) {
+    // one more character is always kept free
+    if(to_save < buffer->memory_buffer_length - buffer->index) {
+        return true;
+    }
+    if(to_save >= SIZE_MAX - buffer->index) {
+        return false;
+    }
+    size_t needed = buffer->index + to_save + 1;
+    size_t length = buffer->memory_buffer_length;
+    size_t growth = length < LARGE_BUFFER_SIZE ? length : length / 2;
+    size_t new_length = growth < SIZE_MAX - length ? length + growth : SIZE_MAX;
+    if(new_length < needed) {
+        new_length = needed;
     }
+    char* data = realloc(buffer->data, new_length);
+    if(data == NULL) {
+        return false;
+    }
+    buffer->data = data;
+    buffer->memory_buffer_length = new_length;
+#ifdef CHOMPJS_STATS
+    buffer->growths += 1;
+#endif
+    return true;
 }
 
-void push(struct CharBuffer* buffer, char value) {
-    check_capacity(buffer, 1);
+bool push(struct CharBuffer* buffer, char value) {
+    if(!check_capacity(buffer, 1)) {
+        return false;
+    }
     buffer->data[buffer->index] = value;
     buffer->index += 1;
+    return true;
 }
 
-void push_string(struct CharBuffer* buffer, const char* value, size_t len) {
-    check_capacity(buffer, len);
+bool push_string(struct CharBuffer* buffer, const char* value, size_t len) {
+    if(!check_capacity(buffer, len)) {
+        return false;
+    }
     memcpy(buffer->data + buffer->index, value, len);
     buffer->index += len;
-}
-
-void push_number(struct CharBuffer* buffer, long value) {
-    int size_in_chars;
-    if (value == 0) {
-        size_in_chars = 2;
-    } else {
-        size_in_chars = floor(log10(value)) + 2;
-    }
-    check_capacity(buffer, size_in_chars);
-    buffer->index += sprintf(buffer->data + buffer->index, "%ld", value);
+    return true;
 }
 
 void pop(struct CharBuffer* buffer) {
@@ -55,6 +76,9 @@ void pop(struct CharBuffer* buffer) {
 }
 
 char top(struct CharBuffer* buffer) {
+    if(buffer->index == 0) {
+        return '\0';
+    }
     return buffer->data[buffer->index-1];
 }
 
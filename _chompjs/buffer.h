@@ -16,19 +16,27 @@ struct CharBuffer {
     char* data;
     size_t memory_buffer_length;
     size_t index;
+#ifdef CHOMPJS_STATS
+    // number of reallocations
+    size_t growths;
+#endif
 };
 
 void init_char_buffer(struct CharBuffer* buffer, size_t initial_depth_buffer_size);
 
 void release_char_buffer(struct CharBuffer* buffer);
 
-void check_capacity(struct CharBuffer* buffer, size_t to_save);
-
-void push(struct CharBuffer* buffer, char value);
+/**
+    Make room for `to_save` more characters. False if memory can't be allocated,
+    buffer is left unchanged then
+*/
+bool check_capacity(struct CharBuffer* buffer, size_t to_save);
 
-void push_string(struct CharBuffer* buffer, const char* value, size_t len);
+/** Append a character, false and nothing is written if memory can't be allocated */
+bool push(struct CharBuffer* buffer, char value);
 
-void push_number(struct CharBuffer* buffer, long value);
+/** Append a string, false and nothing is written if memory can't be allocated */
+bool push_string(struct CharBuffer* buffer, const char* value, size_t len);
 
 void pop(struct CharBuffer* buffer);
 
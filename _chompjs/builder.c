@@ -0,0 +1,619 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#include "builder.h"
+#include "number.h"
+
+#include <limits.h>
+#include <string.h>
+
+#define INITIAL_BUILDER_DEPTH 16
+#define SMALL_NUMBER_LENGTH 64
+#define INITIAL_SCRATCH_SIZE 256
+
+// sizes of direct-mapped caches of strings, a colliding string replaces the old one
+#define KEY_CACHE_SIZE 512
+#define VALUE_CACHE_SIZE 256
+// longer strings are rarely repeated
+#define MAX_CACHED_LENGTH 32
+// key sequences are remembered for objects nested up to this depth
+#define MAX_SHAPE_DEPTH 8
+#define MAX_SHAPE_KEYS 32
+
+/**
+    Keys seen at every position of objects at given depth. Consecutive
+    objects usually share their layout, so a key is compared with the one
+    at the same position of the previous object before looking it up
+    in the cache
+*/
+struct Shape {
+    PyObject* keys[MAX_SHAPE_KEYS];
+};
+
+/**
+    Strings reused between objects built by the same builder. Reused keys
+    keep their hash, so dict insertion doesn't compute it again either.
+    Only short ASCII strings without escape sequences are cached
+*/
+struct BuilderCache {
+    struct Shape shapes[MAX_SHAPE_DEPTH];
+    PyObject* keys[KEY_CACHE_SIZE];
+    PyObject* values[VALUE_CACHE_SIZE];
+};
+
+/**
+    Position inside currently built container:
+    * EXPECT_FIRST - right after "[" or "{"
+    * EXPECT_NEXT - right after ","
+    * EXPECT_CLOSE - after "," directly following "[" or "{"
+    * AFTER_VALUE - after complete value, or key-value pair
+    * AFTER_KEY - after object key
+    * EXPECT_VALUE - after ":"
+*/
+enum LevelState {
+    EXPECT_FIRST, EXPECT_NEXT, EXPECT_CLOSE, AFTER_VALUE, AFTER_KEY, EXPECT_VALUE
+};
+
+static bool handle_token(void* context, TokenType type, const char* data, size_t length);
+
+void init_builder(struct Builder* builder, struct Parser* parser, bool stop_on_error) {
+    builder->levels = NULL;
+    builder->depth = 0;
+    builder->capacity = 0;
+    builder->result = NULL;
+    builder->failed = false;
+    builder->cache = NULL;
+    builder->cache_values = false;
+    init_char_buffer(&builder->scratch, INITIAL_SCRATCH_SIZE);
+    builder->sink.handle = handle_token;
+    builder->sink.context = builder;
+    builder->sink.consumes_values = true;
+    attach_builder(builder, parser, stop_on_error);
+}
+
+void attach_builder(struct Builder* builder, struct Parser* parser, bool stop_on_error) {
+    builder->stop_on_error = stop_on_error;
+    parser->sink = &builder->sink;
+}
+
+void reset_builder(struct Builder* builder) {
+    while(builder->depth > 0) {
+        builder->depth -= 1;
+        Py_CLEAR(builder->levels[builder->depth].key);
+        Py_CLEAR(builder->levels[builder->depth].container);
+    }
+    Py_CLEAR(builder->result);
+    builder->failed = false;
+}
+
+static void clear_builder_cache(struct Builder* builder) {
+    struct BuilderCache* cache = builder->cache;
+    if(cache == NULL) {
+        return;
+    }
+    for(size_t depth = 0; depth < MAX_SHAPE_DEPTH; ++depth) {
+        for(size_t i = 0; i < MAX_SHAPE_KEYS; ++i) {
+            Py_XDECREF(cache->shapes[depth].keys[i]);
+        }
+    }
+    for(size_t i = 0; i < KEY_CACHE_SIZE; ++i) {
+        Py_XDECREF(cache->keys[i]);
+    }
+    for(size_t i = 0; i < VALUE_CACHE_SIZE; ++i) {
+        Py_XDECREF(cache->values[i]);
+    }
+    PyMem_Free(cache);
+    builder->cache = NULL;
+}
+
+void release_builder(struct Builder* builder) {
+    reset_builder(builder);
+    clear_builder_cache(builder);
+    PyMem_Free(builder->levels);
+    builder->levels = NULL;
+    builder->capacity = 0;
+    release_char_buffer(&builder->scratch);
+}
+
+PyObject* builder_result(struct Builder* builder) {
+    if(builder->failed || builder->depth > 0 || builder->result == NULL) {
+        return NULL;
+    }
+    Py_INCREF(builder->result);
+    return builder->result;
+}
+
+static int hex_value(char c) {
+    if(c >= '0' && c <= '9') {
+        return c - '0';
+    } else if(c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if(c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static int read_hex4(const char* s) {
+    int result = 0;
+    for(int i = 0; i < 4; ++i) {
+        int digit = hex_value(s[i]);
+        if(digit < 0) {
+            return -1;
+        }
+        result = (result << 4) | digit;
+    }
+    return result;
+}
+
+static size_t write_utf8(char* out, unsigned int code_point) {
+    if(code_point < 0x80) {
+        out[0] = (char)code_point;
+        return 1;
+    } else if(code_point < 0x800) {
+        out[0] = (char)(0xC0 | (code_point >> 6));
+        out[1] = (char)(0x80 | (code_point & 0x3F));
+        return 2;
+    } else if(code_point < 0x10000) {
+        // lone surrogates are written as well, decoded with "surrogatepass"
+        out[0] = (char)(0xE0 | (code_point >> 12));
+        out[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (code_point & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (code_point >> 18));
+    out[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (code_point & 0x3F));
+    return 4;
+}
+
+/** Decode escape sequences of JSON string body, NULL without exception if invalid */
+static PyObject* decode_escaped_string(struct CharBuffer* scratch, const char* s, size_t length) {
+    // escape sequences never decode to more bytes than they take
+    clear(scratch);
+    if(!check_capacity(scratch, length)) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    char* decoded = scratch->data;
+    size_t out = 0;
+    size_t i = 0;
+    while(i < length) {
+        unsigned char c = s[i];
+        if(c < 0x20) {
+            goto invalid;
+        }
+        if(c != '\\') {
+            decoded[out++] = c;
+            i += 1;
+            continue;
+        }
+        if(i + 1 >= length) {
+            goto invalid;
+        }
+        char escaped = s[i+1];
+        i += 2;
+        switch(escaped) {
+            case '"': decoded[out++] = '"'; break;
+            case '\\': decoded[out++] = '\\'; break;
+            case '/': decoded[out++] = '/'; break;
+            case 'b': decoded[out++] = '\b'; break;
+            case 'f': decoded[out++] = '\f'; break;
+            case 'n': decoded[out++] = '\n'; break;
+            case 'r': decoded[out++] = '\r'; break;
+            case 't': decoded[out++] = '\t'; break;
+            case 'u': {
+                if(i + 4 > length) {
+                    goto invalid;
+                }
+                int code_point = read_hex4(s + i);
+                if(code_point < 0) {
+                    goto invalid;
+                }
+                i += 4;
+                // join surrogate pairs
+                if(code_point >= 0xD800 && code_point <= 0xDBFF
+                        && i + 6 <= length && s[i] == '\\' && s[i+1] == 'u') {
+                    int low = read_hex4(s + i + 2);
+                    if(low >= 0xDC00 && low <= 0xDFFF) {
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                out += write_utf8(decoded + out, code_point);
+            }
+            break;
+            default:
+                goto invalid;
+        }
+    }
+
+    return PyUnicode_DecodeUTF8(decoded, out, "surrogatepass");
+
+invalid:
+    return NULL;
+}
+
+/** Convert quoted JSON string into `str`, NULL without exception if invalid */
+static PyObject* decode_string(struct CharBuffer* scratch, const char* s, size_t length) {
+    bool ascii = true;
+    for(size_t i = 0; i < length; ++i) {
+        unsigned char c = s[i];
+        if(c == '\\') {
+            return decode_escaped_string(scratch, s, length);
+        } else if(c < 0x20) {
+            return NULL;
+        } else if(c >= 0x80) {
+            ascii = false;
+        }
+    }
+    if(!ascii) {
+        return PyUnicode_DecodeUTF8(s, length, "surrogatepass");
+    }
+    PyObject* result = PyUnicode_New(length, 127);
+    if(result != NULL) {
+        memcpy(PyUnicode_DATA(result), s, length);
+    }
+    return result;
+}
+
+/** Convert JSON number into `int` or `float`, NULL without exception if invalid */
+static PyObject* decode_number(const char* s, size_t length) {
+    size_t i = 0;
+    bool negative = false;
+    bool is_float = false;
+    // value is accumulated while the number is validated, numbers with more
+    // significant digits than fit into mantissa are converted by Python
+    uint64_t mantissa = 0;
+    size_t significant_digits = 0;
+    int64_t exponent = 0;
+
+    if(i < length && s[i] == '-') {
+        negative = true;
+        i += 1;
+    }
+    size_t digits_start = i;
+    if(i < length && s[i] == '0') {
+        i += 1;
+    } else {
+        while(i < length && s[i] >= '0' && s[i] <= '9') {
+            mantissa = mantissa * 10 + (s[i] - '0');
+            significant_digits += 1;
+            i += 1;
+        }
+    }
+    size_t digits_end = i;
+    if(digits_end == digits_start) {
+        return NULL;
+    }
+    if(i < length && s[i] == '.') {
+        is_float = true;
+        i += 1;
+        size_t fraction_start = i;
+        while(i < length && s[i] >= '0' && s[i] <= '9') {
+            if(significant_digits > 0 || s[i] != '0') {
+                significant_digits += 1;
+            }
+            mantissa = mantissa * 10 + (s[i] - '0');
+            exponent -= 1;
+            i += 1;
+        }
+        if(i == fraction_start) {
+            return NULL;
+        }
+    }
+    if(i < length && (s[i] == 'e' || s[i] == 'E')) {
+        is_float = true;
+        i += 1;
+        bool negative_exponent = false;
+        if(i < length && (s[i] == '+' || s[i] == '-')) {
+            negative_exponent = s[i] == '-';
+            i += 1;
+        }
+        size_t exponent_start = i;
+        int64_t written_exponent = 0;
+        while(i < length && s[i] >= '0' && s[i] <= '9') {
+            // anything this big is converted by Python anyway
+            if(written_exponent < 1000000000) {
+                written_exponent = written_exponent * 10 + (s[i] - '0');
+            }
+            i += 1;
+        }
+        if(i == exponent_start) {
+            return NULL;
+        }
+        exponent += negative_exponent ? -written_exponent : written_exponent;
+    }
+    if(i != length) {
+        return NULL;
+    }
+
+    if(significant_digits <= 19) {
+        if(!is_float) {
+            if(!negative) {
+                return PyLong_FromUnsignedLongLong(mantissa);
+            }
+            if(mantissa <= (uint64_t)LLONG_MAX) {
+                return PyLong_FromLongLong(-(long long)mantissa);
+            }
+        } else {
+            double value;
+            if(fast_double(mantissa, exponent, &value)) {
+                return PyFloat_FromDouble(negative ? -value : value);
+            }
+        }
+    }
+
+    char small_buffer[SMALL_NUMBER_LENGTH];
+    char* buffer = small_buffer;
+    if(length >= SMALL_NUMBER_LENGTH) {
+        buffer = PyMem_Malloc(length + 1);
+        if(buffer == NULL) {
+            return PyErr_NoMemory();
+        }
+    }
+    memcpy(buffer, s, length);
+    buffer[length] = '\0';
+
+    PyObject* result;
+    if(is_float) {
+        double value = PyOS_string_to_double(buffer, NULL, NULL);
+        if(value == -1.0 && PyErr_Occurred()) {
+            result = NULL;
+        } else {
+            result = PyFloat_FromDouble(value);
+        }
+    } else {
+        result = PyLong_FromString(buffer, NULL, 10);
+    }
+
+    if(buffer != small_buffer) {
+        PyMem_Free(buffer);
+    }
+    return result;
+}
+
+/** Check if string body can be cached: short, ASCII, without escape sequences */
+static bool is_cacheable(const char* s, size_t length) {
+    if(length > MAX_CACHED_LENGTH) {
+        return false;
+    }
+    for(size_t i = 0; i < length; ++i) {
+        unsigned char c = s[i];
+        if(c < 0x20 || c >= 0x80 || c == '\\') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Check if cached string is equal to the string body */
+static inline bool is_cached_string(PyObject* string, const char* s, size_t length) {
+    return string != NULL && (size_t)PyUnicode_GET_LENGTH(string) == length
+        && memcmp(PyUnicode_1BYTE_DATA(string), s, length) == 0;
+}
+
+/** New reference to cached string equal to the body, it's created and cached if missing */
+static PyObject* cached_string(PyObject** table, size_t size, const char* s, size_t length) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for(size_t i = 0; i < length; ++i) {
+        hash = (hash ^ (unsigned char)s[i]) * 16777619u;
+    }
+    PyObject** slot = &table[hash & (size - 1)];
+    if(!is_cached_string(*slot, s, length)) {
+        PyObject* string = decode_string(NULL, s, length);
+        if(string == NULL) {
+            return NULL;
+        }
+        Py_XSETREF(*slot, string);
+    }
+    Py_INCREF(*slot);
+    return *slot;
+}
+
+static struct BuilderCache* builder_cache(struct Builder* builder) {
+    if(builder->cache == NULL) {
+        builder->cache = PyMem_Calloc(1, sizeof(struct BuilderCache));
+    }
+    return builder->cache;
+}
+
+/** Convert quoted object key into `str`, reusing the same key of previous objects */
+static PyObject* decode_key(struct Builder* builder, const char* data, size_t length) {
+    const char* s = data + 1;
+    length -= 2;
+    struct BuilderLevel* level = &builder->levels[builder->depth - 1];
+    size_t key_index = level->key_index;
+    level->key_index += 1;
+    struct BuilderCache* cache;
+    if(!is_cacheable(s, length) || (cache = builder_cache(builder)) == NULL) {
+        return decode_string(&builder->scratch, s, length);
+    }
+
+    if(builder->depth > MAX_SHAPE_DEPTH || key_index >= MAX_SHAPE_KEYS) {
+        return cached_string(cache->keys, KEY_CACHE_SIZE, s, length);
+    }
+
+    struct Shape* shape = &cache->shapes[builder->depth - 1];
+    PyObject** predicted = &shape->keys[key_index];
+    if(is_cached_string(*predicted, s, length)) {
+        Py_INCREF(*predicted);
+        return *predicted;
+    }
+    // layout of this object differs, it's remembered instead
+    PyObject* key = cached_string(cache->keys, KEY_CACHE_SIZE, s, length);
+    if(key != NULL) {
+        Py_INCREF(key);
+        Py_XSETREF(*predicted, key);
+    }
+    return key;
+}
+
+static PyObject* decode_value(struct Builder* builder, const char* data, size_t length) {
+    if(data[0] == '"' && builder->cache_values && is_cacheable(data + 1, length - 2)
+            && builder_cache(builder) != NULL) {
+        return cached_string(builder->cache->values, VALUE_CACHE_SIZE, data + 1, length - 2);
+    }
+    return build_scalar(&builder->scratch, data, length);
+}
+
+PyObject* build_scalar(struct CharBuffer* scratch, const char* data, size_t length) {
+    switch(data[0]) {
+        case '"':
+            return decode_string(scratch, data + 1, length - 2);
+        case 't':
+            Py_RETURN_TRUE;
+        case 'f':
+            Py_RETURN_FALSE;
+        case 'n':
+            Py_RETURN_NONE;
+        case 'N':
+            return PyFloat_FromDouble(Py_NAN);
+        default:
+            return decode_number(data, length);
+    }
+}
+
+/** Put value into currently built container, steals reference */
+static bool add_value(struct Builder* builder, PyObject* value) {
+    if(builder->depth == 0) {
+        if(builder->result != NULL) {
+            Py_DECREF(value);
+            return false;
+        }
+        builder->result = value;
+        return true;
+    }
+
+    struct BuilderLevel* level = &builder->levels[builder->depth - 1];
+    bool ok = false;
+    if(PyList_CheckExact(level->container)) {
+        if(level->state == EXPECT_FIRST || level->state == EXPECT_NEXT) {
+            ok = PyList_Append(level->container, value) == 0;
+            level->state = AFTER_VALUE;
+        }
+    } else if(level->state == EXPECT_FIRST || level->state == EXPECT_NEXT) {
+        if(PyUnicode_CheckExact(value)) {
+            level->key = value;
+            level->state = AFTER_KEY;
+            return true;
+        }
+    } else if(level->state == EXPECT_VALUE) {
+        ok = PyDict_SetItem(level->container, level->key, value) == 0;
+        Py_CLEAR(level->key);
+        level->state = AFTER_VALUE;
+    }
+    Py_DECREF(value);
+    return ok;
+}
+
+static bool open_container(struct Builder* builder, PyObject* container) {
+    if(container == NULL) {
+        return false;
+    }
+    if(builder->depth == builder->capacity) {
+        size_t capacity = builder->capacity ? 2 * builder->capacity : INITIAL_BUILDER_DEPTH;
+        struct BuilderLevel* levels = PyMem_Realloc(
+            builder->levels, capacity * sizeof(struct BuilderLevel)
+        );
+        if(levels == NULL) {
+            Py_DECREF(container);
+            PyErr_NoMemory();
+            return false;
+        }
+        builder->levels = levels;
+        builder->capacity = capacity;
+    }
+    Py_INCREF(container);
+    if(!add_value(builder, container)) {
+        Py_DECREF(container);
+        return false;
+    }
+    struct BuilderLevel* level = &builder->levels[builder->depth];
+    level->container = container;
+    level->key = NULL;
+    level->state = EXPECT_FIRST;
+    level->key_index = 0;
+    builder->depth += 1;
+    return true;
+}
+
+static bool close_container(struct Builder* builder, bool is_list) {
+    if(builder->depth == 0) {
+        return false;
+    }
+    struct BuilderLevel* level = &builder->levels[builder->depth - 1];
+    if(PyList_CheckExact(level->container) != is_list) {
+        return false;
+    }
+    if(level->state == AFTER_KEY || level->state == EXPECT_VALUE) {
+        return false;
+    }
+    Py_CLEAR(level->key);
+    Py_CLEAR(level->container);
+    builder->depth -= 1;
+    return true;
+}
+
+static bool build(struct Builder* builder, TokenType type, const char* data, size_t length) {
+    struct BuilderLevel* level = builder->depth ? &builder->levels[builder->depth - 1] : NULL;
+
+    switch(type) {
+        case TOKEN_OBJECT_START:
+            return open_container(builder, PyDict_New());
+        case TOKEN_ARRAY_START:
+            return open_container(builder, PyList_New(0));
+        case TOKEN_OBJECT_END:
+            return close_container(builder, false);
+        case TOKEN_ARRAY_END:
+            return close_container(builder, true);
+        case TOKEN_COLON:
+            if(level == NULL || level->state != AFTER_KEY) {
+                return false;
+            }
+            level->state = EXPECT_VALUE;
+            return true;
+        case TOKEN_COMMA:
+            // trailing commas are removed by the parser once container is closed
+            if(level == NULL) {
+                return false;
+            } else if(level->state == AFTER_VALUE) {
+                level->state = EXPECT_NEXT;
+            } else if(level->state == EXPECT_FIRST) {
+                level->state = EXPECT_CLOSE;
+            } else {
+                return false;
+            }
+            return true;
+        case TOKEN_VALUE: {
+            PyObject* value;
+            if(level != NULL && data[0] == '"' && PyDict_CheckExact(level->container)
+                    && (level->state == EXPECT_FIRST || level->state == EXPECT_NEXT)) {
+                value = decode_key(builder, data, length);
+            } else {
+                value = decode_value(builder, data, length);
+            }
+            if(value == NULL) {
+                return false;
+            }
+            return add_value(builder, value);
+        }
+    }
+    return false;
+}
+
+static bool handle_token(void* context, TokenType type, const char* data, size_t length) {
+    struct Builder* builder = context;
+    if(builder->failed) {
+        return true;
+    }
+    if(!build(builder, type, data, length)) {
+        builder->failed = true;
+        return !builder->stop_on_error;
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#ifndef CHOMPJS_BUILDER_H
+#define CHOMPJS_BUILDER_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+
+#include "parser.h"
+
+/** Container being currently filled by the builder */
+struct BuilderLevel {
+    PyObject* container;
+    PyObject* key;
+    int state;
+    // number of keys of the object so far
+    size_t key_index;
+};
+
+struct BuilderCache;
+
+/**
+    Builds Python objects directly from tokens reported by the parser,
+    following the same rules `json.loads` applies to the parser output.
+    Requires GIL to be held while parsing.
+*/
+struct Builder {
+    struct BuilderLevel* levels;
+    size_t depth;
+    size_t capacity;
+    PyObject* result;
+    bool failed;
+    bool stop_on_error;
+    struct CharBuffer scratch;
+    struct TokenSink sink;
+    // strings reused between built objects, allocated on first use
+    struct BuilderCache* cache;
+    // reuse short string values as well, not only keys
+    bool cache_values;
+};
+
+/**
+    Initialize builder and attach it to the parser. When `stop_on_error` is set
+    invalid token stops the parser, otherwise it's only marked as failed
+*/
+void init_builder(struct Builder* builder, struct Parser* parser, bool stop_on_error);
+
+/** Attach initialized builder to another parser, or the same one again */
+void attach_builder(struct Builder* builder, struct Parser* parser, bool stop_on_error);
+
+/** Drop partially built object, prepare for building next one */
+void reset_builder(struct Builder* builder);
+
+/**
+    Release builder and all objects it holds, including strings
+    kept to be reused between calls
+*/
+void release_builder(struct Builder* builder);
+
+/**
+    Return new reference to the complete built object or NULL if the input
+    didn't form a valid one. A Python exception might be set in the latter case
+*/
+PyObject* builder_result(struct Builder* builder);
+
+/**
+    Convert JSON text of a single string, number or literal into Python object,
+    the same way the builder does. Scratch buffer is only used by strings with
+    escape sequences. NULL if the text is invalid, an exception might not be set
+*/
+PyObject* build_scalar(struct CharBuffer* scratch, const char* data, size_t length);
+
+#endif
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#include "chunks.h"
+#include "pool.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK_SIZE (1 << 20)
+#define CHUNKS_PER_WORKER 2
+#define INITIAL_CHUNK_OBJECTS 64
+
+size_t unfinished_comment(const char* data, size_t length) {
+    for(size_t i = 0; i < length; ++i) {
+        if(data[i] != '/') {
+            continue;
+        }
+        if(i + 1 == length) {
+            return i;
+        }
+        const char* end = NULL;
+        if(data[i + 1] == '/') {
+            end = memchr(data + i + 2, '\n', length - i - 2);
+        } else if(data[i + 1] == '*') {
+            for(size_t j = i + 2; j + 1 < length; ++j) {
+                if(data[j] == '*' && data[j + 1] == '/') {
+                    end = data + j + 1;
+                    break;
+                }
+            }
+        } else {
+            continue;
+        }
+        if(end == NULL) {
+            return i;
+        }
+        i = end - data;
+    }
+    return length;
+}
+
+static bool add_chunk_object(struct Chunk* chunk, struct ChunkObject* object) {
+    if(chunk->count == chunk->capacity) {
+        size_t capacity = chunk->capacity ? 2 * chunk->capacity : INITIAL_CHUNK_OBJECTS;
+        struct ChunkObject* objects = realloc(chunk->objects, capacity * sizeof(struct ChunkObject));
+        if(objects == NULL) {
+            return false;
+        }
+        chunk->objects = objects;
+        chunk->capacity = capacity;
+    }
+    chunk->objects[chunk->count] = *object;
+    chunk->count += 1;
+    return true;
+}
+
+/**
+    Parse all objects of the chunk, the same way `parse_objects` iterator does.
+    Input before the chunk is only looked at to check candidate objects
+*/
+static void parse_chunk(struct ChunkedInput* input, struct Chunk* chunk, const char* data, size_t length) {
+    struct Parser* parser = &chunk->parser;
+    chunk->data = data;
+    chunk->length = length;
+    chunk->count = 0;
+    chunk->cut_object = false;
+    reset_parser_input(parser, data, length);
+    append_preceding(parser->preceding, input->data, data - input->data);
+    clear_token_recorder(&chunk->recorder);
+
+    size_t last_end = 0;
+    for(;;) {
+        struct ChunkObject object;
+        object.output_start = parser->output.index;
+        object.first_token = chunk->recorder.count;
+        while(parser->parser_status == CAN_ADVANCE) {
+            advance(parser);
+        }
+        // nothing but the terminating '\0' was written, no more objects
+        if(parser->output.index - object.output_start == 1) {
+            break;
+        }
+        object.output_end = parser->output.index - 1;
+        object.last_token = chunk->recorder.count;
+        object.finished = parser->parser_status == FINISHED;
+        object.failure = parser->failure;
+        object.failed_at = parser->input_position - 1;
+        if(!add_chunk_object(chunk, &object)) {
+            break;
+        }
+        // error caused by the end of data means that the object might continue
+        // in the next chunk, so might the check if it's an object at all.
+        // It's kept in case there is no next chunk
+        bool cut = parser->parser_status == ERROR && parser->input_position > length;
+        // in the last chunk the check has already seen all the data there is
+        bool last = data + length == input->data + input->length;
+        if(cut || (parser->candidate_cut && !last)) {
+            chunk->cut_object = true;
+            chunk->resume = parser->object_start;
+            return;
+        }
+        last_end = parser->input_position - 1;
+        start_next_object(parser);
+    }
+    chunk->resume = last_end + unfinished_comment(data + last_end, length - last_end);
+}
+
+static void parse_chunk_task(void* context, size_t index) {
+    struct ChunkedInput* input = context;
+    struct Chunk* chunk = &input->chunks[index];
+    parse_chunk(input, chunk, chunk->data, chunk->length);
+}
+
+/**
+    Position after the first newline found after `target`. If there is none nearby,
+    position between a closing and an opening bracket is used. Wrong guesses are
+    fixed later, they only cost time
+*/
+static size_t chunk_boundary(const char* data, size_t target, size_t length) {
+    size_t window = length - target < CHUNK_SIZE ? length - target : CHUNK_SIZE;
+    const char* newline = memchr(data + target, '\n', window);
+    if(newline != NULL) {
+        return newline - data + 1;
+    }
+    for(size_t i = target; i < target + window; ++i) {
+        if(data[i] != '}' && data[i] != ']') {
+            continue;
+        }
+        size_t next = i + 1;
+        while(next < length && isspace((unsigned char)data[next])) {
+            next += 1;
+        }
+        if(next < length && (data[next] == '{' || data[next] == '[')) {
+            return i + 1;
+        }
+    }
+    return target + window;
+}
+
+bool init_chunked_input(
+    struct ChunkedInput* input, const char* data, size_t length, size_t workers, bool record_tokens,
+    const struct ParserLimits* limits
+) {
+    input->data = data;
+    input->length = length;
+    input->position = 0;
+    input->workers = workers > 0 ? workers : 1;
+    input->record_tokens = record_tokens;
+    input->count = 0;
+    input->capacity = input->workers * CHUNKS_PER_WORKER;
+    input->chunks = calloc(input->capacity, sizeof(struct Chunk));
+    if(input->chunks == NULL) {
+        return false;
+    }
+    for(size_t i = 0; i < input->capacity; ++i) {
+        struct Chunk* chunk = &input->chunks[i];
+        init_parser(&chunk->parser, NULL, 0);
+        chunk->parser.limits = *limits;
+        init_token_recorder(&chunk->recorder, &chunk->parser);
+        if(!record_tokens) {
+            chunk->parser.sink = NULL;
+        }
+    }
+    return true;
+}
+
+/** Split input starting at current position into chunks, first one at least `first_size` long */
+static void split_input(struct ChunkedInput* input, size_t first_size) {
+    size_t start = input->position;
+    input->count = 0;
+    while(start < input->length && input->count < input->capacity) {
+        size_t size = input->count == 0 ? first_size : CHUNK_SIZE;
+        size_t end = input->length;
+        if(input->length - start > size) {
+            end = chunk_boundary(input->data, start + size, input->length);
+        }
+        struct Chunk* chunk = &input->chunks[input->count];
+        chunk->data = input->data + start;
+        chunk->length = end - start;
+        input->count += 1;
+        start = end;
+    }
+}
+
+/**
+    Chunks whose boundary cut an object or a comment are parsed again, together
+    with the rest of the round. Returns position where the next round starts
+*/
+static size_t fix_boundaries(struct ChunkedInput* input) {
+    const char* input_end = input->data + input->length;
+    for(size_t i = 0; i < input->count; ++i) {
+        struct Chunk* chunk = &input->chunks[i];
+        const char* chunk_end = chunk->data + chunk->length;
+        // incomplete object at the end of input is just an error
+        if(chunk->resume == chunk->length || chunk_end == input_end) {
+            continue;
+        }
+        if(chunk->cut_object) {
+            chunk->count -= 1;
+        }
+        if(i + 1 == input->count) {
+            return chunk->data + chunk->resume - input->data;
+        }
+        const char* from = chunk->data + chunk->resume;
+        const char* round_end = input->chunks[input->count - 1].data
+            + input->chunks[input->count - 1].length;
+        parse_chunk(input, &input->chunks[i + 1], from, round_end - from);
+        input->count = i + 2;
+    }
+    struct Chunk* last = &input->chunks[input->count - 1];
+    return last->data + last->length - input->data;
+}
+
+bool parse_next_chunks(struct ChunkedInput* input) {
+    if(input->position >= input->length) {
+        input->count = 0;
+        return false;
+    }
+    size_t first_size = CHUNK_SIZE;
+    for(;;) {
+        split_input(input, first_size);
+        run_parallel(input->count, input->workers, parse_chunk_task, input);
+        size_t position = fix_boundaries(input);
+        if(position > input->position) {
+            input->position = position;
+            return true;
+        }
+        // a single object doesn't fit into the first chunk, try a bigger one
+        first_size *= 2;
+    }
+}
+
+void release_chunked_input(struct ChunkedInput* input) {
+    for(size_t i = 0; i < input->capacity; ++i) {
+        release_token_recorder(&input->chunks[i].recorder);
+        release_parser(&input->chunks[i].parser);
+        free(input->chunks[i].objects);
+    }
+    free(input->chunks);
+    input->chunks = NULL;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#ifndef CHOMPJS_CHUNKS_H
+#define CHOMPJS_CHUNKS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "parser.h"
+#include "recorder.h"
+
+/** Object found in a chunk: range of parser output and of recorded tokens */
+struct ChunkObject {
+    size_t output_start;
+    size_t output_end;
+    size_t first_token;
+    size_t last_token;
+    bool finished;
+    // reason why an unfinished object failed, and its position in the chunk
+    ParserFailure failure;
+    size_t failed_at;
+};
+
+/** Part of the input parsed on its own thread, independently of others */
+struct Chunk {
+    const char* data;
+    size_t length;
+    struct Parser parser;
+    struct TokenRecorder recorder;
+    struct ChunkObject* objects;
+    size_t count;
+    size_t capacity;
+    // position from which the input has to be parsed again together with the
+    // next chunk, equal to length if chunk ended outside of objects and comments
+    size_t resume;
+    // last object was cut by the end of chunk
+    bool cut_object;
+};
+
+/**
+    Input split into chunks at newlines, or between objects if there are none.
+    Chunks are parsed in rounds, every round on a pool of native threads.
+    A boundary that turns out to cut an object or a comment is fixed by
+    parsing both chunks around it again, so results are the same as with
+    a single parser. Doesn't use Python API
+*/
+struct ChunkedInput {
+    const char* data;
+    size_t length;
+    size_t position;
+    size_t workers;
+    bool record_tokens;
+    struct Chunk* chunks;
+    size_t count;
+    size_t capacity;
+};
+
+/**
+    Initialize chunked input, tokens are recorded for every chunk if `record_tokens` is set.
+    Parsers of all chunks are given the same limits
+*/
+bool init_chunked_input(
+    struct ChunkedInput* input, const char* data, size_t length, size_t workers, bool record_tokens,
+    const struct ParserLimits* limits
+);
+
+/** Parse next round of chunks, false if the whole input was already parsed */
+bool parse_next_chunks(struct ChunkedInput* input);
+
+/** Release chunked input and its memory */
+void release_chunked_input(struct ChunkedInput* input);
+
+/**
+    Position of a comment left open at the end of data skipped by the parser,
+    or of a trailing '/' that might start one. Same rules as in `begin` state
+*/
+size_t unfinished_comment(const char* data, size_t length);
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#include "escape.h"
+
+#include <string.h>
+
+static int hex_digit(char c) {
+    if(c >= '0' && c <= '9') {
+        return c - '0';
+    } else if(c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if(c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/** Read exactly `count` hex digits, -1 if there are not enough of them */
+static long read_hex(const char* s, const char* end, size_t count) {
+    if((size_t)(end - s) < count) {
+        return -1;
+    }
+    long result = 0;
+    for(size_t i = 0; i < count; ++i) {
+        int digit = hex_digit(s[i]);
+        if(digit < 0) {
+            return -1;
+        }
+        result = (result << 4) | digit;
+    }
+    return result;
+}
+
+static size_t write_code_point(char* out, unsigned long code_point) {
+    if(code_point < 0x80) {
+        out[0] = (char)code_point;
+        return 1;
+    } else if(code_point < 0x800) {
+        out[0] = (char)(0xC0 | (code_point >> 6));
+        out[1] = (char)(0x80 | (code_point & 0x3F));
+        return 2;
+    } else if(code_point < 0x10000) {
+        out[0] = (char)(0xE0 | (code_point >> 12));
+        out[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (code_point & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (code_point >> 18));
+    out[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (code_point & 0x3F));
+    return 4;
+}
+
+size_t decode_escapes(const char* input, size_t length, char* output) {
+    const char* s = input;
+    const char* end = input + length;
+    char* out = output;
+
+    while(s < end) {
+        const char* backslash = memchr(s, '\\', end - s);
+        if(backslash == NULL) {
+            backslash = end;
+        }
+        memmove(out, s, backslash - s);
+        out += backslash - s;
+        s = backslash;
+        if(s + 1 >= end) {
+            // lone backslash at the end of input is kept
+            break;
+        }
+
+        char c = s[1];
+        long code_point = -1;
+        size_t sequence_length = 2;
+        switch(c) {
+            case '\n': s += 2; continue;
+            case '\\': code_point = '\\'; break;
+            case '\'': code_point = '\''; break;
+            case '"': code_point = '"'; break;
+            case 'a': code_point = '\a'; break;
+            case 'b': code_point = '\b'; break;
+            case 'f': code_point = '\f'; break;
+            case 'n': code_point = '\n'; break;
+            case 'r': code_point = '\r'; break;
+            case 't': code_point = '\t'; break;
+            case 'v': code_point = '\v'; break;
+            case 'x':
+                code_point = read_hex(s + 2, end, 2);
+                sequence_length = 4;
+            break;
+            case 'u':
+                code_point = read_hex(s + 2, end, 4);
+                sequence_length = 6;
+                // join surrogate pairs into a single character
+                if(code_point >= 0xD800 && code_point <= 0xDBFF
+                        && end - s >= 12 && s[6] == '\\' && s[7] == 'u') {
+                    long low = read_hex(s + 8, end, 4);
+                    if(low >= 0xDC00 && low <= 0xDFFF) {
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                        sequence_length = 12;
+                    }
+                }
+            break;
+            case 'U':
+                code_point = read_hex(s + 2, end, 8);
+                sequence_length = 10;
+                if(code_point > 0x10FFFF) {
+                    code_point = -1;
+                }
+            break;
+            default:
+                if(c >= '0' && c <= '7') {
+                    code_point = 0;
+                    sequence_length = 1;
+                    while(sequence_length < 4 && s + sequence_length < end
+                            && s[sequence_length] >= '0' && s[sequence_length] <= '7') {
+                        code_point = code_point * 8 + (s[sequence_length] - '0');
+                        sequence_length += 1;
+                    }
+                }
+        }
+
+        if(code_point < 0) {
+            // unknown or malformed escape sequence, copy it as it is
+            out[0] = s[0];
+            out[1] = s[1];
+            out += 2;
+            s += 2;
+            continue;
+        }
+        out += write_code_point(out, code_point);
+        s += sequence_length;
+    }
+
+    if(s < end) {
+        *out++ = *s;
+    }
+    return out - output;
+}
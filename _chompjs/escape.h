@@ -0,0 +1,20 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#ifndef CHOMPJS_ESCAPE_H
+#define CHOMPJS_ESCAPE_H
+
+#include <stddef.h>
+
+/**
+    Decode Python-style escape sequences (\\, \", \', \n, \xNN, \uNNNN,
+    \UNNNNNNNN, octal escapes, line continuations) of UTF-8 input, the same
+    way `unicode_escape` codec does, except that non-ASCII characters are
+    kept intact and malformed sequences are copied as they are.
+    Output needs to hold at least `length` bytes, its length is returned
+*/
+size_t decode_escapes(const char* input, size_t length, char* output);
+
+#endif
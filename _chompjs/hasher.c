@@ -0,0 +1,383 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#include "hasher.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_HASH_DEPTH 16
+#define INITIAL_MEMBERS_SIZE 64
+// members of bigger objects are sorted with qsort
+#define SMALL_OBJECT_MEMBERS 16
+#define INITIAL_SCRATCH_SIZE 256
+
+// primes of xxHash64
+#define PRIME1 0x9E3779B185EBCA87ULL
+#define PRIME2 0xC2B2AE3D27D4EB4FULL
+#define PRIME3 0x165667B19E3779F9ULL
+#define PRIME4 0x85EBCA77C2B2AE63ULL
+#define PRIME5 0x27D4EB2F165667C5ULL
+
+// seeds keeping values of different types apart, such as "1" and 1
+#define STRING_SEED 1
+#define LITERAL_SEED 2
+#define OBJECT_SEED 3
+#define ARRAY_SEED 4
+
+static bool hash_token(void* context, TokenType type, const char* data, size_t length);
+
+static inline uint64_t rotate_left(uint64_t x, int bits) {
+    return (x << bits) | (x >> (64 - bits));
+}
+
+static inline uint64_t hash_round(uint64_t accumulator, uint64_t input) {
+    accumulator += input * PRIME2;
+    accumulator = rotate_left(accumulator, 31);
+    return accumulator * PRIME1;
+}
+
+static inline uint64_t avalanche(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+// read in little-endian order, so that hashes are the same on every platform
+static inline uint64_t read64(const unsigned char* p) {
+    return (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24
+        | (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40 | (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56;
+}
+
+static inline uint64_t read32(const unsigned char* p) {
+    return (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24;
+}
+
+/** Single lane variant of xxHash64, values of objects are mostly short */
+static uint64_t hash_bytes(const char* data, size_t length, uint64_t seed) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t hash = seed + PRIME5 + length;
+    while(length >= 8) {
+        hash ^= hash_round(0, read64(p));
+        hash = rotate_left(hash, 27) * PRIME1 + PRIME4;
+        p += 8;
+        length -= 8;
+    }
+    if(length >= 4) {
+        hash ^= read32(p) * PRIME1;
+        hash = rotate_left(hash, 23) * PRIME2 + PRIME3;
+        p += 4;
+        length -= 4;
+    }
+    while(length > 0) {
+        hash ^= *p * PRIME5;
+        hash = rotate_left(hash, 11) * PRIME1;
+        p += 1;
+        length -= 1;
+    }
+    return avalanche(hash);
+}
+
+static int hex_value(char c) {
+    if(c >= '0' && c <= '9') {
+        return c - '0';
+    } else if(c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if(c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static int read_hex4(const char* s) {
+    int result = 0;
+    for(int i = 0; i < 4; ++i) {
+        int digit = hex_value(s[i]);
+        if(digit < 0) {
+            return -1;
+        }
+        result = (result << 4) | digit;
+    }
+    return result;
+}
+
+static size_t write_utf8(char* out, unsigned int code_point) {
+    if(code_point < 0x80) {
+        out[0] = (char)code_point;
+        return 1;
+    } else if(code_point < 0x800) {
+        out[0] = (char)(0xC0 | (code_point >> 6));
+        out[1] = (char)(0x80 | (code_point & 0x3F));
+        return 2;
+    } else if(code_point < 0x10000) {
+        out[0] = (char)(0xE0 | (code_point >> 12));
+        out[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (code_point & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (code_point >> 18));
+    out[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (code_point & 0x3F));
+    return 4;
+}
+
+/**
+    Decode escape sequences of JSON string body into scratch buffer, so that
+    "\u00e9" and "é" get the same hash. Malformed sequences are kept as they
+    are, such strings aren't valid anyway. False if memory can't be allocated
+*/
+static bool decode_string(struct CharBuffer* scratch, const char* s, size_t length) {
+    // escape sequences never decode to more bytes than they take
+    clear(scratch);
+    if(!check_capacity(scratch, length)) {
+        return false;
+    }
+    char* decoded = scratch->data;
+    size_t out = 0;
+    size_t i = 0;
+    while(i < length) {
+        if(s[i] != '\\' || i + 1 >= length) {
+            decoded[out++] = s[i++];
+            continue;
+        }
+        char escaped = s[i+1];
+        i += 2;
+        switch(escaped) {
+            case 'b': decoded[out++] = '\b'; break;
+            case 'f': decoded[out++] = '\f'; break;
+            case 'n': decoded[out++] = '\n'; break;
+            case 'r': decoded[out++] = '\r'; break;
+            case 't': decoded[out++] = '\t'; break;
+            case 'u': {
+                int code_point = i + 4 <= length ? read_hex4(s + i) : -1;
+                if(code_point < 0) {
+                    decoded[out++] = '\\';
+                    decoded[out++] = 'u';
+                    break;
+                }
+                i += 4;
+                // join surrogate pairs
+                if(code_point >= 0xD800 && code_point <= 0xDBFF
+                        && i + 6 <= length && s[i] == '\\' && s[i+1] == 'u') {
+                    int low = read_hex4(s + i + 2);
+                    if(low >= 0xDC00 && low <= 0xDFFF) {
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                out += write_utf8(decoded + out, code_point);
+            }
+            break;
+            default:
+                // '"', '\\' and '/' stand for themselves
+                decoded[out++] = escaped;
+        }
+    }
+    scratch->index = out;
+    return true;
+}
+
+/** Hash of a value in its JSON form, false if memory can't be allocated */
+static bool hash_value(struct ContentHasher* hasher, const char* data, size_t length, uint64_t* hash) {
+    if(length < 2 || data[0] != '"') {
+        *hash = hash_bytes(data, length, LITERAL_SEED);
+        return true;
+    }
+    const char* body = data + 1;
+    size_t body_length = length - 2;
+    if(memchr(body, '\\', body_length) == NULL) {
+        *hash = hash_bytes(body, body_length, STRING_SEED);
+        return true;
+    }
+    if(!decode_string(&hasher->scratch, body, body_length)) {
+        return false;
+    }
+    *hash = hash_bytes(hasher->scratch.data, hasher->scratch.index, STRING_SEED);
+    return true;
+}
+
+/** Add complete value to the container it belongs to, false if memory can't be allocated */
+static bool add_value(struct ContentHasher* hasher, uint64_t hash) {
+    if(hasher->depth == 0) {
+        hasher->result = hash;
+        return true;
+    }
+    struct HashLevel* level = &hasher->levels[hasher->depth - 1];
+    if(!level->is_object) {
+        level->hash = rotate_left(level->hash ^ hash_round(0, hash), 27) * PRIME1 + PRIME4;
+        level->count += 1;
+        return true;
+    } else if(level->expect_key) {
+        level->key = hash;
+        level->expect_key = false;
+        return true;
+    }
+    if(hasher->member_count == hasher->member_capacity) {
+        size_t capacity = hasher->member_capacity ? 2 * hasher->member_capacity : INITIAL_MEMBERS_SIZE;
+        struct HashMember* members = realloc(hasher->members, capacity * sizeof(struct HashMember));
+        if(members == NULL) {
+            return false;
+        }
+        hasher->members = members;
+        hasher->member_capacity = capacity;
+    }
+    struct HashMember* member = &hasher->members[hasher->member_count];
+    member->key = level->key;
+    member->pair = avalanche(hash_round(level->key, hash) ^ PRIME3);
+    member->order = hasher->member_count;
+    hasher->member_count += 1;
+    return true;
+}
+
+static int compare_members(const void* a, const void* b) {
+    const struct HashMember* first = a;
+    const struct HashMember* second = b;
+    if(first->key != second->key) {
+        return first->key < second->key ? -1 : 1;
+    }
+    return first->order < second->order ? -1 : first->order > second->order;
+}
+
+/** Add up pairs of members of the object, skipping all but the last of duplicate keys */
+static void add_members(struct ContentHasher* hasher, struct HashLevel* level) {
+    struct HashMember* members = hasher->members + level->first_member;
+    size_t count = hasher->member_count - level->first_member;
+    if(count > SMALL_OBJECT_MEMBERS) {
+        qsort(members, count, sizeof(struct HashMember), compare_members);
+    } else {
+        // members are pushed in order and insertion sort is stable, `order` isn't compared
+        for(size_t i = 1; i < count; ++i) {
+            struct HashMember member = members[i];
+            size_t j = i;
+            for(; j > 0 && members[j - 1].key > member.key; --j) {
+                members[j] = members[j - 1];
+            }
+            members[j] = member;
+        }
+    }
+    // pairs are added up, their order doesn't matter
+    for(size_t i = 0; i < count; ++i) {
+        if(i + 1 < count && members[i + 1].key == members[i].key) {
+            continue;
+        }
+        level->hash += members[i].pair;
+        level->count += 1;
+    }
+    hasher->member_count = level->first_member;
+}
+
+static bool open_level(struct ContentHasher* hasher, bool is_object) {
+    if(hasher->depth == hasher->capacity) {
+        size_t capacity = hasher->capacity ? 2 * hasher->capacity : INITIAL_HASH_DEPTH;
+        struct HashLevel* levels = realloc(hasher->levels, capacity * sizeof(struct HashLevel));
+        if(levels == NULL) {
+            return false;
+        }
+        hasher->levels = levels;
+        hasher->capacity = capacity;
+    }
+    struct HashLevel* level = &hasher->levels[hasher->depth];
+    level->hash = 0;
+    level->key = 0;
+    level->count = 0;
+    level->first_member = hasher->member_count;
+    level->is_object = is_object;
+    level->expect_key = is_object;
+    hasher->depth += 1;
+    return true;
+}
+
+static bool close_level(struct ContentHasher* hasher) {
+    if(hasher->depth == 0) {
+        return true;
+    }
+    hasher->depth -= 1;
+    struct HashLevel* level = &hasher->levels[hasher->depth];
+    if(level->is_object) {
+        add_members(hasher, level);
+    }
+    uint64_t seed = level->is_object ? OBJECT_SEED : ARRAY_SEED;
+    return add_value(hasher, avalanche(level->hash + level->count * PRIME5 + seed * PRIME1));
+}
+
+static bool hash_token(void* context, TokenType type, const char* data, size_t length) {
+    struct ContentHasher* hasher = context;
+    uint64_t hash;
+    switch(type) {
+        case TOKEN_OBJECT_START:
+        case TOKEN_ARRAY_START:
+            if(!open_level(hasher, type == TOKEN_OBJECT_START)) {
+                return false;
+            }
+        break;
+        case TOKEN_OBJECT_END:
+        case TOKEN_ARRAY_END:
+            if(!close_level(hasher)) {
+                return false;
+            }
+        break;
+        case TOKEN_COMMA:
+            if(hasher->depth > 0) {
+                struct HashLevel* level = &hasher->levels[hasher->depth - 1];
+                level->expect_key = level->is_object;
+            }
+        break;
+        case TOKEN_COLON:
+        break;
+        case TOKEN_VALUE:
+            if(!hash_value(hasher, data, length, &hash)) {
+                return false;
+            }
+            if(!add_value(hasher, hash)) {
+                return false;
+            }
+        break;
+    }
+    // value data is still in place, the next sink might consume it
+    if(hasher->next != NULL) {
+        return hasher->next->handle(hasher->next->context, type, data, length);
+    }
+    return true;
+}
+
+void init_content_hasher(struct ContentHasher* hasher) {
+    hasher->levels = NULL;
+    hasher->depth = 0;
+    hasher->capacity = 0;
+    hasher->members = NULL;
+    hasher->member_count = 0;
+    hasher->member_capacity = 0;
+    hasher->result = 0;
+    init_char_buffer(&hasher->scratch, INITIAL_SCRATCH_SIZE);
+    hasher->next = NULL;
+    hasher->sink.handle = hash_token;
+    hasher->sink.context = hasher;
+    hasher->sink.consumes_values = false;
+}
+
+void attach_content_hasher(struct ContentHasher* hasher, struct Parser* parser) {
+    hasher->next = parser->sink;
+    hasher->sink.consumes_values = parser->sink != NULL && parser->sink->consumes_values;
+    parser->sink = &hasher->sink;
+}
+
+void reset_content_hasher(struct ContentHasher* hasher) {
+    hasher->depth = 0;
+    hasher->member_count = 0;
+}
+
+void release_content_hasher(struct ContentHasher* hasher) {
+    free(hasher->levels);
+    hasher->levels = NULL;
+    hasher->capacity = 0;
+    free(hasher->members);
+    hasher->members = NULL;
+    hasher->member_capacity = 0;
+    release_char_buffer(&hasher->scratch);
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#ifndef CHOMPJS_HASHER_H
+#define CHOMPJS_HASHER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "buffer.h"
+#include "parser.h"
+
+/** Container being currently hashed */
+struct HashLevel {
+    uint64_t hash;
+    // hash of the key waiting for its value
+    uint64_t key;
+    size_t count;
+    // objects: index of their first member in `members` of the hasher
+    size_t first_member;
+    bool is_object;
+    bool expect_key;
+};
+
+/** Key and value of an object member, combined once the object is complete */
+struct HashMember {
+    uint64_t key;
+    uint64_t pair;
+    // position in the object, the last of duplicate keys wins
+    size_t order;
+};
+
+/**
+    Computes 64-bit content hash of objects from tokens reported by the parser,
+    so that equal objects can be found without serializing them again. Hash
+    doesn't depend on the order of keys of objects, and only the last of
+    duplicate keys counts, same as in the dict built from it. Strings are hashed after
+    decoding their escape sequences, numbers as they are written. Tokens are
+    passed on to the next sink, if there is any. Doesn't use Python API,
+    can be used from any thread
+*/
+struct ContentHasher {
+    struct HashLevel* levels;
+    size_t depth;
+    size_t capacity;
+    // members of objects being hashed, each level takes a part at the end
+    struct HashMember* members;
+    size_t member_count;
+    size_t member_capacity;
+    // hash of the last complete value at the top level
+    uint64_t result;
+    struct CharBuffer scratch;
+    struct TokenSink* next;
+    struct TokenSink sink;
+};
+
+/** Initialize hasher, it isn't attached to any parser yet */
+void init_content_hasher(struct ContentHasher* hasher);
+
+/** Attach hasher to the parser, in front of the sink the parser already has */
+void attach_content_hasher(struct ContentHasher* hasher, struct Parser* parser);
+
+/** Drop partially hashed object, prepare for hashing next one */
+void reset_content_hasher(struct ContentHasher* hasher);
+
+/** Release hasher memory */
+void release_content_hasher(struct ContentHasher* hasher);
+
+#endif
@@ -0,0 +1,303 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#include "html.h"
+
+#include <ctype.h>
+#include <string.h>
+
+static bool starts_with_ignore_case(const char* s, const char* end, const char* prefix, size_t length) {
+    if((size_t)(end - s) < length) {
+        return false;
+    }
+    for(size_t i = 0; i < length; ++i) {
+        if(tolower((unsigned char)s[i]) != prefix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool contains_ignore_case(const char* s, size_t length, const char* needle) {
+    size_t needle_length = strlen(needle);
+    for(size_t i = 0; i + needle_length <= length; ++i) {
+        if(starts_with_ignore_case(s + i, s + length, needle, needle_length)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Find a tag such as "<script", case insensitive */
+static const char* find_tag(const char* s, const char* end, const char* tag, size_t length) {
+    while(s < end) {
+        s = memchr(s, '<', end - s);
+        if(s == NULL) {
+            return NULL;
+        }
+        if(starts_with_ignore_case(s, end, tag, length)) {
+            return s;
+        }
+        s += 1;
+    }
+    return NULL;
+}
+
+/** Position of closing quote of a string literal, NULL if it's not closed */
+static const char* find_string_end(const char* s, const char* end, char quote) {
+    while(s < end) {
+        if(*s == '\\') {
+            s += 2;
+        } else if(*s == quote) {
+            return s;
+        } else {
+            s += 1;
+        }
+    }
+    return NULL;
+}
+
+static const char* skip_whitespace(const char* s, const char* end) {
+    while(s < end && isspace((unsigned char)*s)) {
+        s += 1;
+    }
+    return s;
+}
+
+static bool is_name_char(char c) {
+    return isalnum((unsigned char)c) || c == '_' || c == '$' || c == '.';
+}
+
+/** Move to body of the next script, false if there are no more scripts */
+static bool open_next_script(struct ScriptScanner* scanner) {
+    const char* end = scanner->end;
+    for(;;) {
+        const char* tag = find_tag(scanner->position, end, "<script", 7);
+        if(tag == NULL) {
+            return false;
+        }
+        const char* p = tag + 7;
+        if(p < end && !isspace((unsigned char)*p) && *p != '>' && *p != '/') {
+            // some other tag, such as <scripts>
+            scanner->position = p;
+            continue;
+        }
+
+        const char* type = NULL;
+        size_t type_length = 0;
+        scanner->script_id = NULL;
+        scanner->script_id_length = 0;
+        while(p < end && *p != '>') {
+            if(isspace((unsigned char)*p) || *p == '/') {
+                p += 1;
+                continue;
+            }
+            const char* name = p;
+            while(p < end && !isspace((unsigned char)*p) && *p != '=' && *p != '>' && *p != '/') {
+                p += 1;
+            }
+            size_t name_length = p - name;
+            const char* value = NULL;
+            size_t value_length = 0;
+            p = skip_whitespace(p, end);
+            if(p < end && *p == '=') {
+                p = skip_whitespace(p + 1, end);
+                if(p < end && (*p == '"' || *p == '\'')) {
+                    const char* value_end = memchr(p + 1, *p, end - p - 1);
+                    if(value_end == NULL) {
+                        return false;
+                    }
+                    value = p + 1;
+                    value_length = value_end - value;
+                    p = value_end + 1;
+                } else {
+                    value = p;
+                    while(p < end && !isspace((unsigned char)*p) && *p != '>') {
+                        p += 1;
+                    }
+                    value_length = p - value;
+                }
+            }
+            if(name_length == 2 && starts_with_ignore_case(name, end, "id", 2)) {
+                scanner->script_id = value;
+                scanner->script_id_length = value_length;
+            } else if(name_length == 4 && starts_with_ignore_case(name, end, "type", 4)) {
+                type = value;
+                type_length = value_length;
+            }
+        }
+        if(p >= end) {
+            return false;
+        }
+
+        scanner->script_start = p + 1;
+        scanner->script_end = find_tag(scanner->script_start, end, "</script", 8);
+        if(scanner->script_end == NULL) {
+            scanner->script_end = end;
+        }
+        scanner->position = scanner->script_start;
+        scanner->json_script = type != NULL && contains_ignore_case(type, type_length, "json");
+        // templates and other data blocks are not JavaScript
+        if(type == NULL || type_length == 0 || scanner->json_script
+                || contains_ignore_case(type, type_length, "javascript")
+                || contains_ignore_case(type, type_length, "ecmascript")
+                || contains_ignore_case(type, type_length, "module")) {
+            return true;
+        }
+        scanner->position = scanner->script_end;
+    }
+}
+
+/**
+    Check if '=' at given position is an assignment of an object, not a comparison,
+    an arrow function or a compound assignment
+*/
+static bool find_assigned_value(
+    struct ScriptScanner* scanner, const char* equals, struct Assignment* found
+) {
+    const char* start = scanner->script_start;
+    const char* end = scanner->script_end;
+    if(equals + 1 < end && (equals[1] == '=' || equals[1] == '>')) {
+        return false;
+    }
+    if(equals > start && strchr("=!<>+-*/%&|^?", equals[-1]) != NULL) {
+        return false;
+    }
+
+    const char* name_end = equals;
+    while(name_end > start && isspace((unsigned char)name_end[-1])) {
+        name_end -= 1;
+    }
+    const char* name = name_end;
+    while(name > start && is_name_char(name[-1])) {
+        name -= 1;
+    }
+    if(name == name_end || isdigit((unsigned char)*name) || *name == '.' || name_end[-1] == '.') {
+        return false;
+    }
+
+    const char* value = skip_whitespace(equals + 1, end);
+    if(value < end && (*value == '{' || *value == '[')) {
+        found->kind = OBJECT_ASSIGNMENT;
+        found->value = value;
+        found->value_length = end - value;
+    } else if(end - value > 11 && memcmp(value, "JSON.parse(", 11) == 0) {
+        const char* quote = skip_whitespace(value + 11, end);
+        if(quote >= end || (*quote != '"' && *quote != '\'' && *quote != '`')) {
+            return false;
+        }
+        const char* string_end = find_string_end(quote + 1, end, *quote);
+        if(string_end == NULL) {
+            return false;
+        }
+        found->kind = JSON_PARSE_ASSIGNMENT;
+        found->value = quote + 1;
+        found->value_length = string_end - quote - 1;
+    } else {
+        return false;
+    }
+    found->name = name;
+    found->name_length = name_end - name;
+    return true;
+}
+
+/** Find next assignment inside of current script */
+static bool find_assignment(struct ScriptScanner* scanner, struct Assignment* found) {
+    const char* p = scanner->position;
+    const char* end = scanner->script_end;
+    while(p < end) {
+        switch(*p) {
+            case '"':
+            case '\'':
+            case '`':
+                {
+                    const char* string_end = find_string_end(p + 1, end, *p);
+                    p = string_end != NULL ? string_end + 1 : end;
+                }
+            continue;
+            case '/':
+                if(p + 1 < end && p[1] == '/') {
+                    const char* line_end = memchr(p, '\n', end - p);
+                    p = line_end != NULL ? line_end : end;
+                    continue;
+                } else if(p + 1 < end && p[1] == '*') {
+                    const char* comment_end = p + 2;
+                    while(comment_end + 1 < end && !(comment_end[0] == '*' && comment_end[1] == '/')) {
+                        comment_end += 1;
+                    }
+                    p = comment_end + 2 < end ? comment_end + 2 : end;
+                    continue;
+                }
+            break;
+            case '=':
+                if(find_assigned_value(scanner, p, found)) {
+                    // on failure, parsing continues right after the beginning of the value
+                    if(found->kind == OBJECT_ASSIGNMENT) {
+                        scanner->position = found->value + 1;
+                    } else {
+                        scanner->position = found->value + found->value_length + 1;
+                    }
+                    return true;
+                }
+            break;
+        }
+        p += 1;
+    }
+    scanner->position = end;
+    return false;
+}
+
+void init_script_scanner(struct ScriptScanner* scanner, const char* input, size_t length) {
+    scanner->position = input;
+    scanner->end = input + length;
+    scanner->script_start = NULL;
+    scanner->script_end = NULL;
+    scanner->json_script = false;
+    scanner->script_id = NULL;
+    scanner->script_id_length = 0;
+    if(find_tag(input, scanner->end, "<script", 7) == NULL) {
+        scanner->script_start = input;
+        scanner->script_end = scanner->end;
+    }
+}
+
+bool next_assignment(struct ScriptScanner* scanner, struct Assignment* found) {
+    for(;;) {
+        if(scanner->script_end == NULL) {
+            if(!open_next_script(scanner)) {
+                scanner->position = scanner->end;
+                return false;
+            }
+        }
+
+        if(scanner->json_script) {
+            scanner->json_script = false;
+            const char* value = skip_whitespace(scanner->position, scanner->script_end);
+            scanner->position = scanner->script_end;
+            if(value < scanner->script_end && (*value == '{' || *value == '[')) {
+                found->kind = OBJECT_ASSIGNMENT;
+                found->name = scanner->script_id;
+                found->name_length = scanner->script_id_length;
+                found->value = value;
+                found->value_length = scanner->script_end - value;
+                return true;
+            }
+        } else if(find_assignment(scanner, found)) {
+            return true;
+        }
+
+        if(scanner->script_end == scanner->end) {
+            return false;
+        }
+        scanner->position = scanner->script_end;
+        scanner->script_end = NULL;
+    }
+}
+
+void skip_assignment(struct ScriptScanner* scanner, const char* position) {
+    if(position > scanner->position) {
+        scanner->position = position;
+    }
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#ifndef CHOMPJS_HTML_H
+#define CHOMPJS_HTML_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Kinds of values found by script scanner */
+typedef enum {
+    OBJECT_ASSIGNMENT,
+    JSON_PARSE_ASSIGNMENT,
+} AssignmentKind;
+
+/**
+    Value assigned to a name inside of a script:
+    * OBJECT_ASSIGNMENT - `value` starts with '{' or '[' and spans until
+      the end of the script, object end is found by the parser
+    * JSON_PARSE_ASSIGNMENT - `value` is the still escaped content
+      of a string literal passed to `JSON.parse`
+    Name is NULL for JSON scripts without an id attribute
+*/
+struct Assignment {
+    AssignmentKind kind;
+    const char* name;
+    size_t name_length;
+    const char* value;
+    size_t value_length;
+};
+
+/**
+    Finds `<script>` bodies of HTML document and assignments of objects inside
+    of them: `var x = {...}`, `window.x = [...]`, `x = JSON.parse('...')`.
+    Bodies of `<script type="application/json">` tags are reported as objects
+    named after id attribute. Input without any `<script>` tag is scanned
+    as a single script. String literals and comments are skipped
+*/
+struct ScriptScanner {
+    const char* position;
+    const char* end;
+    const char* script_start;
+    const char* script_end;
+    bool json_script;
+    const char* script_id;
+    size_t script_id_length;
+};
+
+/** Initialize scanner */
+void init_script_scanner(struct ScriptScanner* scanner, const char* input, size_t length);
+
+/** Find next assignment, false when there are no more of them */
+bool next_assignment(struct ScriptScanner* scanner, struct Assignment* found);
+
+/** Continue scanning after value ending at `position` was parsed */
+void skip_assignment(struct ScriptScanner* scanner, const char* position);
+
+#endif
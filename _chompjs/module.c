@@ -7,166 +7,3173 @@
 #include <Python.h>
 #include <stdio.h>
 #include "parser.h"
+#include "builder.h"
+#include "hasher.h"
+#include "tape.h"
+#include "recorder.h"
+#include "pool.h"
+#include "tracker.h"
+#include "html.h"
+#include "path.h"
+#include "escape.h"
+#include "chunks.h"
+#include "scan.h"
 
-static PyObject* parse_python_object(PyObject *self, PyObject *args) {
-    const char* string;
-    if (!PyArg_ParseTuple(args, "s", &string)) {
+#if PY_VERSION_HEX < 0x030D0000
+// there is no free-threaded build before 3.13, holding the GIL is enough
+#define Py_BEGIN_CRITICAL_SECTION(op) {
+#define Py_END_CRITICAL_SECTION() }
+#endif
+
+#ifndef Py_TPFLAGS_IMMUTABLETYPE
+#define Py_TPFLAGS_IMMUTABLETYPE 0
+#endif
+
+#ifndef Py_TPFLAGS_DISALLOW_INSTANTIATION
+// tp_new is cleared once the type is created instead
+#define Py_TPFLAGS_DISALLOW_INSTANTIATION 0
+#endif
+
+/**
+    State of the module, separate for every interpreter that imports it.
+    Nothing else is kept in static variables, apart from constants
+*/
+typedef struct {
+    PyTypeObject* parser_type;
+    PyTypeObject* json_iter_type;
+    PyTypeObject* assignment_iter_type;
+    PyTypeObject* item_iter_type;
+    PyTypeObject* stream_type;
+    PyTypeObject* chunk_iter_type;
+    PyTypeObject* parse_job_type;
+    PyTypeObject* lazy_object_type;
+    PyTypeObject* lazy_array_type;
+    // views of collections.abc returned by keys(), values() and items() of lazy objects
+    PyObject* keys_view;
+    PyObject* values_view;
+    PyObject* items_view;
+    // raised when input goes over one of the limits, subclass of ValueError
+    PyObject* limit_exceeded_error;
+    // key of parser pool in thread state dicts
+    PyObject* pool_key;
+#ifdef CHOMPJS_STATS
+    // statistics of all calls, see `get_stats`
+    struct ModuleStats stats;
+#ifdef Py_GIL_DISABLED
+    PyMutex stats_mutex;
+#endif
+#endif
+} ModuleState;
+
+static ModuleState* get_module_state(PyObject* module) {
+    return PyModule_GetState(module);
+}
+
+/** State of the module that created the type */
+static ModuleState* get_type_state(PyTypeObject* type) {
+    return PyModule_GetState(PyType_GetModule(type));
+}
+
+/** Release object of heap type that failed to initialize, dropping its reference to the type */
+static void free_partial_object(PyObject* object) {
+    PyTypeObject* type = Py_TYPE(object);
+    type->tp_free(object);
+    Py_DECREF(type);
+}
+
+/**
+    Mark object as used by the current thread, false without exception if
+    it's used by another one. Parsing is done without GIL, so a check of
+    the flag alone wouldn't be enough
+*/
+static bool try_enter_object(PyObject* object, bool* busy) {
+    bool entered;
+    Py_BEGIN_CRITICAL_SECTION(object);
+    entered = !*busy;
+    *busy = true;
+    Py_END_CRITICAL_SECTION();
+    return entered;
+}
+
+/** Mark object as used by the current thread, set exception if it's used by another one */
+static bool enter_object(PyObject* object, bool* busy) {
+    if(!try_enter_object(object, busy)) {
+        PyErr_Format(PyExc_ValueError, "%s already executing", Py_TYPE(object)->tp_name);
+        return false;
+    }
+    return true;
+}
+
+static void leave_object(PyObject* object, bool* busy) {
+    Py_BEGIN_CRITICAL_SECTION(object);
+    *busy = false;
+    Py_END_CRITICAL_SECTION();
+}
+
+/**
+    Get read-only view of parser input without copying it. Compact ASCII
+    strings are read directly from their storage, other strings through
+    their cached UTF-8 representation. Any object supporting buffer protocol
+    (bytes, bytearray, memoryview, mmap) is accepted as UTF-8 data
+*/
+static int get_input(PyObject* object, Py_buffer* view) {
+    if(PyUnicode_Check(object)) {
+        const char* data;
+        Py_ssize_t length;
+#if PY_VERSION_HEX < 0x030C0000
+        if(PyUnicode_READY(object) < 0) {
+            return -1;
+        }
+#endif
+        if(PyUnicode_IS_COMPACT_ASCII(object)) {
+            data = PyUnicode_DATA(object);
+            length = PyUnicode_GET_LENGTH(object);
+        } else {
+            data = PyUnicode_AsUTF8AndSize(object, &length);
+            if(data == NULL) {
+                return -1;
+            }
+        }
+        return PyBuffer_FillInfo(view, object, (void*)data, length, 1, PyBUF_SIMPLE);
+    }
+    return PyObject_GetBuffer(object, view, PyBUF_SIMPLE);
+}
+
+/** Set exception describing why parsing of an object failed */
+static void set_failure_error(
+    ModuleState* module_state, ParserFailure failure, const struct ParserLimits* limits, size_t position
+) {
+    switch(failure) {
+    case OUTPUT_LIMIT_EXCEEDED:
+        PyErr_Format(
+            module_state->limit_exceeded_error, "Output exceeds max_output_bytes=%zu near character %zu",
+            limits->max_output_bytes, position
+        );
+        break;
+    case DEPTH_LIMIT_EXCEEDED:
+        PyErr_Format(
+            module_state->limit_exceeded_error, "Nesting exceeds max_depth=%zu near character %zu",
+            limits->max_depth, position
+        );
+        break;
+    case OUT_OF_MEMORY:
+        PyErr_NoMemory();
+        break;
+    default:
+        PyErr_Format(PyExc_ValueError, "Error parsing input near character %zu", position);
+    }
+}
+
+static void set_parser_error(ModuleState* module_state, struct Parser* parser) {
+    set_failure_error(module_state, parser->failure, &parser->limits, parser->input_position - 1);
+}
+
+/**
+    Parser stopped because of a limit or lack of memory. Unlike invalid
+    objects, those aren't skipped by iterators
+*/
+static bool is_fatal_failure(struct Parser* parser) {
+    return parser->parser_status == ERROR && parser->failure != INVALID_INPUT;
+}
+
+/** Check size of the input against `max_input_bytes` limit */
+static bool check_input_size(
+    ModuleState* module_state, const struct ParserLimits* limits, size_t length
+) {
+    if(length > limits->max_input_bytes) {
+        PyErr_Format(
+            module_state->limit_exceeded_error, "Input of %zu bytes exceeds max_input_bytes=%zu",
+            length, limits->max_input_bytes
+        );
+        return false;
+    }
+    return true;
+}
+
+/** "O&" converter of a limit argument, None means no limit */
+static int convert_limit(PyObject* object, void* address) {
+    size_t* limit = address;
+    if(object == Py_None) {
+        *limit = SIZE_MAX;
+        return 1;
+    }
+    Py_ssize_t value = PyNumber_AsSsize_t(object, PyExc_OverflowError);
+    if(value == -1 && PyErr_Occurred()) {
+        return 0;
+    }
+    if(value < 0) {
+        PyErr_SetString(PyExc_ValueError, "Limits can't be negative");
+        return 0;
+    }
+    *limit = value;
+    return 1;
+}
+
+// keyword arguments and "O&" converters of limits, in the order of struct ParserLimits
+#define LIMIT_KEYWORDS "max_input_bytes", "max_output_bytes", "max_depth"
+#define LIMIT_FORMAT "O&O&O&"
+#define LIMIT_ARGUMENTS(limits) \
+    convert_limit, &(limits).max_input_bytes, \
+    convert_limit, &(limits).max_output_bytes, \
+    convert_limit, &(limits).max_depth
+
+/**
+    Parser together with a builder, both reused between calls along with
+    all of their buffers. Idle ones are kept in a small per-thread pool,
+    stored in the thread state dict and released together with it
+*/
+struct ReusableParser {
+    struct Parser parser;
+    struct Builder builder;
+    // attached only when content hashes are requested
+    struct ContentHasher hasher;
+#ifdef CHOMPJS_STATS
+    // wall time of the last call
+    uint64_t nanoseconds;
+#endif
+};
+
+#define PARSER_POOL_SIZE 4
+// parsers that grew bigger buffers are released instead of being pooled
+#define MAX_POOLED_BUFFER_SIZE (1 << 20)
+
+struct ParserPool {
+    struct ReusableParser* idle[PARSER_POOL_SIZE];
+    size_t count;
+};
+
+static struct ReusableParser* new_reusable_parser(void) {
+    struct ReusableParser* reusable = PyMem_Malloc(sizeof(struct ReusableParser));
+    if(reusable == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    init_parser(&reusable->parser, NULL, 0);
+    init_builder(&reusable->builder, &reusable->parser, true);
+    init_content_hasher(&reusable->hasher);
+#ifdef CHOMPJS_STATS
+    reusable->nanoseconds = 0;
+#endif
+    return reusable;
+}
+
+static void free_reusable_parser(struct ReusableParser* reusable) {
+    release_builder(&reusable->builder);
+    release_content_hasher(&reusable->hasher);
+    release_parser(&reusable->parser);
+    PyMem_Free(reusable);
+}
+
+/** Point reusable parser to the input, build Python objects if `native` is set */
+static void prepare_parser(
+    struct ReusableParser* reusable, const char* data, size_t length, bool native, bool stop_on_error
+) {
+    reset_parser_input(&reusable->parser, data, length);
+    reset_builder(&reusable->builder);
+    reset_content_hasher(&reusable->hasher);
+    if(native) {
+        attach_builder(&reusable->builder, &reusable->parser, stop_on_error);
+    } else {
+        reusable->parser.sink = NULL;
+    }
+}
+
+static void release_pool(PyObject* capsule) {
+    struct ParserPool* pool = PyCapsule_GetPointer(capsule, "_chompjs.parser_pool");
+    for(size_t i = 0; i < pool->count; ++i) {
+        free_reusable_parser(pool->idle[i]);
+    }
+    PyMem_Free(pool);
+}
+
+/** Pool of the current thread, NULL if it can't be created */
+static struct ParserPool* thread_pool(ModuleState* module_state) {
+    PyObject* dict = PyThreadState_GetDict();
+    // module state is already cleared when objects are released at exit
+    if(dict == NULL || module_state->pool_key == NULL) {
+        return NULL;
+    }
+    PyObject* capsule = PyDict_GetItem(dict, module_state->pool_key);
+    if(capsule != NULL) {
+        return PyCapsule_GetPointer(capsule, "_chompjs.parser_pool");
+    }
+
+    struct ParserPool* pool = PyMem_Calloc(1, sizeof(struct ParserPool));
+    if(pool == NULL) {
+        return NULL;
+    }
+    capsule = PyCapsule_New(pool, "_chompjs.parser_pool", release_pool);
+    if(capsule == NULL) {
+        PyMem_Free(pool);
+        PyErr_Clear();
+        return NULL;
+    }
+    int status = PyDict_SetItem(dict, module_state->pool_key, capsule);
+    Py_DECREF(capsule);
+    if(status < 0) {
+        PyErr_Clear();
+        return NULL;
+    }
+    return pool;
+}
+
+static struct ReusableParser* acquire_parser(ModuleState* module_state) {
+    struct ParserPool* pool = thread_pool(module_state);
+    if(pool != NULL && pool->count > 0) {
+        pool->count -= 1;
+        return pool->idle[pool->count];
+    }
+    return new_reusable_parser();
+}
+
+static void release_to_pool(ModuleState* module_state, struct ReusableParser* reusable) {
+    reset_builder(&reusable->builder);
+    // cached keys are kept, they are bounded in size and likely to repeat
+    reusable->builder.cache_values = false;
+    struct Parser* parser = &reusable->parser;
+    parser->limits = no_limits;
+    struct ParserPool* pool = thread_pool(module_state);
+    if(pool == NULL || pool->count == PARSER_POOL_SIZE
+            || parser->output.memory_buffer_length > MAX_POOLED_BUFFER_SIZE
+            || parser->unescaped_capacity > MAX_POOLED_BUFFER_SIZE
+            || reusable->builder.scratch.memory_buffer_length > MAX_POOLED_BUFFER_SIZE
+            || reusable->hasher.scratch.memory_buffer_length > MAX_POOLED_BUFFER_SIZE) {
+        free_reusable_parser(reusable);
+        return;
+    }
+    pool->idle[pool->count] = reusable;
+    pool->count += 1;
+}
+
+#ifdef CHOMPJS_STATS
+#ifdef Py_GIL_DISABLED
+#define LOCK_STATS(module_state) PyMutex_Lock(&(module_state)->stats_mutex)
+#define UNLOCK_STATS(module_state) PyMutex_Unlock(&(module_state)->stats_mutex)
+#else
+#define LOCK_STATS(module_state)
+#define UNLOCK_STATS(module_state)
+#endif
+
+/** Add a finished call of the parser to module statistics */
+static void record_parser_call(
+    ModuleState* module_state, struct Parser* parser, size_t input_length, uint64_t nanoseconds
+) {
+    const struct ParserStats* stats = collect_parser_stats(parser);
+    LOCK_STATS(module_state);
+    record_call(&module_state->stats, stats, input_length, nanoseconds);
+    UNLOCK_STATS(module_state);
+}
+
+static PyObject* parser_stats_dict(const struct ParserStats* stats) {
+    return Py_BuildValue(
+        "{s:n,s:n,s:n,s:n,s:n,s:n,s:n,s:n}",
+        "bytes_scanned", (Py_ssize_t)stats->bytes_scanned,
+        "bytes_emitted", (Py_ssize_t)stats->bytes_emitted,
+        "output_growths", (Py_ssize_t)stats->output_growths,
+        "peak_depth", (Py_ssize_t)stats->peak_depth,
+        "unrecognized_values", (Py_ssize_t)stats->unrecognized_values,
+        "quoted_values", (Py_ssize_t)stats->quoted_values,
+        "numeric_values", (Py_ssize_t)stats->numeric_values,
+        "comments", (Py_ssize_t)stats->comments
+    );
+}
+
+static PyObject* size_bucket_dict(size_t index, const struct SizeBucket* bucket) {
+    PyObject* latency = PyList_New(LATENCY_BUCKETS);
+    if(latency == NULL) {
+        return NULL;
+    }
+    for(size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+        PyList_SET_ITEM(latency, i, PyLong_FromSize_t(bucket->latency[i]));
+    }
+    // last bucket has no upper bound
+    size_t limit = size_bucket_limit(index);
+    PyObject* max_size = Py_None;
+    if(limit) {
+        max_size = PyLong_FromSize_t(limit);
+    } else {
+        Py_INCREF(Py_None);
+    }
+    double seconds = bucket->nanoseconds / 1e9;
+    return Py_BuildValue(
+        "{s:N,s:n,s:K,s:d,s:d,s:N}",
+        "max_size", max_size,
+        "calls", (Py_ssize_t)bucket->calls,
+        "bytes", (unsigned long long)bucket->bytes,
+        "seconds", seconds,
+        "throughput", seconds > 0 ? bucket->bytes / seconds : 0.0,
+        "latency", latency
+    );
+}
+#endif
+
+static PyObject* get_python_stats(PyObject *self, PyObject *Py_UNUSED(ignored)) {
+#ifdef CHOMPJS_STATS
+    ModuleState* module_state = get_module_state(self);
+    LOCK_STATS(module_state);
+    struct ModuleStats snapshot = module_state->stats;
+    UNLOCK_STATS(module_state);
+
+    PyObject* buckets = PyList_New(SIZE_BUCKETS);
+    if(buckets == NULL) {
+        return NULL;
+    }
+    for(size_t i = 0; i < SIZE_BUCKETS; ++i) {
+        PyObject* bucket = size_bucket_dict(i, &snapshot.buckets[i]);
+        if(bucket == NULL) {
+            Py_DECREF(buckets);
+            return NULL;
+        }
+        PyList_SET_ITEM(buckets, i, bucket);
+    }
+    return Py_BuildValue("{s:N,s:N}", "totals", parser_stats_dict(&snapshot.totals), "buckets", buckets);
+#else
+    Py_RETURN_NONE;
+#endif
+}
+
+static PyObject* reset_python_stats(PyObject *self, PyObject *Py_UNUSED(ignored)) {
+#ifdef CHOMPJS_STATS
+    ModuleState* module_state = get_module_state(self);
+    LOCK_STATS(module_state);
+    memset(&module_state->stats, 0, sizeof(module_state->stats));
+    UNLOCK_STATS(module_state);
+#endif
+    Py_RETURN_NONE;
+}
+
+/**
+    Move parser to the value selected by the path. Values outside
+    of the path are skipped without being parsed
+*/
+static bool select_path(struct Parser* parser, const char* path_string, Py_ssize_t length) {
+    struct Path path;
+    if(!parse_path(&path, path_string, length)) {
+        PyErr_Format(PyExc_ValueError, "Invalid path: %s", path_string);
+        return false;
+    }
+    size_t root;
+    size_t position;
+    bool found;
+    Py_BEGIN_ALLOW_THREADS
+    found = find_object(parser, &root)
+        && locate_path(&path, parser->input, parser->input_length, root, &position);
+    Py_END_ALLOW_THREADS
+    release_path(&path);
+    if(!found) {
+        PyErr_Format(PyExc_ValueError, "Path not found: %s", path_string);
+        return false;
+    }
+    start_at_value(parser, position);
+    return true;
+}
+
+/**
+    Processed JSON text of an object. Loaders such as `orjson.loads` read UTF-8
+    bytes directly, with `as_bytes` the text isn't decoded just to be encoded back
+*/
+static PyObject* output_text(const char* data, size_t length, bool as_bytes) {
+    if(as_bytes) {
+        return PyBytes_FromStringAndSize(data, length);
+    }
+    return PyUnicode_DecodeUTF8(data, length, NULL);
+}
+
+/** Pair of an object and content hash of the last value hashed, steals the reference */
+static PyObject* with_content_hash(PyObject* object, struct ContentHasher* hasher) {
+    if(object == NULL) {
+        return NULL;
+    }
+    return Py_BuildValue("NK", object, (unsigned long long)hasher->result);
+}
+
+// keys of objects with more members than this are indexed after the first lookup
+#define LINEAR_LOOKUP_MEMBERS 16
+
+/**
+    Read-only view of an object or array stored on a tape. Python objects
+    are only created for values that are accessed. Proxies of the same
+    document share the tape, it's released together with the last of them
+*/
+typedef struct {
+    PyObject_HEAD
+    // capsule owning the tape
+    PyObject* owner;
+    const struct Tape* tape;
+    size_t entry;
+    // built on first use: objects map keys to entries of values, arrays keep entries of elements
+    PyObject* keys;
+    size_t* elements;
+    Py_ssize_t length;
+} LazyProxy;
+
+static void release_tape_owner(PyObject* capsule) {
+    struct Tape* tape = PyCapsule_GetPointer(capsule, "_chompjs.tape");
+    release_tape(tape);
+    PyMem_Free(tape);
+}
+
+static PyObject* new_lazy_proxy(
+    ModuleState* module_state, PyObject* owner, const struct Tape* tape, size_t entry
+) {
+    PyTypeObject* type = tape->entries[entry].type == TAPE_OBJECT
+        ? module_state->lazy_object_type : module_state->lazy_array_type;
+    LazyProxy* proxy = (LazyProxy*)type->tp_alloc(type, 0);
+    if(proxy == NULL) {
+        return NULL;
+    }
+    Py_INCREF(owner);
+    proxy->owner = owner;
+    proxy->tape = tape;
+    proxy->entry = entry;
+    proxy->keys = NULL;
+    proxy->elements = NULL;
+    proxy->length = 0;
+    return (PyObject*)proxy;
+}
+
+static void lazy_proxy_dealloc(LazyProxy* proxy) {
+    PyTypeObject* type = Py_TYPE(proxy);
+    Py_XDECREF(proxy->keys);
+    PyMem_Free(proxy->elements);
+    Py_XDECREF(proxy->owner);
+    type->tp_free(proxy);
+    Py_DECREF(type);
+}
+
+/** Python object of a string, number or literal stored on the tape */
+static PyObject* tape_scalar(const struct Tape* tape, size_t index) {
+    const struct TapeEntry* entry = &tape->entries[index];
+    switch(entry->type) {
+        case TAPE_TRUE:
+            Py_RETURN_TRUE;
+        case TAPE_FALSE:
+            Py_RETURN_FALSE;
+        case TAPE_NULL:
+            Py_RETURN_NONE;
+    }
+    PyObject* ret;
+    size_t length;
+    const char* text = entry_text(tape, entry, &length);
+    if(entry->escaped) {
+        struct CharBuffer scratch;
+        init_char_buffer(&scratch, length);
+        ret = build_scalar(&scratch, text, length);
+        release_char_buffer(&scratch);
+    } else {
+        ret = build_scalar(NULL, text, length);
+    }
+    if(ret == NULL && !PyErr_Occurred()) {
+        PyErr_SetString(PyExc_ValueError, "Invalid value");
+    }
+    return ret;
+}
+
+/** Value of the entry, containers are returned as proxies sharing the tape */
+static PyObject* lazy_value(LazyProxy* proxy, size_t index) {
+    uint8_t type = proxy->tape->entries[index].type;
+    if(type == TAPE_OBJECT || type == TAPE_ARRAY) {
+        return new_lazy_proxy(get_type_state(Py_TYPE(proxy)), proxy->owner, proxy->tape, index);
+    }
+    return tape_scalar(proxy->tape, index);
+}
+
+/** Build Python objects of the whole value, the same ones parsing without a tape returns */
+static PyObject* tape_to_python(const struct Tape* tape, size_t index) {
+    const struct TapeEntry* entry = &tape->entries[index];
+    if(entry->type != TAPE_OBJECT && entry->type != TAPE_ARRAY) {
+        return tape_scalar(tape, index);
+    }
+    if(Py_EnterRecursiveCall(" while converting lazy object")) {
+        return NULL;
+    }
+    bool is_object = entry->type == TAPE_OBJECT;
+    size_t length = 0;
+    for(size_t element = index + 1; !is_object && element < entry->position; ++length) {
+        element = next_entry(tape, element);
+    }
+    PyObject* ret = is_object ? PyDict_New() : PyList_New(length);
+    size_t element = index + 1;
+    for(size_t i = 0; ret != NULL && element < entry->position; ++i) {
+        PyObject* key = NULL;
+        if(is_object) {
+            key = tape_scalar(tape, element);
+            element += 1;
+        }
+        PyObject* value = is_object && key == NULL ? NULL : tape_to_python(tape, element);
+        if(value == NULL) {
+            Py_XDECREF(key);
+            Py_CLEAR(ret);
+            break;
+        }
+        if(is_object) {
+            int status = PyDict_SetItem(ret, key, value);
+            Py_DECREF(key);
+            Py_DECREF(value);
+            if(status < 0) {
+                Py_CLEAR(ret);
+            }
+        } else {
+            PyList_SET_ITEM(ret, i, value);
+        }
+        element = next_entry(tape, element);
+    }
+    Py_LeaveRecursiveCall();
+    return ret;
+}
+
+static PyObject* lazy_proxy_to_python(LazyProxy* proxy, PyObject *Py_UNUSED(ignored)) {
+    return tape_to_python(proxy->tape, proxy->entry);
+}
+
+/** Dict of keys of the object mapped to entries of their values, the last duplicate wins */
+static PyObject* lazy_object_keys(LazyProxy* proxy) {
+    PyObject* keys;
+    Py_BEGIN_CRITICAL_SECTION(proxy);
+    keys = proxy->keys;
+    Py_XINCREF(keys);
+    Py_END_CRITICAL_SECTION();
+    if(keys != NULL) {
+        return keys;
+    }
+
+    const struct Tape* tape = proxy->tape;
+    keys = PyDict_New();
+    size_t end = tape->entries[proxy->entry].position;
+    for(size_t member = proxy->entry + 1; keys != NULL && member < end; ) {
+        PyObject* key = tape_scalar(tape, member);
+        PyObject* value = key != NULL ? PyLong_FromSize_t(member + 1) : NULL;
+        if(value == NULL || PyDict_SetItem(keys, key, value) < 0) {
+            Py_CLEAR(keys);
+        }
+        Py_XDECREF(key);
+        Py_XDECREF(value);
+        member = next_entry(tape, member + 1);
+    }
+    if(keys == NULL) {
+        return NULL;
+    }
+    // another thread might have built them in the meantime, those are used instead
+    Py_BEGIN_CRITICAL_SECTION(proxy);
+    if(proxy->keys == NULL) {
+        Py_INCREF(keys);
+        proxy->keys = keys;
+    } else {
+        Py_DECREF(keys);
+        keys = proxy->keys;
+        Py_INCREF(keys);
+    }
+    Py_END_CRITICAL_SECTION();
+    return keys;
+}
+
+/**
+    Find entry of the value under given key. Returns 0 and sets `value`,
+    or -1 if it's missing, or -2 with exception set on error
+*/
+static int find_member(LazyProxy* proxy, PyObject* key, size_t* value) {
+    if(!PyUnicode_Check(key)) {
+        return -1;
+    }
+    const struct Tape* tape = proxy->tape;
+    PyObject* keys;
+    Py_BEGIN_CRITICAL_SECTION(proxy);
+    keys = proxy->keys;
+    Py_XINCREF(keys);
+    Py_END_CRITICAL_SECTION();
+    if(keys != NULL) {
+        PyObject* found = PyDict_GetItemWithError(keys, key);
+        int ret = found != NULL ? 0 : (PyErr_Occurred() ? -2 : -1);
+        if(found != NULL) {
+            *value = PyLong_AsSize_t(found);
+        }
+        Py_DECREF(keys);
+        return ret;
+    }
+
+    Py_ssize_t length;
+    const char* data = PyUnicode_AsUTF8AndSize(key, &length);
+    if(data == NULL) {
+        return -2;
+    }
+    int ret = -1;
+    size_t members = 0;
+    size_t end = tape->entries[proxy->entry].position;
+    for(size_t member = proxy->entry + 1; member < end; ++members) {
+        const struct TapeEntry* entry = &tape->entries[member];
+        size_t key_length;
+        const char* text = entry_text(tape, entry, &key_length);
+        bool matches;
+        if(!entry->escaped) {
+            matches = key_length - 2 == (size_t)length && memcmp(text + 1, data, length) == 0;
+        } else {
+            PyObject* decoded = tape_scalar(tape, member);
+            if(decoded == NULL) {
+                return -2;
+            }
+            matches = PyUnicode_Compare(decoded, key) == 0;
+            Py_DECREF(decoded);
+        }
+        if(matches) {
+            *value = member + 1;
+            ret = 0;
+        }
+        member = next_entry(tape, member + 1);
+    }
+    // big objects are unlikely to be looked up only once
+    if(members > LINEAR_LOOKUP_MEMBERS) {
+        keys = lazy_object_keys(proxy);
+        if(keys == NULL) {
+            return -2;
+        }
+        Py_DECREF(keys);
+    }
+    return ret;
+}
+
+static PyObject* lazy_object_subscript(LazyProxy* proxy, PyObject* key) {
+    size_t value;
+    int status = find_member(proxy, key, &value);
+    if(status == -1) {
+        PyErr_SetObject(PyExc_KeyError, key);
+    }
+    return status == 0 ? lazy_value(proxy, value) : NULL;
+}
+
+static int lazy_object_contains(LazyProxy* proxy, PyObject* key) {
+    size_t value;
+    int status = find_member(proxy, key, &value);
+    return status == -2 ? -1 : status == 0;
+}
+
+static Py_ssize_t lazy_object_length(LazyProxy* proxy) {
+    PyObject* keys = lazy_object_keys(proxy);
+    if(keys == NULL) {
+        return -1;
+    }
+    Py_ssize_t length = PyDict_GET_SIZE(keys);
+    Py_DECREF(keys);
+    return length;
+}
+
+static PyObject* lazy_object_iter(LazyProxy* proxy) {
+    PyObject* keys = lazy_object_keys(proxy);
+    if(keys == NULL) {
+        return NULL;
+    }
+    PyObject* iterator = PyObject_GetIter(keys);
+    Py_DECREF(keys);
+    return iterator;
+}
+
+static PyObject* lazy_object_get(LazyProxy* proxy, PyObject* args) {
+    PyObject* key;
+    PyObject* default_value = Py_None;
+    if(!PyArg_UnpackTuple(args, "get", 1, 2, &key, &default_value)) {
+        return NULL;
+    }
+    size_t value;
+    int status = find_member(proxy, key, &value);
+    if(status == -1) {
+        Py_INCREF(default_value);
+        return default_value;
+    }
+    return status == 0 ? lazy_value(proxy, value) : NULL;
+}
+
+/** View of the object, same as the ones returned by dicts, `view` is one of collections.abc views */
+static PyObject* lazy_object_view(LazyProxy* proxy, PyObject* view) {
+    return PyObject_CallOneArg(view, (PyObject*)proxy);
+}
+
+static PyObject* lazy_object_keys_view(LazyProxy* proxy, PyObject *Py_UNUSED(ignored)) {
+    return lazy_object_view(proxy, get_type_state(Py_TYPE(proxy))->keys_view);
+}
+
+static PyObject* lazy_object_values(LazyProxy* proxy, PyObject *Py_UNUSED(ignored)) {
+    return lazy_object_view(proxy, get_type_state(Py_TYPE(proxy))->values_view);
+}
+
+static PyObject* lazy_object_items(LazyProxy* proxy, PyObject *Py_UNUSED(ignored)) {
+    return lazy_object_view(proxy, get_type_state(Py_TYPE(proxy))->items_view);
+}
+
+/**
+    Entries of elements of the array, their number is stored in `length`.
+    NULL with exception set if memory can't be allocated
+*/
+static const size_t* lazy_array_elements(LazyProxy* proxy) {
+    size_t* elements;
+    Py_BEGIN_CRITICAL_SECTION(proxy);
+    elements = proxy->elements;
+    Py_END_CRITICAL_SECTION();
+    if(elements != NULL) {
+        return elements;
+    }
+
+    const struct Tape* tape = proxy->tape;
+    size_t end = tape->entries[proxy->entry].position;
+    Py_ssize_t length = 0;
+    for(size_t element = proxy->entry + 1; element < end; ++length) {
+        element = next_entry(tape, element);
+    }
+    elements = PyMem_Malloc((length ? length : 1) * sizeof(size_t));
+    if(elements == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    size_t element = proxy->entry + 1;
+    for(Py_ssize_t i = 0; i < length; ++i) {
+        elements[i] = element;
+        element = next_entry(tape, element);
+    }
+    // another thread might have built them in the meantime, those are used instead
+    Py_BEGIN_CRITICAL_SECTION(proxy);
+    if(proxy->elements == NULL) {
+        proxy->elements = elements;
+        proxy->length = length;
+    } else {
+        PyMem_Free(elements);
+        elements = proxy->elements;
+    }
+    Py_END_CRITICAL_SECTION();
+    return elements;
+}
+
+static Py_ssize_t lazy_array_length(LazyProxy* proxy) {
+    if(lazy_array_elements(proxy) == NULL) {
+        return -1;
+    }
+    return proxy->length;
+}
+
+static PyObject* lazy_array_item(LazyProxy* proxy, Py_ssize_t index) {
+    const size_t* elements = lazy_array_elements(proxy);
+    if(elements == NULL) {
+        return NULL;
+    }
+    if(index < 0 || index >= proxy->length) {
+        PyErr_SetString(PyExc_IndexError, "list index out of range");
+        return NULL;
+    }
+    return lazy_value(proxy, elements[index]);
+}
+
+static PyObject* lazy_array_subscript(LazyProxy* proxy, PyObject* item) {
+    if(PyIndex_Check(item)) {
+        Py_ssize_t index = PyNumber_AsSsize_t(item, PyExc_IndexError);
+        if(index == -1 && PyErr_Occurred()) {
+            return NULL;
+        }
+        if(index < 0) {
+            Py_ssize_t length = lazy_array_length(proxy);
+            if(length < 0) {
+                return NULL;
+            }
+            index += length;
+        }
+        return lazy_array_item(proxy, index);
+    }
+    if(!PySlice_Check(item)) {
+        PyErr_Format(
+            PyExc_TypeError, "list indices must be integers or slices, not %.200s", Py_TYPE(item)->tp_name
+        );
+        return NULL;
+    }
+    Py_ssize_t start, stop, step;
+    if(PySlice_Unpack(item, &start, &stop, &step) < 0) {
+        return NULL;
+    }
+    const size_t* elements = lazy_array_elements(proxy);
+    if(elements == NULL) {
+        return NULL;
+    }
+    Py_ssize_t length = PySlice_AdjustIndices(proxy->length, &start, &stop, step);
+    PyObject* ret = PyList_New(length);
+    for(Py_ssize_t i = 0; ret != NULL && i < length; ++i) {
+        PyObject* value = lazy_value(proxy, elements[start + i * step]);
+        if(value == NULL) {
+            Py_CLEAR(ret);
+            break;
+        }
+        PyList_SET_ITEM(ret, i, value);
+    }
+    return ret;
+}
+
+/**
+    Compare element at given index with the value, same as `==` does. Returns 1
+    if they are equal, 0 if not, -1 with exception set on error
+*/
+static int lazy_array_element_equals(LazyProxy* proxy, Py_ssize_t index, PyObject* value) {
+    PyObject* element = lazy_value(proxy, proxy->elements[index]);
+    if(element == NULL) {
+        return -1;
+    }
+    int ret = PyObject_RichCompareBool(element, value, Py_EQ);
+    Py_DECREF(element);
+    return ret;
+}
+
+static int lazy_array_contains(LazyProxy* proxy, PyObject* value) {
+    if(lazy_array_elements(proxy) == NULL) {
+        return -1;
+    }
+    for(Py_ssize_t i = 0; i < proxy->length; ++i) {
+        int status = lazy_array_element_equals(proxy, i, value);
+        if(status != 0) {
+            return status;
+        }
+    }
+    return 0;
+}
+
+static PyObject* lazy_array_iter(LazyProxy* proxy) {
+    return PySeqIter_New((PyObject*)proxy);
+}
+
+static PyObject* lazy_array_reversed(LazyProxy* proxy, PyObject *Py_UNUSED(ignored)) {
+    PyObject* step = PyLong_FromLong(-1);
+    PyObject* slice = step != NULL ? PySlice_New(NULL, NULL, step) : NULL;
+    Py_XDECREF(step);
+    if(slice == NULL) {
+        return NULL;
+    }
+    PyObject* elements = lazy_array_subscript(proxy, slice);
+    Py_DECREF(slice);
+    if(elements == NULL) {
+        return NULL;
+    }
+    PyObject* ret = PyObject_GetIter(elements);
+    Py_DECREF(elements);
+    return ret;
+}
+
+static PyObject* lazy_array_index(LazyProxy* proxy, PyObject* args) {
+    PyObject* value;
+    Py_ssize_t start = 0;
+    Py_ssize_t stop = PY_SSIZE_T_MAX;
+    if(!PyArg_ParseTuple(args, "O|nn:index", &value, &start, &stop)) {
+        return NULL;
+    }
+    if(lazy_array_elements(proxy) == NULL) {
+        return NULL;
+    }
+    // same bounds as list.index
+    if(start < 0) {
+        start = start + proxy->length < 0 ? 0 : start + proxy->length;
+    }
+    if(stop < 0) {
+        stop = stop + proxy->length < 0 ? 0 : stop + proxy->length;
+    }
+    for(Py_ssize_t i = start; i < stop && i < proxy->length; ++i) {
+        int status = lazy_array_element_equals(proxy, i, value);
+        if(status < 0) {
+            return NULL;
+        } else if(status > 0) {
+            return PyLong_FromSsize_t(i);
+        }
+    }
+    PyErr_SetString(PyExc_ValueError, "value is not in list");
+    return NULL;
+}
+
+static PyObject* lazy_array_count(LazyProxy* proxy, PyObject* value) {
+    if(lazy_array_elements(proxy) == NULL) {
+        return NULL;
+    }
+    Py_ssize_t count = 0;
+    for(Py_ssize_t i = 0; i < proxy->length; ++i) {
+        int status = lazy_array_element_equals(proxy, i, value);
+        if(status < 0) {
+            return NULL;
+        }
+        count += status;
+    }
+    return PyLong_FromSsize_t(count);
+}
+
+/** Proxies are compared by their values, with each other or with dicts and lists */
+static PyObject* lazy_proxy_richcompare(PyObject* self, PyObject* other, int op) {
+    if(op != Py_EQ && op != Py_NE) {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+    PyObject* value = lazy_proxy_to_python((LazyProxy*)self, NULL);
+    if(value == NULL) {
+        return NULL;
+    }
+    PyObject* other_value;
+    if(Py_TYPE(other)->tp_richcompare == lazy_proxy_richcompare) {
+        other_value = lazy_proxy_to_python((LazyProxy*)other, NULL);
+        if(other_value == NULL) {
+            Py_DECREF(value);
+            return NULL;
+        }
+    } else {
+        Py_INCREF(other);
+        other_value = other;
+    }
+    PyObject* ret = PyObject_RichCompare(value, other_value, op);
+    Py_DECREF(value);
+    Py_DECREF(other_value);
+    return ret;
+}
+
+static PyObject* lazy_proxy_repr(LazyProxy* proxy) {
+    PyObject* value = lazy_proxy_to_python(proxy, NULL);
+    if(value == NULL) {
+        return NULL;
+    }
+    PyObject* ret = PyObject_Repr(value);
+    Py_DECREF(value);
+    return ret;
+}
+
+static PyMethodDef lazy_object_methods[] = {
+    {"get", (PyCFunction)lazy_object_get, METH_VARARGS, "Value under the key, or default if it's missing"},
+    {"keys", (PyCFunction)lazy_object_keys_view, METH_NOARGS, "View of keys"},
+    {"values", (PyCFunction)lazy_object_values, METH_NOARGS, "View of values"},
+    {"items", (PyCFunction)lazy_object_items, METH_NOARGS, "View of (key, value) pairs"},
+    {"to_python", (PyCFunction)lazy_proxy_to_python, METH_NOARGS, "Convert the whole object into dict"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyType_Slot lazy_object_slots[] = {
+    {Py_tp_dealloc, lazy_proxy_dealloc},
+    {Py_tp_repr, lazy_proxy_repr},
+    {Py_tp_hash, PyObject_HashNotImplemented},
+    {Py_tp_richcompare, lazy_proxy_richcompare},
+    {Py_tp_iter, lazy_object_iter},
+    {Py_tp_methods, lazy_object_methods},
+    {Py_mp_length, lazy_object_length},
+    {Py_mp_subscript, lazy_object_subscript},
+    {Py_sq_contains, lazy_object_contains},
+    {0, NULL}
+};
+
+static PyType_Spec lazy_object_spec = {
+    "_chompjs.lazy_object",
+    sizeof(LazyProxy),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    lazy_object_slots
+};
+
+static PyMethodDef lazy_array_methods[] = {
+    {"index", (PyCFunction)lazy_array_index, METH_VARARGS, "Index of the first element equal to the value"},
+    {"count", (PyCFunction)lazy_array_count, METH_O, "Number of elements equal to the value"},
+    {"__reversed__", (PyCFunction)lazy_array_reversed, METH_NOARGS, "Iterate over elements in reverse order"},
+    {"to_python", (PyCFunction)lazy_proxy_to_python, METH_NOARGS, "Convert the whole array into list"},
+    {NULL, NULL, 0, NULL}
+};
+
+// iteration goes through sq_item, elements are created one at a time
+static PyType_Slot lazy_array_slots[] = {
+    {Py_tp_iter, lazy_array_iter},
+    {Py_tp_dealloc, lazy_proxy_dealloc},
+    {Py_tp_repr, lazy_proxy_repr},
+    {Py_tp_hash, PyObject_HashNotImplemented},
+    {Py_tp_richcompare, lazy_proxy_richcompare},
+    {Py_tp_methods, lazy_array_methods},
+    {Py_mp_length, lazy_array_length},
+    {Py_mp_subscript, lazy_array_subscript},
+    {Py_sq_length, lazy_array_length},
+    {Py_sq_item, lazy_array_item},
+    {Py_sq_contains, lazy_array_contains},
+    {0, NULL}
+};
+
+static PyType_Spec lazy_array_spec = {
+    "_chompjs.lazy_array",
+    sizeof(LazyProxy),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    lazy_array_slots
+};
+
+/**
+    Result of parsing into the tape: proxy of the object sharing the tape,
+    or the value itself if it's not a container, such as one selected by path
+*/
+static PyObject* lazy_result(ModuleState* module_state, struct TapeWriter* writer) {
+    struct Tape* tape = PyMem_Malloc(sizeof(struct Tape));
+    if(tape == NULL) {
+        return PyErr_NoMemory();
+    }
+    if(!take_tape(writer, tape)) {
+        PyMem_Free(tape);
+        return NULL;
+    }
+    uint8_t type = tape->entries[0].type;
+    if(type != TAPE_OBJECT && type != TAPE_ARRAY) {
+        PyObject* ret = tape_scalar(tape, 0);
+        release_tape(tape);
+        PyMem_Free(tape);
+        return ret;
+    }
+    PyObject* owner = PyCapsule_New(tape, "_chompjs.tape", release_tape_owner);
+    if(owner == NULL) {
+        release_tape(tape);
+        PyMem_Free(tape);
+        return NULL;
+    }
+    PyObject* ret = new_lazy_proxy(module_state, owner, tape, 0);
+    Py_DECREF(owner);
+    return ret;
+}
+
+/** Extract the first object of the input with given parser */
+static PyObject* parse_input(
+    ModuleState* module_state, struct ReusableParser* reusable, PyObject* string, bool native,
+    bool unicode_escape, const char* path, Py_ssize_t path_length, bool cache_values,
+    bool as_bytes, bool content_hash, bool lazy, const struct ParserLimits* limits
+) {
+    Py_buffer input;
+    if(get_input(string, &input) < 0) {
+        return NULL;
+    }
+    if(!check_input_size(module_state, limits, input.len)) {
+        PyBuffer_Release(&input);
+        return NULL;
+    }
+
+#ifdef CHOMPJS_STATS
+    uint64_t started = monotonic_ns();
+#endif
+    struct Parser* parser = &reusable->parser;
+    prepare_parser(reusable, input.buf, input.len, native && !lazy, true);
+    // tape is written without GIL, the same way as text
+    struct TapeWriter writer;
+    if(lazy) {
+        init_tape_writer(&writer, parser);
+    }
+    if(content_hash) {
+        attach_content_hasher(&reusable->hasher, parser);
+    }
+    parser->limits = *limits;
+    reusable->builder.cache_values = cache_values;
+    bool unescaped = true;
+    if(unicode_escape) {
+        Py_BEGIN_ALLOW_THREADS
+        unescaped = unescape_input(parser);
+        Py_END_ALLOW_THREADS
+    }
+    if(!unescaped || (path != NULL && !select_path(parser, path, path_length))) {
+        if(lazy) {
+            release_tape_writer(&writer);
+        }
+        PyBuffer_Release(&input);
+        return unescaped ? NULL : PyErr_NoMemory();
+    }
+
+    PyObject* ret = NULL;
+    if(lazy) {
+        Py_BEGIN_ALLOW_THREADS
+        while(parser->parser_status == CAN_ADVANCE) {
+            advance(parser);
+        }
+        Py_END_ALLOW_THREADS
+        if(writer.out_of_memory) {
+            PyErr_NoMemory();
+        } else if(parser->parser_status == FINISHED) {
+            ret = lazy_result(module_state, &writer);
+        }
+        release_tape_writer(&writer);
+    } else if(native) {
+        while(parser->parser_status == CAN_ADVANCE) {
+            advance(parser);
+        }
+        if(parser->parser_status == FINISHED) {
+            ret = builder_result(&reusable->builder);
+        }
+        reset_builder(&reusable->builder);
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        while(parser->parser_status == CAN_ADVANCE) {
+            advance(parser);
+        }
+        Py_END_ALLOW_THREADS
+        if(parser->parser_status == FINISHED) {
+            ret = output_text(parser->output.data, parser->output.index-1, as_bytes);
+        }
+    }
+#ifdef CHOMPJS_STATS
+    reusable->nanoseconds = monotonic_ns() - started;
+    record_parser_call(module_state, parser, input.len, reusable->nanoseconds);
+#endif
+    PyBuffer_Release(&input);
+    if(ret == NULL && !PyErr_Occurred()) {
+        set_parser_error(module_state, parser);
+    }
+    if(content_hash) {
+        return with_content_hash(ret, &reusable->hasher);
+    }
+    return ret;
+}
+
+static PyObject* parse_python_object(PyObject *self, PyObject *args, PyObject *kwargs) {
+    static char* kwlist[] = {
+        "string", "native", "unicode_escape", "path", "cache_values", "as_bytes", "content_hash",
+        "lazy", LIMIT_KEYWORDS, NULL
+    };
+    PyObject* string;
+    int native = 0;
+    int unicode_escape = 0;
+    const char* path = NULL;
+    Py_ssize_t path_length = 0;
+    int cache_values = 0;
+    int as_bytes = 0;
+    int content_hash = 0;
+    int lazy = 0;
+    struct ParserLimits limits = no_limits;
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "O|ppz#pppp" LIMIT_FORMAT, kwlist, &string, &native, &unicode_escape,
+            &path, &path_length, &cache_values, &as_bytes, &content_hash, &lazy,
+            LIMIT_ARGUMENTS(limits))) {
+        return NULL;
+    }
+    ModuleState* module_state = get_module_state(self);
+    struct ReusableParser* reusable = acquire_parser(module_state);
+    if(reusable == NULL) {
+        return NULL;
+    }
+    PyObject* ret = parse_input(
+        module_state, reusable, string, native, unicode_escape, path, path_length, cache_values,
+        as_bytes, content_hash, lazy, &limits
+    );
+    release_to_pool(module_state, reusable);
+    return ret;
+}
+
+/**
+    Parser object owning its buffers. Module level functions use pooled
+    parsers instead, this one is never shared with other calls
+*/
+typedef struct {
+    PyObject_HEAD
+    struct ReusableParser* reusable;
+    bool busy;
+} ParserObject;
+
+static PyObject* parser_object_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+    static char* kwlist[] = {NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "", kwlist)) {
+        return NULL;
+    }
+    ParserObject* self = (ParserObject *)type->tp_alloc(type, 0);
+    if (!self) {
+        return NULL;
+    }
+    self->reusable = new_reusable_parser();
+    if(self->reusable == NULL) {
+        free_partial_object((PyObject*)self);
+        return NULL;
+    }
+    return (PyObject* )self;
+}
+
+static void parser_object_dealloc(ParserObject* self) {
+    PyTypeObject* type = Py_TYPE(self);
+    free_reusable_parser(self->reusable);
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+static PyObject* parser_object_parse(ParserObject* self, PyObject *args, PyObject *kwargs) {
+    static char* kwlist[] = {
+        "string", "native", "unicode_escape", "path", "cache_values", "as_bytes", "content_hash",
+        "lazy", LIMIT_KEYWORDS, NULL
+    };
+    PyObject* string;
+    int native = 0;
+    int unicode_escape = 0;
+    const char* path = NULL;
+    Py_ssize_t path_length = 0;
+    int cache_values = 0;
+    int as_bytes = 0;
+    int content_hash = 0;
+    int lazy = 0;
+    struct ParserLimits limits = no_limits;
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "O|ppz#pppp" LIMIT_FORMAT, kwlist, &string, &native, &unicode_escape,
+            &path, &path_length, &cache_values, &as_bytes, &content_hash, &lazy,
+            LIMIT_ARGUMENTS(limits))) {
+        return NULL;
+    }
+    // GIL is released while parsing, another thread might be using the parser
+    if(!try_enter_object((PyObject*)self, &self->busy)) {
+        return parse_python_object(PyType_GetModule(Py_TYPE(self)), args, kwargs);
+    }
+    PyObject* ret = parse_input(
+        get_type_state(Py_TYPE(self)), self->reusable, string, native, unicode_escape,
+        path, path_length, cache_values, as_bytes, content_hash, lazy, &limits
+    );
+    leave_object((PyObject*)self, &self->busy);
+    return ret;
+}
+
+static PyObject* parser_object_stats(ParserObject* self, PyObject *Py_UNUSED(ignored)) {
+#ifdef CHOMPJS_STATS
+    PyObject* ret = parser_stats_dict(collect_parser_stats(&self->reusable->parser));
+    if(ret == NULL) {
+        return NULL;
+    }
+    PyObject* seconds = PyFloat_FromDouble(self->reusable->nanoseconds / 1e9);
+    if(seconds == NULL || PyDict_SetItemString(ret, "seconds", seconds) < 0) {
+        Py_XDECREF(seconds);
+        Py_DECREF(ret);
+        return NULL;
+    }
+    Py_DECREF(seconds);
+    return ret;
+#else
+    Py_RETURN_NONE;
+#endif
+}
+
+static PyMethodDef parser_object_methods[] = {
+    {
+        "parse", (PyCFunction)(void(*)(void))parser_object_parse, METH_VARARGS | METH_KEYWORDS,
+        "Extract JSON object from the string, same as module level parse function"
+    },
+    {
+        "stats", (PyCFunction)parser_object_stats, METH_NOARGS,
+        "Statistics of the last parse call, None if built without CHOMPJS_STATS"
+    },
+    {NULL, NULL, 0, NULL}
+};
+
+static PyType_Slot parser_object_slots[] = {
+    {Py_tp_dealloc, parser_object_dealloc},
+    {Py_tp_methods, parser_object_methods},
+    {Py_tp_new, parser_object_new},
+    {0, NULL}
+};
+
+static PyType_Spec parser_object_spec = {
+    "_chompjs.parser",
+    sizeof(ParserObject),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE,
+    parser_object_slots
+};
+
+static PyObject* create_python_parser(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *obj = PyObject_Call((PyObject *)get_module_state(self)->parser_type, args, kwargs);
+    return obj;
+}
+
+/**
+    Extraction of the first object of the input done in slices, so that
+    callers such as event loops can do other work in between. Outcome of
+    the parsing, a result or an exception, is kept until it's taken
+*/
+typedef struct {
+    PyObject_HEAD
+    Py_buffer input;
+    size_t length;
+    // given back to the pool as soon as parsing is over
+    struct ReusableParser* reusable;
+    bool native;
+    bool as_bytes;
+    bool busy;
+    bool finished;
+    PyObject* result;
+    PyObject* error_type;
+    PyObject* error_value;
+    PyObject* error_traceback;
+#ifdef CHOMPJS_STATS
+    uint64_t nanoseconds;
+#endif
+} ParseJobState;
+
+static PyObject* parse_job_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+    static char* kwlist[] = {
+        "string", "native", "unicode_escape", "path", "cache_values", "as_bytes", LIMIT_KEYWORDS,
+        NULL
+    };
+    PyObject* string;
+    int native = 0;
+    int unicode_escape = 0;
+    const char* path = NULL;
+    Py_ssize_t path_length = 0;
+    int cache_values = 0;
+    int as_bytes = 0;
+    struct ParserLimits limits = no_limits;
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "O|ppz#pp" LIMIT_FORMAT, kwlist, &string, &native, &unicode_escape,
+            &path, &path_length, &cache_values, &as_bytes, LIMIT_ARGUMENTS(limits))) {
+        return NULL;
+    }
+
+    ModuleState* module_state = get_type_state(type);
+    ParseJobState* job = (ParseJobState *)type->tp_alloc(type, 0);
+    if (!job) {
+        return NULL;
+    }
+    if(get_input(string, &job->input) < 0) {
+        free_partial_object((PyObject*)job);
+        return NULL;
+    }
+    if(!check_input_size(module_state, &limits, job->input.len)) {
+        PyBuffer_Release(&job->input);
+        free_partial_object((PyObject*)job);
+        return NULL;
+    }
+    job->reusable = acquire_parser(module_state);
+    if(job->reusable == NULL) {
+        PyBuffer_Release(&job->input);
+        free_partial_object((PyObject*)job);
+        return NULL;
+    }
+    struct Parser* parser = &job->reusable->parser;
+    prepare_parser(job->reusable, job->input.buf, job->input.len, native, true);
+    parser->limits = limits;
+    job->reusable->builder.cache_values = cache_values;
+    bool unescaped = true;
+    if(unicode_escape) {
+        Py_BEGIN_ALLOW_THREADS
+        unescaped = unescape_input(parser);
+        Py_END_ALLOW_THREADS
+    }
+    if(!unescaped || (path != NULL && !select_path(parser, path, path_length))) {
+        release_to_pool(module_state, job->reusable);
+        PyBuffer_Release(&job->input);
+        free_partial_object((PyObject*)job);
+        return unescaped ? NULL : PyErr_NoMemory();
+    }
+    job->length = parser->input_length;
+    job->native = native;
+    job->as_bytes = as_bytes;
+    job->finished = false;
+    job->result = NULL;
+    job->error_type = job->error_value = job->error_traceback = NULL;
+#ifdef CHOMPJS_STATS
+    job->nanoseconds = 0;
+#endif
+    return (PyObject* )job;
+}
+
+static void parse_job_dealloc(ParseJobState* job) {
+    PyTypeObject* type = Py_TYPE(job);
+    if(job->reusable != NULL) {
+        release_to_pool(get_type_state(type), job->reusable);
+    }
+    PyBuffer_Release(&job->input);
+    Py_XDECREF(job->result);
+    Py_XDECREF(job->error_type);
+    Py_XDECREF(job->error_value);
+    Py_XDECREF(job->error_traceback);
+    type->tp_free(job);
+    Py_DECREF(type);
+}
+
+/** Keep the outcome of parsing that is over, release the parser and the input */
+static void finish_parse_job(ParseJobState* job) {
+    ModuleState* module_state = get_type_state(Py_TYPE(job));
+    struct Parser* parser = &job->reusable->parser;
+    PyObject* ret = NULL;
+    if(parser->parser_status == FINISHED) {
+        if(job->native) {
+            ret = builder_result(&job->reusable->builder);
+        } else {
+            ret = output_text(parser->output.data, parser->output.index-1, job->as_bytes);
+        }
+    }
+    if(ret == NULL && !PyErr_Occurred()) {
+        set_parser_error(module_state, parser);
+    }
+    if(ret == NULL) {
+        PyErr_Fetch(&job->error_type, &job->error_value, &job->error_traceback);
+    }
+    job->result = ret;
+#ifdef CHOMPJS_STATS
+    record_parser_call(module_state, parser, job->length, job->nanoseconds);
+#endif
+    release_to_pool(module_state, job->reusable);
+    job->reusable = NULL;
+    PyBuffer_Release(&job->input);
+    job->finished = true;
+}
+
+/**
+    Run the parser over at most about `max_bytes` of the input, or for about
+    `max_seconds`, see `advance_until` and `advance_until_deadline`
+*/
+static PyObject* parse_job_advance(ParseJobState* job, PyObject *args, PyObject *kwargs) {
+    static char* kwlist[] = {"max_bytes", "max_seconds", NULL};
+    size_t max_bytes = SIZE_MAX;
+    PyObject* max_seconds = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "|O&O", kwlist, convert_limit, &max_bytes, &max_seconds)) {
+        return NULL;
+    }
+    bool timed = max_seconds != Py_None;
+    uint64_t deadline = 0;
+    if(timed) {
+        double seconds = PyFloat_AsDouble(max_seconds);
+        if(seconds == -1.0 && PyErr_Occurred()) {
+            return NULL;
+        }
+        uint64_t now = monotonic_ns();
+        deadline = seconds > 0 ? now + (uint64_t)(seconds < 1e9 ? seconds * 1e9 : 1e18) : now;
+    }
+    if(!enter_object((PyObject*)job, &job->busy)) {
+        return NULL;
+    }
+    if(!job->finished) {
+        struct Parser* parser = &job->reusable->parser;
+        // every call moves forward, even with no budget at all
+        size_t stop = parser->input_position + (max_bytes > 0 ? max_bytes : 1);
+        if(stop < max_bytes) {
+            stop = SIZE_MAX;
+        }
+#ifdef CHOMPJS_STATS
+        uint64_t started = monotonic_ns();
+#endif
+        if(job->native) {
+            if(timed) {
+                advance_until_deadline(parser, stop, deadline);
+            } else {
+                advance_until(parser, stop);
+            }
+        } else {
+            Py_BEGIN_ALLOW_THREADS
+            if(timed) {
+                advance_until_deadline(parser, stop, deadline);
+            } else {
+                advance_until(parser, stop);
+            }
+            Py_END_ALLOW_THREADS
+        }
+#ifdef CHOMPJS_STATS
+        job->nanoseconds += monotonic_ns() - started;
+#endif
+        if(parser->parser_status != CAN_ADVANCE) {
+            finish_parse_job(job);
+        }
+    }
+    bool finished = job->finished;
+    leave_object((PyObject*)job, &job->busy);
+    return PyBool_FromLong(finished);
+}
+
+static PyObject* parse_job_result(ParseJobState* job, PyObject *Py_UNUSED(ignored)) {
+    if(!job->finished) {
+        PyErr_SetString(PyExc_ValueError, "Parsing is not finished yet");
+        return NULL;
+    }
+    if(job->result != NULL) {
+        Py_INCREF(job->result);
+        return job->result;
+    }
+    Py_XINCREF(job->error_type);
+    Py_XINCREF(job->error_value);
+    Py_XINCREF(job->error_traceback);
+    PyErr_Restore(job->error_type, job->error_value, job->error_traceback);
+    return NULL;
+}
+
+/** Input bytes handled so far */
+static PyObject* parse_job_get_position(ParseJobState* job, void* closure) {
+    size_t position = job->length;
+    if(!job->finished && job->reusable->parser.input_position < position) {
+        position = job->reusable->parser.input_position;
+    }
+    return PyLong_FromSize_t(position);
+}
+
+static PyMethodDef parse_job_methods[] = {
+    {
+        "advance", (PyCFunction)(void(*)(void))parse_job_advance, METH_VARARGS | METH_KEYWORDS,
+        "Parse at most about max_bytes of the input or for about max_seconds, True once parsing is over"
+    },
+    {
+        "result", (PyCFunction)parse_job_result, METH_NOARGS,
+        "Extracted object, raises the error parsing has failed with"
+    },
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef parse_job_getset[] = {
+    {"position", (getter)parse_job_get_position, NULL, "Input bytes handled so far", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyType_Slot parse_job_slots[] = {
+    {Py_tp_dealloc, parse_job_dealloc},
+    {Py_tp_methods, parse_job_methods},
+    {Py_tp_getset, parse_job_getset},
+    {Py_tp_new, parse_job_new},
+    {0, NULL}
+};
+
+static PyType_Spec parse_job_spec = {
+    "_chompjs.parse_job",
+    sizeof(ParseJobState),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE,
+    parse_job_slots
+};
+
+static PyObject* start_python_parse(PyObject *self, PyObject *args, PyObject *kwargs) {
+    return PyObject_Call((PyObject *)get_module_state(self)->parse_job_type, args, kwargs);
+}
+
+typedef struct {
+    PyObject_HEAD
+    Py_buffer input;
+    struct ReusableParser* reusable;
+    bool native;
+    bool spans;
+    // checks objects found in span mode, the same way they are checked when parsed
+    struct TapeWriter checker;
+    bool as_bytes;
+    // objects are paired with their content hashes
+    bool content_hash;
+    // offsets into str inputs are counted in characters, not in UTF-8 bytes
+    bool count_characters;
+    size_t counted_bytes;
+    size_t counted_characters;
+    // set while a thread is advancing the iterator
+    bool busy;
+#ifdef CHOMPJS_STATS
+    // time spent in the parser so far, whole iteration is recorded as one call
+    uint64_t nanoseconds;
+#endif
+} JsonIterState;
+
+static PyObject* json_iter_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+    static char* kwlist[] = {
+        "string", "native", "unicode_escape", "spans", "cache_values", "as_bytes", "content_hash",
+        LIMIT_KEYWORDS, NULL
+    };
+    PyObject* string;
+    int native = 0;
+    int unicode_escape = 0;
+    int spans = 0;
+    int cache_values = 0;
+    int as_bytes = 0;
+    int content_hash = 0;
+    struct ParserLimits limits = no_limits;
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "O|pppppp" LIMIT_FORMAT, kwlist, &string, &native, &unicode_escape, &spans,
+            &cache_values, &as_bytes, &content_hash, LIMIT_ARGUMENTS(limits))) {
+        return NULL;
+    }
+    if(spans && unicode_escape) {
+        PyErr_SetString(PyExc_ValueError, "spans can't be used together with unicode_escape");
+        return NULL;
+    }
+
+    ModuleState* module_state = get_type_state(type);
+    JsonIterState* json_iter_state = (JsonIterState *)type->tp_alloc(type, 0);
+    if (!json_iter_state) {
+        return NULL;
+    }
+    // input is kept alive and unchanged for the whole iteration
+    if(get_input(string, &json_iter_state->input) < 0) {
+        free_partial_object((PyObject*)json_iter_state);
+        return NULL;
+    }
+    if(!check_input_size(module_state, &limits, json_iter_state->input.len)) {
+        PyBuffer_Release(&json_iter_state->input);
+        free_partial_object((PyObject*)json_iter_state);
+        return NULL;
+    }
+    json_iter_state->reusable = acquire_parser(module_state);
+    if(json_iter_state->reusable == NULL) {
+        PyBuffer_Release(&json_iter_state->input);
+        free_partial_object((PyObject*)json_iter_state);
+        return NULL;
+    }
+    prepare_parser(
+        json_iter_state->reusable, json_iter_state->input.buf, json_iter_state->input.len,
+        native, false
+    );
+    json_iter_state->reusable->parser.limits = limits;
+    json_iter_state->reusable->builder.cache_values = cache_values;
+    bool unescaped = true;
+    if(unicode_escape) {
+        Py_BEGIN_ALLOW_THREADS
+        unescaped = unescape_input(&json_iter_state->reusable->parser);
+        Py_END_ALLOW_THREADS
+    }
+    if(!unescaped) {
+        release_to_pool(module_state, json_iter_state->reusable);
+        PyBuffer_Release(&json_iter_state->input);
+        free_partial_object((PyObject*)json_iter_state);
+        return PyErr_NoMemory();
+    }
+    json_iter_state->native = native;
+    json_iter_state->spans = spans;
+    json_iter_state->as_bytes = as_bytes;
+    json_iter_state->content_hash = content_hash;
+#ifdef CHOMPJS_STATS
+    json_iter_state->nanoseconds = 0;
+#endif
+    if(spans) {
+        // only positions of objects are needed, nothing is kept in output buffer
+        init_tape_checker(&json_iter_state->checker, &json_iter_state->reusable->parser);
+        json_iter_state->count_characters = PyUnicode_Check(string) && !PyUnicode_IS_ASCII(string);
+        json_iter_state->counted_bytes = 0;
+        json_iter_state->counted_characters = 0;
+    }
+    if(content_hash) {
+        attach_content_hasher(&json_iter_state->reusable->hasher, &json_iter_state->reusable->parser);
+    }
+
+    return (PyObject* )json_iter_state;
+}
+
+static void json_iter_dealloc(JsonIterState* json_iter_state) {
+    PyTypeObject* type = Py_TYPE(json_iter_state);
+    ModuleState* module_state = get_type_state(type);
+#ifdef CHOMPJS_STATS
+    record_parser_call(
+        module_state, &json_iter_state->reusable->parser, json_iter_state->input.len,
+        json_iter_state->nanoseconds
+    );
+#endif
+    release_to_pool(module_state, json_iter_state->reusable);
+    if(json_iter_state->spans) {
+        release_tape_writer(&json_iter_state->checker);
+    }
+    PyBuffer_Release(&json_iter_state->input);
+    type->tp_free(json_iter_state);
+    Py_DECREF(type);
+}
+
+/** Drop output of the object that was just handled, move on to the next one */
+static void reset_iter_object(JsonIterState* json_iter_state) {
+    reset_parser_output(&json_iter_state->reusable->parser);
+    // hash of the last complete object is kept until it's taken
+    reset_content_hasher(&json_iter_state->reusable->hasher);
+    if(json_iter_state->spans) {
+        reset_tape_checker(&json_iter_state->checker);
+    }
+}
+
+static PyObject* json_iter_next_native(JsonIterState* json_iter_state) {
+    struct Parser* parser = &json_iter_state->reusable->parser;
+    struct Builder* builder = &json_iter_state->reusable->builder;
+    for(;;) {
+        while(parser->parser_status == CAN_ADVANCE) {
+            advance(parser);
+        }
+        if(is_fatal_failure(parser)) {
+            set_parser_error(get_type_state(Py_TYPE(json_iter_state)), parser);
+            reset_builder(builder);
+            reset_iter_object(json_iter_state);
+            return NULL;
+        }
+        if(parser->output.index == 1) {
+            return NULL;
+        }
+
+        PyObject* ret = NULL;
+        if(parser->parser_status == FINISHED) {
+            ret = builder_result(builder);
+        }
+        reset_builder(builder);
+        reset_iter_object(json_iter_state);
+        if(ret != NULL) {
+            return ret;
+        }
+        // invalid objects are skipped, same as loader errors
+        if(PyErr_Occurred()) {
+            if(!PyErr_ExceptionMatches(PyExc_ValueError)) {
+                return NULL;
+            }
+            PyErr_Clear();
+        }
+    }
+}
+
+/** Convert byte offset into the input to an offset of str characters, offsets never decrease */
+static size_t character_offset(JsonIterState* json_iter_state, size_t offset) {
+    if(!json_iter_state->count_characters) {
+        return offset;
+    }
+    const unsigned char* data = json_iter_state->input.buf;
+    for(size_t i = json_iter_state->counted_bytes; i < offset; ++i) {
+        // skip UTF-8 continuation bytes
+        if((data[i] & 0xC0) != 0x80) {
+            json_iter_state->counted_characters += 1;
+        }
+    }
+    json_iter_state->counted_bytes = offset;
+    return json_iter_state->counted_characters;
+}
+
+static PyObject* json_iter_next_span(JsonIterState* json_iter_state) {
+    struct Parser* parser = &json_iter_state->reusable->parser;
+    for(;;) {
+        Py_BEGIN_ALLOW_THREADS
+        while(parser->parser_status == CAN_ADVANCE) {
+            advance(parser);
+        }
+        Py_END_ALLOW_THREADS
+        if(is_fatal_failure(parser)) {
+            set_parser_error(get_type_state(Py_TYPE(json_iter_state)), parser);
+            reset_iter_object(json_iter_state);
+            return NULL;
+        }
+        if(json_iter_state->checker.out_of_memory) {
+            reset_iter_object(json_iter_state);
+            return PyErr_NoMemory();
+        }
+        if(parser->output.index == 1) {
+            return NULL;
+        }
+
+        bool finished = parser->parser_status == FINISHED && !json_iter_state->checker.failed;
+        size_t start = parser->object_start;
+        // end state moves past the closing bracket as well
+        size_t end = parser->input_position - 1;
+        bool rewritten = parser->rewritten;
+        reset_iter_object(json_iter_state);
+        // invalid objects are skipped, same as with other modes
+        if(finished) {
+            start = character_offset(json_iter_state, start);
+            end = character_offset(json_iter_state, end);
+            if(json_iter_state->content_hash) {
+                return Py_BuildValue(
+                    "nnOK", start, end, rewritten ? Py_True : Py_False,
+                    (unsigned long long)json_iter_state->reusable->hasher.result
+                );
+            }
+            return Py_BuildValue("nnO", start, end, rewritten ? Py_True : Py_False);
+        }
+    }
+}
+
+static PyObject* json_iter_next_object(JsonIterState* json_iter_state) {
+    if(json_iter_state->spans) {
+        return json_iter_next_span(json_iter_state);
+    }
+    if(json_iter_state->native) {
+        return json_iter_next_native(json_iter_state);
+    }
+
+    struct Parser* parser = &json_iter_state->reusable->parser;
+    for(;;) {
+        Py_BEGIN_ALLOW_THREADS
+        while(parser->parser_status == CAN_ADVANCE) {
+            advance(parser);
+        }
+        Py_END_ALLOW_THREADS
+
+        if(is_fatal_failure(parser)) {
+            set_parser_error(get_type_state(Py_TYPE(json_iter_state)), parser);
+            reset_iter_object(json_iter_state);
+            return NULL;
+        }
+        if(parser->output.index == 1) {
+            return NULL;
+        }
+        // objects the parser failed on are skipped instead of failing in the loader
+        if(parser->parser_status == FINISHED) {
+            PyObject* ret = output_text(
+                parser->output.data, parser->output.index-1, json_iter_state->as_bytes
+            );
+            reset_iter_object(json_iter_state);
+            return ret;
+        }
+        reset_iter_object(json_iter_state);
+    }
+}
+
+static PyObject* json_iter_next(JsonIterState* json_iter_state) {
+    if(!enter_object((PyObject*)json_iter_state, &json_iter_state->busy)) {
+        return NULL;
+    }
+#ifdef CHOMPJS_STATS
+    uint64_t started = monotonic_ns();
+    PyObject* ret = json_iter_next_object(json_iter_state);
+    json_iter_state->nanoseconds += monotonic_ns() - started;
+#else
+    PyObject* ret = json_iter_next_object(json_iter_state);
+#endif
+    if(json_iter_state->content_hash && !json_iter_state->spans) {
+        ret = with_content_hash(ret, &json_iter_state->reusable->hasher);
+    }
+    leave_object((PyObject*)json_iter_state, &json_iter_state->busy);
+    return ret;
+}
+
+/** Input bytes handled so far, everything before it is no longer needed */
+static PyObject* json_iter_get_position(JsonIterState* json_iter_state, void* closure) {
+    size_t position = json_iter_state->reusable->parser.input_position;
+    if(position > (size_t)json_iter_state->input.len) {
+        position = json_iter_state->input.len;
+    }
+    return PyLong_FromSize_t(position);
+}
+
+static PyGetSetDef json_iter_getset[] = {
+    {"position", (getter)json_iter_get_position, NULL, "Input bytes handled so far", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyType_Slot json_iter_slots[] = {
+    {Py_tp_dealloc, json_iter_dealloc},
+    {Py_tp_iter, PyObject_SelfIter},
+    {Py_tp_iternext, json_iter_next},
+    {Py_tp_getset, json_iter_getset},
+    {Py_tp_new, json_iter_new},
+    {0, NULL}
+};
+
+static PyType_Spec json_iter_spec = {
+    "_chompjs.json_iter",
+    sizeof(JsonIterState),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE,
+    json_iter_slots
+};
+
+static PyObject* parse_python_objects(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *obj = PyObject_Call((PyObject *)get_module_state(self)->json_iter_type, args, kwargs);
+    return obj;
+}
+
+/**
+    Objects assigned to names inside of scripts of HTML document. A single
+    parser is moved from one assigned value to another
+*/
+typedef struct {
+    PyObject_HEAD
+    Py_buffer input;
+    struct ScriptScanner scanner;
+    struct ReusableParser* reusable;
+    struct CharBuffer decoded;
+    bool native;
+    bool as_bytes;
+    bool busy;
+} AssignmentIterState;
+
+static PyObject* assignment_iter_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+    static char* kwlist[] = {"string", "native", "as_bytes", LIMIT_KEYWORDS, NULL};
+    PyObject* string;
+    int native = 0;
+    int as_bytes = 0;
+    struct ParserLimits limits = no_limits;
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "O|pp" LIMIT_FORMAT, kwlist, &string, &native, &as_bytes,
+            LIMIT_ARGUMENTS(limits))) {
+        return NULL;
+    }
+
+    ModuleState* module_state = get_type_state(type);
+    AssignmentIterState* state = (AssignmentIterState *)type->tp_alloc(type, 0);
+    if (!state) {
+        return NULL;
+    }
+    if(get_input(string, &state->input) < 0) {
+        free_partial_object((PyObject*)state);
+        return NULL;
+    }
+    if(!check_input_size(module_state, &limits, state->input.len)) {
+        PyBuffer_Release(&state->input);
+        free_partial_object((PyObject*)state);
+        return NULL;
+    }
+    state->reusable = acquire_parser(module_state);
+    if(state->reusable == NULL) {
+        PyBuffer_Release(&state->input);
+        free_partial_object((PyObject*)state);
+        return NULL;
+    }
+    prepare_parser(state->reusable, state->input.buf, 0, native, false);
+    // output and depth limits apply to every assigned value
+    state->reusable->parser.limits = limits;
+    init_script_scanner(&state->scanner, state->input.buf, state->input.len);
+    init_char_buffer(&state->decoded, 1);
+    state->native = native;
+    state->as_bytes = as_bytes;
+    return (PyObject* )state;
+}
+
+static void assignment_iter_dealloc(AssignmentIterState* state) {
+    PyTypeObject* type = Py_TYPE(state);
+    release_to_pool(get_type_state(type), state->reusable);
+    release_char_buffer(&state->decoded);
+    PyBuffer_Release(&state->input);
+    type->tp_free(state);
+    Py_DECREF(type);
+}
+
+/** Run parser over next assigned value, false if there are no more of them */
+static bool parse_next_assignment(AssignmentIterState* state, struct Assignment* found) {
+    struct Parser* parser = &state->reusable->parser;
+    if(!next_assignment(&state->scanner, found)) {
+        return false;
+    }
+    if(found->kind == JSON_PARSE_ASSIGNMENT) {
+        clear(&state->decoded);
+        if(!check_capacity(&state->decoded, found->value_length)) {
+            parser->parser_status = ERROR;
+            parser->failure = OUT_OF_MEMORY;
+            return true;
+        }
+        size_t length = decode_escapes(found->value, found->value_length, state->decoded.data);
+        reset_parser_input(parser, state->decoded.data, length);
+    } else {
+        reset_parser_input(parser, found->value, found->value_length);
+    }
+    while(parser->parser_status == CAN_ADVANCE) {
+        advance(parser);
+    }
+    if(parser->parser_status == FINISHED && found->kind == OBJECT_ASSIGNMENT) {
+        skip_assignment(&state->scanner, found->value + parser->input_position);
+    }
+    return true;
+}
+
+static PyObject* assignment_iter_next_object(AssignmentIterState* state) {
+    struct Parser* parser = &state->reusable->parser;
+    struct Assignment found;
+    for(;;) {
+        bool has_next;
+        if(state->native) {
+            has_next = parse_next_assignment(state, &found);
+        } else {
+            Py_BEGIN_ALLOW_THREADS
+            has_next = parse_next_assignment(state, &found);
+            Py_END_ALLOW_THREADS
+        }
+        if(!has_next) {
+            return NULL;
+        }
+        if(is_fatal_failure(parser)) {
+            set_parser_error(get_type_state(Py_TYPE(state)), parser);
+            if(state->native) {
+                reset_builder(&state->reusable->builder);
+            }
+            return NULL;
+        }
+
+        PyObject* value = NULL;
+        if(parser->parser_status == FINISHED && parser->output.index > 1) {
+            if(state->native) {
+                value = builder_result(&state->reusable->builder);
+            } else {
+                value = output_text(parser->output.data, parser->output.index-1, state->as_bytes);
+            }
+        }
+        if(state->native) {
+            reset_builder(&state->reusable->builder);
+        }
+        if(value == NULL) {
+            // invalid objects are skipped, same as in parse_objects
+            if(PyErr_Occurred()) {
+                if(!PyErr_ExceptionMatches(PyExc_ValueError)) {
+                    return NULL;
+                }
+                PyErr_Clear();
+            }
+            continue;
+        }
+
+        PyObject* name = Py_None;
+        Py_INCREF(name);
+        if(found.name != NULL) {
+            Py_DECREF(name);
+            name = PyUnicode_DecodeUTF8(found.name, found.name_length, "replace");
+            if(name == NULL) {
+                Py_DECREF(value);
+                return NULL;
+            }
+        }
+        return Py_BuildValue("(NN)", name, value);
+    }
+}
+
+static PyObject* assignment_iter_next(AssignmentIterState* state) {
+    if(!enter_object((PyObject*)state, &state->busy)) {
         return NULL;
     }
+    PyObject* ret = assignment_iter_next_object(state);
+    leave_object((PyObject*)state, &state->busy);
+    return ret;
+}
 
-    struct Parser parser;
-    init_parser(&parser, string);
-    Py_BEGIN_ALLOW_THREADS 
-    while(parser.parser_status == CAN_ADVANCE) {
-        advance(&parser);
+static PyType_Slot assignment_iter_slots[] = {
+    {Py_tp_dealloc, assignment_iter_dealloc},
+    {Py_tp_iter, PyObject_SelfIter},
+    {Py_tp_iternext, assignment_iter_next},
+    {Py_tp_new, assignment_iter_new},
+    {0, NULL}
+};
+
+static PyType_Spec assignment_iter_spec = {
+    "_chompjs.assignment_iter",
+    sizeof(AssignmentIterState),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE,
+    assignment_iter_slots
+};
+
+static PyObject* parse_python_assignments(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *obj = PyObject_Call((PyObject *)get_module_state(self)->assignment_iter_type, args, kwargs);
+    return obj;
+}
+
+/**
+    Elements of a single array, or members of a single object, parsed one
+    at a time. Scanner walks over the container, parser is moved from one
+    element to another, so only the current element is kept in memory
+*/
+typedef struct {
+    PyObject_HEAD
+    Py_buffer input;
+    struct ItemScanner scanner;
+    struct ReusableParser* reusable;
+    bool native;
+    bool as_bytes;
+    bool busy;
+} ItemIterState;
+
+static PyObject* item_iter_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+    static char* kwlist[] = {
+        "string", "native", "unicode_escape", "path", "as_bytes", LIMIT_KEYWORDS, NULL
+    };
+    PyObject* string;
+    int native = 0;
+    int unicode_escape = 0;
+    const char* path_string = NULL;
+    Py_ssize_t path_length = 0;
+    int as_bytes = 0;
+    struct ParserLimits limits = no_limits;
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "O|ppz#p" LIMIT_FORMAT, kwlist, &string, &native, &unicode_escape,
+            &path_string, &path_length, &as_bytes, LIMIT_ARGUMENTS(limits))) {
+        return NULL;
     }
-    Py_END_ALLOW_THREADS
 
-    PyObject* ret = Py_BuildValue("s#", parser.output.data, parser.output.index-1);
-    release_parser(&parser);
-    if(parser.parser_status == ERROR) {
-        const char* msg_sting = "Error parsing input near character %d";
-        size_t error_buffer_size = snprintf(
-            NULL,
-            0,
-            msg_sting,
-            parser.input_position
-        );       
-        char* error_buffer = malloc(error_buffer_size + 1);
-        sprintf(
-            error_buffer,
-            msg_sting,
-            parser.input_position - 1
-        );
-        PyErr_SetString(PyExc_ValueError, error_buffer);
-        free(error_buffer);
+    ModuleState* module_state = get_type_state(type);
+    ItemIterState* state = (ItemIterState *)type->tp_alloc(type, 0);
+    if (!state) {
+        return NULL;
+    }
+    if(get_input(string, &state->input) < 0) {
+        free_partial_object((PyObject*)state);
+        return NULL;
+    }
+    if(!check_input_size(module_state, &limits, state->input.len)) {
+        PyBuffer_Release(&state->input);
+        free_partial_object((PyObject*)state);
+        return NULL;
+    }
+    state->reusable = acquire_parser(module_state);
+    if(state->reusable == NULL) {
+        PyBuffer_Release(&state->input);
+        free_partial_object((PyObject*)state);
+        return NULL;
+    }
+    struct Parser* parser = &state->reusable->parser;
+    prepare_parser(state->reusable, state->input.buf, state->input.len, native, true);
+    parser->limits = limits;
+    bool unescaped = true;
+    if(unicode_escape) {
+        Py_BEGIN_ALLOW_THREADS
+        unescaped = unescape_input(parser);
+        Py_END_ALLOW_THREADS
+    }
+    if(!unescaped) {
+        release_to_pool(module_state, state->reusable);
+        PyBuffer_Release(&state->input);
+        free_partial_object((PyObject*)state);
+        return PyErr_NoMemory();
+    }
+    state->native = native;
+    state->as_bytes = as_bytes;
+
+    // decoded input stays in the parser while it's moved between elements
+    const char* data = parser->input;
+    size_t length = parser->input_length;
+    size_t position;
+    bool found;
+    if(path_string != NULL) {
+        struct Path path;
+        if(!parse_path(&path, path_string, path_length)) {
+            PyErr_Format(PyExc_ValueError, "Invalid path: %s", path_string);
+            Py_DECREF(state);
+            return NULL;
+        }
+        size_t root;
+        Py_BEGIN_ALLOW_THREADS
+        found = find_object(parser, &root) && locate_path(&path, data, length, root, &position);
+        Py_END_ALLOW_THREADS
+        release_path(&path);
+        if(!found) {
+            PyErr_Format(PyExc_ValueError, "Path not found: %s", path_string);
+            Py_DECREF(state);
+            return NULL;
+        }
+    } else {
+        found = find_object(parser, &position);
+    }
+    if(!found || !init_item_scanner(&state->scanner, data, length, position)) {
+        PyErr_SetString(PyExc_ValueError, "No array or object to iterate over");
+        Py_DECREF(state);
+        return NULL;
+    }
+    return (PyObject* )state;
+}
+
+static void item_iter_dealloc(ItemIterState* state) {
+    PyTypeObject* type = Py_TYPE(state);
+    release_to_pool(get_type_state(type), state->reusable);
+    PyBuffer_Release(&state->input);
+    type->tp_free(state);
+    Py_DECREF(type);
+}
+
+/** Run parser over a single key or value starting at `start` */
+static void parse_item(ItemIterState* state, const char* start, bool native, bool is_key) {
+    struct Parser* parser = &state->reusable->parser;
+    reset_parser_input(parser, start, state->scanner.end - start);
+    reset_builder(&state->reusable->builder);
+    if(native) {
+        attach_builder(&state->reusable->builder, parser, true);
+    } else {
+        parser->sink = NULL;
+    }
+    start_at_value(parser, 0);
+    // keys such as `1` or `a b` are quoted instead of being parsed as values
+    if(is_key) {
+        parser->is_key = true;
+    }
+    if(native) {
+        while(parser->parser_status == CAN_ADVANCE) {
+            advance(parser);
+        }
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        while(parser->parser_status == CAN_ADVANCE) {
+            advance(parser);
+        }
+        Py_END_ALLOW_THREADS
+    }
+}
+
+/** Stop the iteration, set exception pointing at given input position */
+static PyObject* fail_item_iter(ItemIterState* state, ParserFailure failure, const char* position) {
+    struct Parser* parser = &state->reusable->parser;
+    state->scanner.finished = true;
+    set_failure_error(
+        get_type_state(Py_TYPE(state)), failure, &parser->limits, position - state->scanner.input
+    );
+    return NULL;
+}
+
+/** Result of the item that was just parsed, exception is set if it's not valid */
+static PyObject* item_result(ItemIterState* state, bool native) {
+    struct Parser* parser = &state->reusable->parser;
+    PyObject* ret = NULL;
+    if(parser->parser_status == FINISHED) {
+        if(native) {
+            ret = builder_result(&state->reusable->builder);
+        } else {
+            ret = output_text(parser->output.data, parser->output.index-1, state->as_bytes);
+        }
+    }
+    reset_builder(&state->reusable->builder);
+    if(ret == NULL && !PyErr_Occurred()) {
+        return fail_item_iter(state, parser->failure, parser->input + parser->input_position - 1);
+    }
+    return ret;
+}
+
+static PyObject* item_iter_next_object(ItemIterState* state) {
+    struct Parser* parser = &state->reusable->parser;
+    const char* start;
+    // iteration is over after the first error
+    if(state->scanner.finished) {
+        return NULL;
+    }
+    if(!next_item(&state->scanner, &start)) {
+        if(state->scanner.failed) {
+            return fail_item_iter(state, INVALID_INPUT, state->scanner.position);
+        }
+        return NULL;
+    }
+
+    PyObject* key = NULL;
+    if(state->scanner.is_object) {
+        // keys are always built natively, loaders only get values
+        parse_item(state, start, true, true);
+        key = item_result(state, true);
+        if(key == NULL) {
+            return NULL;
+        }
+        // end state moves one character past the item
+        if(!skip_key(&state->scanner, parser->input + parser->input_position - 1, &start)) {
+            Py_DECREF(key);
+            return fail_item_iter(state, INVALID_INPUT, state->scanner.position);
+        }
+    }
+
+    parse_item(state, start, state->native, false);
+    PyObject* value = item_result(state, state->native);
+    if(value == NULL) {
+        Py_XDECREF(key);
+        return NULL;
+    }
+    if(!skip_item(&state->scanner, parser->input + parser->input_position - 1)) {
+        Py_XDECREF(key);
+        Py_DECREF(value);
+        return fail_item_iter(state, INVALID_INPUT, state->scanner.position);
+    }
+    if(key != NULL) {
+        return Py_BuildValue("(NN)", key, value);
+    }
+    return value;
+}
+
+static PyObject* item_iter_next(ItemIterState* state) {
+    if(!enter_object((PyObject*)state, &state->busy)) {
         return NULL;
     }
+    PyObject* ret = item_iter_next_object(state);
+    leave_object((PyObject*)state, &state->busy);
     return ret;
 }
 
+/** Input bytes handled so far */
+static PyObject* item_iter_get_position(ItemIterState* state, void* closure) {
+    return PyLong_FromSize_t(state->scanner.position - state->scanner.input);
+}
+
+static PyGetSetDef item_iter_getset[] = {
+    {"position", (getter)item_iter_get_position, NULL, "Input bytes handled so far", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyType_Slot item_iter_slots[] = {
+    {Py_tp_dealloc, item_iter_dealloc},
+    {Py_tp_iter, PyObject_SelfIter},
+    {Py_tp_iternext, item_iter_next},
+    {Py_tp_getset, item_iter_getset},
+    {Py_tp_new, item_iter_new},
+    {0, NULL}
+};
+
+static PyType_Spec item_iter_spec = {
+    "_chompjs.item_iter",
+    sizeof(ItemIterState),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE,
+    item_iter_slots
+};
+
+static PyObject* parse_python_items(PyObject *self, PyObject *args, PyObject *kwargs) {
+    return PyObject_Call((PyObject *)get_module_state(self)->item_iter_type, args, kwargs);
+}
+
+/**
+    Input received in chunks. Data is buffered until the tracker suggests
+    that a complete object might be available, then the parser runs over
+    all unconsumed data. Consumed data is dropped, so memory usage is bound
+    by the largest single object
+*/
 typedef struct {
     PyObject_HEAD
-    struct Parser parser;
-} JsonIterState;
+    struct CharBuffer buffer;
+    size_t start;
+    // last consumed characters, candidate objects are checked against them
+    char preceding[PRECEDING_LENGTH];
+    struct BracketTracker tracker;
+    struct ReusableParser* reusable;
+    struct ParserLimits limits;
+    bool native;
+    bool as_bytes;
+    bool closed;
+    bool busy;
+    bool waiting;
+    size_t groups_at_wait;
+    size_t length_at_wait;
+} StreamState;
 
-static PyObject* json_iter_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
-    JsonIterState* json_iter_state = (JsonIterState *)type->tp_alloc(type, 0);
-    if (!json_iter_state) {
+#define INITIAL_STREAM_BUFFER_SIZE 4096
+
+static PyObject* stream_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+    static char* kwlist[] = {"native", "as_bytes", LIMIT_KEYWORDS, NULL};
+    int native = 0;
+    int as_bytes = 0;
+    struct ParserLimits limits = no_limits;
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "|pp" LIMIT_FORMAT, kwlist, &native, &as_bytes, LIMIT_ARGUMENTS(limits))) {
         return NULL;
     }
 
-    const char* string;
-    if (!PyArg_ParseTuple(args, "s", &string)) {
+    StreamState* stream = (StreamState *)type->tp_alloc(type, 0);
+    if (!stream) {
+        return NULL;
+    }
+    stream->reusable = acquire_parser(get_type_state(type));
+    if(stream->reusable == NULL) {
+        free_partial_object((PyObject*)stream);
         return NULL;
     }
-    init_parser(&json_iter_state->parser, string);
+    init_char_buffer(&stream->buffer, INITIAL_STREAM_BUFFER_SIZE);
+    init_bracket_tracker(&stream->tracker);
+    stream->limits = limits;
+    stream->native = native;
+    stream->as_bytes = as_bytes;
+    return (PyObject* )stream;
+}
 
-    return (PyObject* )json_iter_state;
+static void stream_dealloc(StreamState* stream) {
+    PyTypeObject* type = Py_TYPE(stream);
+    release_to_pool(get_type_state(type), stream->reusable);
+    release_char_buffer(&stream->buffer);
+    type->tp_free(stream);
+    Py_DECREF(type);
 }
 
-static void json_iter_dealloc(JsonIterState* json_iter_state) {
-    release_parser(&json_iter_state->parser);
-    Py_TYPE(json_iter_state)->tp_free(json_iter_state);
+static PyObject* stream_feed_data(StreamState* stream, PyObject* data) {
+    if(stream->closed) {
+        PyErr_SetString(PyExc_ValueError, "feed() called after close()");
+        return NULL;
+    }
+    Py_buffer input;
+    if(get_input(data, &input) < 0) {
+        return NULL;
+    }
+    // drop consumed data before growing the buffer
+    if(stream->start > 0 && stream->start >= stream->buffer.index / 2) {
+        size_t remaining = stream->buffer.index - stream->start;
+        memmove(stream->buffer.data, stream->buffer.data + stream->start, remaining);
+        stream->buffer.index = remaining;
+        stream->start = 0;
+    }
+    // with max_input_bytes only data that is still needed is limited
+    size_t remaining = stream->buffer.index - stream->start;
+    if(!check_input_size(get_type_state(Py_TYPE(stream)), &stream->limits, remaining + input.len)) {
+        PyBuffer_Release(&input);
+        return NULL;
+    }
+    if(!push_string(&stream->buffer, input.buf, input.len)) {
+        PyBuffer_Release(&input);
+        return PyErr_NoMemory();
+    }
+    track_brackets(&stream->tracker, input.buf, input.len);
+    PyBuffer_Release(&input);
+    Py_RETURN_NONE;
 }
 
-static PyObject* json_iter_next(JsonIterState* json_iter_state) {
-    Py_BEGIN_ALLOW_THREADS
-    while(json_iter_state->parser.parser_status == CAN_ADVANCE) {
-        advance(&json_iter_state->parser);
+/** Buffer is moved by both feeding and iteration, they can't overlap */
+static PyObject* stream_feed(StreamState* stream, PyObject* data) {
+    if(!enter_object((PyObject*)stream, &stream->busy)) {
+        return NULL;
+    }
+    PyObject* ret = stream_feed_data(stream, data);
+    leave_object((PyObject*)stream, &stream->busy);
+    return ret;
+}
+
+static PyObject* stream_close(StreamState* stream, PyObject* Py_UNUSED(ignored)) {
+    if(!enter_object((PyObject*)stream, &stream->busy)) {
+        return NULL;
+    }
+    stream->closed = true;
+    leave_object((PyObject*)stream, &stream->busy);
+    Py_RETURN_NONE;
+}
+
+static PyObject* stream_next_object(StreamState* stream) {
+    for(;;) {
+        const char* data = stream->buffer.data + stream->start;
+        size_t length = stream->buffer.index - stream->start;
+        if(length == 0) {
+            return NULL;
+        }
+        // another attempt can only succeed once more brackets are closed,
+        // data doubling bounds the cost if the tracker guessed wrong
+        if(stream->waiting && !stream->closed
+                && stream->tracker.groups == stream->groups_at_wait
+                && length < 2 * stream->length_at_wait) {
+            return NULL;
+        }
+
+        struct Parser* parser = &stream->reusable->parser;
+        prepare_parser(stream->reusable, data, length, stream->native, false);
+        parser->limits = stream->limits;
+        memcpy(parser->preceding, stream->preceding, PRECEDING_LENGTH);
+        if(stream->native) {
+            while(parser->parser_status == CAN_ADVANCE) {
+                advance(parser);
+            }
+        } else {
+            Py_BEGIN_ALLOW_THREADS
+            while(parser->parser_status == CAN_ADVANCE) {
+                advance(parser);
+            }
+            Py_END_ALLOW_THREADS
+        }
+        // without more data it's not known if the object is an object at all
+        bool undecided = parser->candidate_cut && !stream->closed;
+        // object is dropped, so that iteration can go on past it
+        if(is_fatal_failure(parser) && !undecided) {
+            size_t consumed = parser->input_position - 1 < length ? parser->input_position - 1 : length;
+            set_parser_error(get_type_state(Py_TYPE(stream)), parser);
+            reset_builder(&stream->reusable->builder);
+            stream->start += consumed;
+            append_preceding(stream->preceding, data, consumed);
+            stream->waiting = false;
+            return NULL;
+        }
+
+        bool found = parser->output.index > 1;
+        // error caused by the end of data means that the object is not complete yet
+        bool incomplete = undecided
+            || (parser->parser_status == ERROR && parser->input_position > length);
+        size_t consumed = parser->input_position - 1;
+        PyObject* ret = NULL;
+        if(!found) {
+            consumed = length;
+            // don't lose beginning of a comment, it could hide an object
+            if(!stream->closed) {
+                consumed = unfinished_comment(data, length);
+            }
+        } else if(incomplete) {
+            consumed = stream->closed ? length : 0;
+        } else if(parser->parser_status == FINISHED) {
+            if(stream->native) {
+                ret = builder_result(&stream->reusable->builder);
+            } else {
+                ret = output_text(parser->output.data, parser->output.index-1, stream->as_bytes);
+            }
+        }
+
+        reset_builder(&stream->reusable->builder);
+        stream->start += consumed;
+        append_preceding(stream->preceding, data, consumed);
+        stream->waiting = consumed == 0 || !found;
+        stream->groups_at_wait = stream->tracker.groups;
+        stream->length_at_wait = length - consumed;
+
+        if(ret != NULL) {
+            return ret;
+        }
+        // invalid objects are skipped, same as in parse_objects
+        if(PyErr_Occurred()) {
+            if(!PyErr_ExceptionMatches(PyExc_ValueError)) {
+                return NULL;
+            }
+            PyErr_Clear();
+        }
+        if(stream->waiting) {
+            return NULL;
+        }
+    }
+}
+
+static PyObject* stream_next(StreamState* stream) {
+    if(!enter_object((PyObject*)stream, &stream->busy)) {
+        return NULL;
+    }
+    PyObject* ret = stream_next_object(stream);
+    leave_object((PyObject*)stream, &stream->busy);
+    return ret;
+}
+
+static PyMethodDef stream_methods[] = {
+    {"feed", (PyCFunction)stream_feed, METH_O, "Add next chunk of input"},
+    {"close", (PyCFunction)stream_close, METH_NOARGS, "Mark the end of input"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyType_Slot stream_slots[] = {
+    {Py_tp_dealloc, stream_dealloc},
+    {Py_tp_iter, PyObject_SelfIter},
+    {Py_tp_iternext, stream_next},
+    {Py_tp_methods, stream_methods},
+    {Py_tp_new, stream_new},
+    {0, NULL}
+};
+
+static PyType_Spec stream_spec = {
+    "_chompjs.stream",
+    sizeof(StreamState),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE,
+    stream_slots
+};
+
+static PyObject* parse_python_stream(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *obj = PyObject_Call((PyObject *)get_module_state(self)->stream_type, args, kwargs);
+    return obj;
+}
+
+/** Single input of parse_batch, parsed in a worker thread */
+struct BatchItem {
+    Py_buffer input;
+    struct Parser parser;
+    struct TokenRecorder recorder;
+#ifdef CHOMPJS_STATS
+    uint64_t nanoseconds;
+#endif
+};
+
+struct Batch {
+    ModuleState* module_state;
+    struct BatchItem* items;
+    size_t count;
+    bool native;
+    bool unicode_escape;
+    bool as_bytes;
+    struct ParserLimits limits;
+    // shared by all items, so that their keys are reused
+    struct Builder builder;
+};
+
+static void parse_batch_item(void* context, size_t index) {
+    struct Batch* batch = context;
+    struct BatchItem* item = &batch->items[index];
+#ifdef CHOMPJS_STATS
+    uint64_t started = monotonic_ns();
+#endif
+    init_parser(&item->parser, item->input.buf, item->input.len);
+    item->parser.limits = batch->limits;
+    // result is an exception, see batch_item_result
+    if((size_t)item->input.len > batch->limits.max_input_bytes) {
+        return;
+    }
+    // failure is kept in the parser, nothing is parsed and batch_item_result reports MemoryError
+    if(batch->unicode_escape) {
+        unescape_input(&item->parser);
+    }
+    // Python objects can't be created without GIL, tokens are replayed later
+    if(batch->native) {
+        init_token_recorder(&item->recorder, &item->parser);
+    }
+    while(item->parser.parser_status == CAN_ADVANCE) {
+        advance(&item->parser);
+    }
+#ifdef CHOMPJS_STATS
+    item->nanoseconds = monotonic_ns() - started;
+#endif
+}
+
+/** Take currently set exception, so it can be returned as a result */
+static PyObject* take_exception(void) {
+    if(!PyErr_ExceptionMatches(PyExc_ValueError)) {
+        return NULL;
+    }
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    PyErr_NormalizeException(&type, &value, &traceback);
+    Py_XDECREF(type);
+    Py_XDECREF(traceback);
+    return value;
+}
+
+static PyObject* batch_item_result(struct Batch* batch, struct BatchItem* item) {
+    struct Parser* parser = &item->parser;
+    PyObject* ret = NULL;
+    if(!check_input_size(batch->module_state, &batch->limits, item->input.len)) {
+        return take_exception();
+    }
+    if(batch->native) {
+        struct Builder* builder = &batch->builder;
+        attach_builder(builder, parser, true);
+        if(parser->parser_status == FINISHED && replay_tokens(&item->recorder, &builder->sink)) {
+            ret = builder_result(builder);
+        }
+        reset_builder(builder);
+    } else if(parser->parser_status != ERROR) {
+        ret = output_text(parser->output.data, parser->output.index-1, batch->as_bytes);
+    }
+
+    if(ret == NULL) {
+        if(!PyErr_Occurred()) {
+            set_parser_error(batch->module_state, parser);
+        }
+        ret = take_exception();
+    }
+    return ret;
+}
+
+static void release_batch(struct Batch* batch, size_t parsed) {
+    for(size_t i = 0; i < batch->count; ++i) {
+        if(i < parsed) {
+#ifdef CHOMPJS_STATS
+            record_parser_call(
+                batch->module_state, &batch->items[i].parser, batch->items[i].input.len, batch->items[i].nanoseconds
+            );
+#endif
+            if(batch->native) {
+                release_token_recorder(&batch->items[i].recorder);
+            }
+            release_parser(&batch->items[i].parser);
+        }
+        PyBuffer_Release(&batch->items[i].input);
+    }
+    if(parsed > 0 && batch->native) {
+        release_builder(&batch->builder);
+    }
+    PyMem_Free(batch->items);
+}
+
+static PyObject* parse_python_batch(PyObject *self, PyObject *args, PyObject *kwargs) {
+    static char* kwlist[] = {
+        "strings", "native", "unicode_escape", "workers", "as_bytes", LIMIT_KEYWORDS, NULL
+    };
+    PyObject* strings;
+    int native = 0;
+    int unicode_escape = 0;
+    Py_ssize_t workers = 1;
+    int as_bytes = 0;
+    struct ParserLimits limits = no_limits;
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "O|ppnp" LIMIT_FORMAT, kwlist, &strings, &native, &unicode_escape, &workers,
+            &as_bytes, LIMIT_ARGUMENTS(limits))) {
+        return NULL;
+    }
+    PyObject* sequence = PySequence_Fast(strings, "strings must be iterable");
+    if(sequence == NULL) {
+        return NULL;
     }
+
+    struct Batch batch;
+    batch.module_state = get_module_state(self);
+    batch.count = PySequence_Fast_GET_SIZE(sequence);
+    batch.native = native;
+    batch.unicode_escape = unicode_escape;
+    batch.as_bytes = as_bytes;
+    batch.limits = limits;
+    batch.items = PyMem_Calloc(batch.count ? batch.count : 1, sizeof(struct BatchItem));
+    if(batch.items == NULL) {
+        Py_DECREF(sequence);
+        return PyErr_NoMemory();
+    }
+    for(size_t i = 0; i < batch.count; ++i) {
+        if(get_input(PySequence_Fast_GET_ITEM(sequence, i), &batch.items[i].input) < 0) {
+            batch.count = i;
+            release_batch(&batch, 0);
+            Py_DECREF(sequence);
+            return NULL;
+        }
+    }
+    Py_DECREF(sequence);
+
+    Py_BEGIN_ALLOW_THREADS
+    run_parallel(batch.count, workers > 0 ? workers : 1, parse_batch_item, &batch);
     Py_END_ALLOW_THREADS
 
-    if(json_iter_state->parser.output.index == 1) {
+    if(batch.native && batch.count > 0) {
+        init_builder(&batch.builder, &batch.items[0].parser, true);
+    }
+    PyObject* results = PyList_New(batch.count);
+    for(size_t i = 0; results != NULL && i < batch.count; ++i) {
+        PyObject* result = batch_item_result(&batch, &batch.items[i]);
+        if(result == NULL) {
+            Py_CLEAR(results);
+            break;
+        }
+        PyList_SET_ITEM(results, i, result);
+    }
+    release_batch(&batch, batch.count);
+    return results;
+}
+
+/**
+    Objects of the input parsed by a pool of native threads, in rounds of
+    chunks. Results of a round are converted to Python objects in order
+*/
+typedef struct {
+    PyObject_HEAD
+    Py_buffer input;
+    struct ReusableParser* reusable;
+    struct ChunkedInput chunks;
+    size_t chunk_index;
+    size_t object_index;
+    bool native;
+    bool as_bytes;
+    bool busy;
+} ChunkIterState;
+
+static PyObject* chunk_iter_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+    static char* kwlist[] = {
+        "string", "native", "unicode_escape", "workers", "cache_values", "as_bytes", LIMIT_KEYWORDS,
+        NULL
+    };
+    PyObject* string;
+    int native = 0;
+    int unicode_escape = 0;
+    Py_ssize_t workers = 1;
+    int cache_values = 0;
+    int as_bytes = 0;
+    struct ParserLimits limits = no_limits;
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "O|ppnpp" LIMIT_FORMAT, kwlist, &string, &native, &unicode_escape, &workers,
+            &cache_values, &as_bytes, LIMIT_ARGUMENTS(limits))) {
         return NULL;
     }
-    PyObject* ret = Py_BuildValue(
-        "s#",
-        json_iter_state->parser.output.data,
-        json_iter_state->parser.output.index-1
-    );
-    reset_parser_output(&json_iter_state->parser);
-    return ret;
-}
-
-PyTypeObject JSONIter_Type = {
-    PyVarObject_HEAD_INIT(NULL, 0)
-    "json_iter",                    /* tp_name */
-    sizeof(JsonIterState),          /* tp_basicsize */
-    0,                              /* tp_itemsize */
-    (destructor)json_iter_dealloc,  /* tp_dealloc */
-    0,                              /* tp_print */
-    0,                              /* tp_getattr */
-    0,                              /* tp_setattr */
-    0,                              /* tp_reserved */
-    0,                              /* tp_repr */
-    0,                              /* tp_as_number */
-    0,                              /* tp_as_sequence */
-    0,                              /* tp_as_mapping */
-    0,                              /* tp_hash */
-    0,                              /* tp_call */
-    0,                              /* tp_str */
-    0,                              /* tp_getattro */
-    0,                              /* tp_setattro */
-    0,                              /* tp_as_buffer */
-    Py_TPFLAGS_DEFAULT,             /* tp_flags */
-    0,                              /* tp_doc */
-    0,                              /* tp_traverse */
-    0,                              /* tp_clear */
-    0,                              /* tp_richcompare */
-    0,                              /* tp_weaklistoffset */
-    PyObject_SelfIter,              /* tp_iter */
-    (iternextfunc)json_iter_next,   /* tp_iternext */
-    0,                              /* tp_methods */
-    0,                              /* tp_members */
-    0,                              /* tp_getset */
-    0,                              /* tp_base */
-    0,                              /* tp_dict */
-    0,                              /* tp_descr_get */
-    0,                              /* tp_descr_set */
-    0,                              /* tp_dictoffset */
-    0,                              /* tp_init */
-    PyType_GenericAlloc,            /* tp_alloc */
-    json_iter_new,                  /* tp_new */
-};
-
-static PyObject* parse_python_objects(PyObject *self, PyObject *args) {
-    PyObject *obj = PyObject_CallObject((PyObject *) &JSONIter_Type, args);
+
+    ModuleState* module_state = get_type_state(type);
+    ChunkIterState* state = (ChunkIterState *)type->tp_alloc(type, 0);
+    if (!state) {
+        return NULL;
+    }
+    if(get_input(string, &state->input) < 0) {
+        free_partial_object((PyObject*)state);
+        return NULL;
+    }
+    if(!check_input_size(module_state, &limits, state->input.len)) {
+        PyBuffer_Release(&state->input);
+        free_partial_object((PyObject*)state);
+        return NULL;
+    }
+    // pooled parser provides the builder and the buffer for decoded input
+    state->reusable = acquire_parser(module_state);
+    if(state->reusable == NULL) {
+        PyBuffer_Release(&state->input);
+        free_partial_object((PyObject*)state);
+        return NULL;
+    }
+    struct Parser* parser = &state->reusable->parser;
+    prepare_parser(state->reusable, state->input.buf, state->input.len, native, true);
+    state->reusable->builder.cache_values = cache_values;
+    bool unescaped = true;
+    if(unicode_escape) {
+        Py_BEGIN_ALLOW_THREADS
+        unescaped = unescape_input(parser);
+        Py_END_ALLOW_THREADS
+    }
+    if(!unescaped || !init_chunked_input(
+            &state->chunks, parser->input, parser->input_length, workers > 0 ? workers : 1, native,
+            &limits)) {
+        release_to_pool(module_state, state->reusable);
+        PyBuffer_Release(&state->input);
+        free_partial_object((PyObject*)state);
+        return PyErr_NoMemory();
+    }
+    state->chunk_index = 0;
+    state->object_index = 0;
+    state->native = native;
+    state->as_bytes = as_bytes;
+    return (PyObject* )state;
+}
+
+static void chunk_iter_dealloc(ChunkIterState* state) {
+    PyTypeObject* type = Py_TYPE(state);
+    release_chunked_input(&state->chunks);
+    release_to_pool(get_type_state(type), state->reusable);
+    PyBuffer_Release(&state->input);
+    type->tp_free(state);
+    Py_DECREF(type);
+}
+
+static PyObject* chunk_object_result(ChunkIterState* state, struct Chunk* chunk, struct ChunkObject* object) {
+    if(!state->native) {
+        return output_text(
+            chunk->parser.output.data + object->output_start,
+            object->output_end - object->output_start, state->as_bytes
+        );
+    }
+    struct Builder* builder = &state->reusable->builder;
+    PyObject* ret = NULL;
+    if(replay_token_range(&chunk->recorder, &builder->sink, object->first_token, object->last_token)) {
+        ret = builder_result(builder);
+    }
+    reset_builder(builder);
+    return ret;
+}
+
+static PyObject* chunk_iter_next_object(ChunkIterState* state) {
+    for(;;) {
+        if(state->chunk_index >= state->chunks.count) {
+            bool parsed;
+            Py_BEGIN_ALLOW_THREADS
+            parsed = parse_next_chunks(&state->chunks);
+            Py_END_ALLOW_THREADS
+            if(!parsed) {
+                return NULL;
+            }
+            state->chunk_index = 0;
+            state->object_index = 0;
+            continue;
+        }
+
+        struct Chunk* chunk = &state->chunks.chunks[state->chunk_index];
+        if(state->object_index >= chunk->count) {
+            state->chunk_index += 1;
+            state->object_index = 0;
+            continue;
+        }
+        struct ChunkObject* object = &chunk->objects[state->object_index];
+        state->object_index += 1;
+        // invalid objects are skipped, same as with a single parser
+        if(!object->finished) {
+            if(object->failure != INVALID_INPUT) {
+                size_t position = chunk->data - state->chunks.data + object->failed_at;
+                set_failure_error(
+                    get_type_state(Py_TYPE(state)), object->failure, &chunk->parser.limits, position
+                );
+                return NULL;
+            }
+            continue;
+        }
+        PyObject* ret = chunk_object_result(state, chunk, object);
+        if(ret != NULL) {
+            return ret;
+        }
+        if(!PyErr_Occurred()) {
+            continue;
+        }
+        if(!PyErr_ExceptionMatches(PyExc_ValueError)) {
+            return NULL;
+        }
+        PyErr_Clear();
+    }
+}
+
+static PyObject* chunk_iter_next(ChunkIterState* state) {
+    if(!enter_object((PyObject*)state, &state->busy)) {
+        return NULL;
+    }
+    PyObject* ret = chunk_iter_next_object(state);
+    leave_object((PyObject*)state, &state->busy);
+    return ret;
+}
+
+/** Start of the current round, input before it is no longer needed */
+static PyObject* chunk_iter_get_position(ChunkIterState* state, void* closure) {
+    size_t position = 0;
+    if(state->chunks.count > 0) {
+        position = state->chunks.chunks[0].data - state->chunks.data;
+    }
+    return PyLong_FromSize_t(position);
+}
+
+static PyGetSetDef chunk_iter_getset[] = {
+    {"position", (getter)chunk_iter_get_position, NULL, "Input bytes handled so far", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyType_Slot chunk_iter_slots[] = {
+    {Py_tp_dealloc, chunk_iter_dealloc},
+    {Py_tp_iter, PyObject_SelfIter},
+    {Py_tp_iternext, chunk_iter_next},
+    {Py_tp_getset, chunk_iter_getset},
+    {Py_tp_new, chunk_iter_new},
+    {0, NULL}
+};
+
+static PyType_Spec chunk_iter_spec = {
+    "_chompjs.chunk_iter",
+    sizeof(ChunkIterState),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE,
+    chunk_iter_slots
+};
+
+static PyObject* parse_python_chunks(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *obj = PyObject_Call((PyObject *)get_module_state(self)->chunk_iter_type, args, kwargs);
     return obj;
 }
 
 static PyMethodDef parser_methods[] = { 
     {   
-        "parse", parse_python_object, METH_VARARGS,
-        "Extract JSON object from the string"
+        "parse", (PyCFunction)(void(*)(void))parse_python_object, METH_VARARGS | METH_KEYWORDS,
+        "Extract JSON object from the string. With native=True Python objects are built directly, "
+        "with unicode_escape=True escape sequences of the input are decoded first, "
+        "with path only the selected value is extracted. With cache_values=True equal short "
+        "string values are shared, like keys always are. With as_bytes=True JSON text is "
+        "returned as UTF-8 bytes instead of str. With content_hash=True (object, hash) pair is "
+        "returned, hash doesn't depend on the order of keys. With lazy=True the object is written "
+        "to a compact tape and returned as a read-only proxy, which creates Python objects "
+        "only for values that are accessed"
+    },  
+    {   
+        "parse_objects", (PyCFunction)(void(*)(void))parse_python_objects, METH_VARARGS | METH_KEYWORDS,
+        "Iterate over all JSON objects in the string. With native=True Python objects are built directly, "
+        "with unicode_escape=True escape sequences of the input are decoded first. With spans=True "
+        "(start, end, rewritten) tuples locating objects in the input are returned instead. "
+        "With cache_values=True equal short string values are shared, like keys always are. "
+        "With as_bytes=True JSON text is returned as UTF-8 bytes instead of str. With "
+        "content_hash=True content hash is added to every returned object or span"
+    },  
+    {   
+        "parse_assignments", (PyCFunction)(void(*)(void))parse_python_assignments, METH_VARARGS | METH_KEYWORDS,
+        "Iterate over (name, object) pairs of objects assigned to names inside of scripts "
+        "of HTML document. With native=True Python objects are built directly"
     },  
+    {
+        "parse_items", (PyCFunction)(void(*)(void))parse_python_items, METH_VARARGS | METH_KEYWORDS,
+        "Iterate over elements of the first array of the string, or over (key, value) "
+        "pairs of the first object, parsing them one at a time. With path the container "
+        "is selected by it instead"
+    },
     {   
-        "parse_objects", parse_python_objects, METH_VARARGS,
-        "Iterate over all JSON objects in the string"
+        "create_parser", (PyCFunction)(void(*)(void))create_python_parser, METH_VARARGS | METH_KEYWORDS,
+        "Create parser object keeping its buffers between calls of its parse method"
     },  
+    {
+        "start_parse", (PyCFunction)(void(*)(void))start_python_parse, METH_VARARGS | METH_KEYWORDS,
+        "Create a job extracting JSON object from the string in slices, takes the same "
+        "arguments as parse. Parsing is done by calls of its advance method"
+    },
+    {   
+        "parse_chunks", (PyCFunction)(void(*)(void))parse_python_chunks, METH_VARARGS | METH_KEYWORDS,
+        "Iterate over all JSON objects in the string, same as parse_objects, but split the input "
+        "into chunks parsed by a pool of native threads"
+    },  
+    {   
+        "parse_batch", (PyCFunction)(void(*)(void))parse_python_batch, METH_VARARGS | METH_KEYWORDS,
+        "Extract JSON object from every string of the sequence using a pool of native threads. "
+        "Failed inputs are returned as exception objects"
+    },  
+    {   
+        "parse_stream", (PyCFunction)(void(*)(void))parse_python_stream, METH_VARARGS | METH_KEYWORDS,
+        "Create parser of input received in chunks. Iterating over it yields all JSON objects "
+        "completed so far"
+    },  
+    {
+        "get_stats", (PyCFunction)get_python_stats, METH_NOARGS,
+        "Parser statistics aggregated by input size, None if built without CHOMPJS_STATS"
+    },
+    {
+        "reset_stats", (PyCFunction)reset_python_stats, METH_NOARGS,
+        "Clear parser statistics gathered so far"
+    },
     {NULL, NULL, 0, NULL}
 };
 
+/** Create all types and objects kept in module state */
+static int module_exec(PyObject* module) {
+    ModuleState* module_state = get_module_state(module);
+    struct {
+        PyTypeObject** type;
+        PyType_Spec* spec;
+    } types[] = {
+        {&module_state->parser_type, &parser_object_spec},
+        {&module_state->json_iter_type, &json_iter_spec},
+        {&module_state->assignment_iter_type, &assignment_iter_spec},
+        {&module_state->item_iter_type, &item_iter_spec},
+        {&module_state->stream_type, &stream_spec},
+        {&module_state->chunk_iter_type, &chunk_iter_spec},
+        {&module_state->parse_job_type, &parse_job_spec},
+        {&module_state->lazy_object_type, &lazy_object_spec},
+        {&module_state->lazy_array_type, &lazy_array_spec},
+    };
+    for(size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i) {
+        *types[i].type = (PyTypeObject*)PyType_FromModuleAndSpec(module, types[i].spec, NULL);
+        if(*types[i].type == NULL) {
+            return -1;
+        }
+    }
+#if PY_VERSION_HEX < 0x030A0000
+    module_state->lazy_object_type->tp_new = NULL;
+    module_state->lazy_array_type->tp_new = NULL;
+#endif
+    // proxy types are exposed, so that they can be registered as Mapping and Sequence
+    if(PyModule_AddType(module, module_state->lazy_object_type) < 0
+            || PyModule_AddType(module, module_state->lazy_array_type) < 0) {
+        return -1;
+    }
+    PyObject* abc = PyImport_ImportModule("collections.abc");
+    if(abc == NULL) {
+        return -1;
+    }
+    module_state->keys_view = PyObject_GetAttrString(abc, "KeysView");
+    module_state->values_view = PyObject_GetAttrString(abc, "ValuesView");
+    module_state->items_view = PyObject_GetAttrString(abc, "ItemsView");
+    Py_DECREF(abc);
+    if(module_state->keys_view == NULL || module_state->values_view == NULL || module_state->items_view == NULL) {
+        return -1;
+    }
+    module_state->pool_key = PyUnicode_InternFromString("_chompjs.parser_pool");
+    if(module_state->pool_key == NULL) {
+        return -1;
+    }
+    module_state->limit_exceeded_error = PyErr_NewExceptionWithDoc(
+        "chompjs.LimitExceededError",
+        "Input, output or nesting depth went over the limit given to the parser",
+        PyExc_ValueError, NULL
+    );
+    if(module_state->limit_exceeded_error == NULL) {
+        return -1;
+    }
+    Py_INCREF(module_state->limit_exceeded_error);
+    if(PyModule_AddObject(module, "LimitExceededError", module_state->limit_exceeded_error) < 0) {
+        Py_DECREF(module_state->limit_exceeded_error);
+        return -1;
+    }
+    // parse_chunks and parse_batch start native threads, kernels have to be known before that
+    init_scan_kernels();
+    return 0;
+}
+
+static int module_traverse(PyObject* module, visitproc visit, void* arg) {
+    ModuleState* module_state = get_module_state(module);
+    Py_VISIT(module_state->parser_type);
+    Py_VISIT(module_state->json_iter_type);
+    Py_VISIT(module_state->assignment_iter_type);
+    Py_VISIT(module_state->item_iter_type);
+    Py_VISIT(module_state->stream_type);
+    Py_VISIT(module_state->chunk_iter_type);
+    Py_VISIT(module_state->parse_job_type);
+    Py_VISIT(module_state->lazy_object_type);
+    Py_VISIT(module_state->lazy_array_type);
+    Py_VISIT(module_state->keys_view);
+    Py_VISIT(module_state->values_view);
+    Py_VISIT(module_state->items_view);
+    Py_VISIT(module_state->limit_exceeded_error);
+    return 0;
+}
+
+static int module_clear(PyObject* module) {
+    ModuleState* module_state = get_module_state(module);
+    Py_CLEAR(module_state->parser_type);
+    Py_CLEAR(module_state->json_iter_type);
+    Py_CLEAR(module_state->assignment_iter_type);
+    Py_CLEAR(module_state->item_iter_type);
+    Py_CLEAR(module_state->stream_type);
+    Py_CLEAR(module_state->chunk_iter_type);
+    Py_CLEAR(module_state->parse_job_type);
+    Py_CLEAR(module_state->lazy_object_type);
+    Py_CLEAR(module_state->lazy_array_type);
+    Py_CLEAR(module_state->keys_view);
+    Py_CLEAR(module_state->values_view);
+    Py_CLEAR(module_state->items_view);
+    Py_CLEAR(module_state->limit_exceeded_error);
+    Py_CLEAR(module_state->pool_key);
+    return 0;
+}
+
+static void module_free(void* module) {
+    module_clear(module);
+}
+
+static PyModuleDef_Slot parser_slots[] = {
+    {Py_mod_exec, module_exec},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
 
-static struct PyModuleDef parser_definition = { 
+static struct PyModuleDef parser_definition = {
     PyModuleDef_HEAD_INIT,
     "_chompjs",
     "C extension for fast JavaScript object parsing",
-    -1, 
-    parser_methods
+    sizeof(ModuleState),
+    parser_methods,
+    parser_slots,
+    module_traverse,
+    module_clear,
+    module_free
 };
 
 PyMODINIT_FUNC PyInit__chompjs(void) {
-    Py_Initialize();
-    PyObject* module = PyModule_Create(&parser_definition);
-    if (!module) {
-        return NULL;
-    }
-    if (PyType_Ready(&JSONIter_Type) < 0) {
-        return NULL;
-    }
-#ifdef Py_GIL_DISABLED
-    PyUnstable_Module_SetGIL(module, Py_MOD_GIL_NOT_USED);
-#endif
-    return module;
+    return PyModuleDef_Init(&parser_definition);
 }
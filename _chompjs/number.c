@@ -0,0 +1,210 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#include "number.h"
+
+#include "powers_of_five.h"
+
+#include <float.h>
+#include <string.h>
+
+// big integers are stored in limbs of 9 decimal digits, so that printing them is trivial
+#define LIMB_BASE 1000000000u
+// every limb holds at least 29 bits
+#define MAX_LIMBS (MAX_INTEGER_BITS / 29 + 2)
+
+void push_unsigned(struct CharBuffer* buffer, uint64_t value) {
+    char digits[20];
+    size_t start = sizeof(digits);
+    do {
+        start -= 1;
+        digits[start] = '0' + value % 10;
+        value /= 10;
+    } while(value);
+    push_string(buffer, digits + start, sizeof(digits) - start);
+}
+
+int digit_value(char c) {
+    if(c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if(c >= 'a' && c <= 'z') {
+        return c - 'a' + 10;
+    }
+    if(c >= 'A' && c <= 'Z') {
+        return c - 'A' + 10;
+    }
+    return 36;
+}
+
+bool push_integer_digits(struct CharBuffer* buffer, const char* digits, size_t count, int base) {
+    size_t bits = base == 16 ? 4 : base == 8 ? 3 : 1;
+    while(count > 0 && *digits == '0') {
+        digits += 1;
+        count -= 1;
+    }
+    if(count * bits > MAX_INTEGER_BITS) {
+        return false;
+    }
+    if(count * bits <= 64) {
+        uint64_t value = 0;
+        for(size_t i = 0; i < count; ++i) {
+            value = (value << bits) | digit_value(digits[i]);
+        }
+        push_unsigned(buffer, value);
+        return true;
+    }
+
+    // digits are added in groups of up to 28 bits, so that multiplication
+    // of a limb fits into 64 bits
+    uint32_t limbs[MAX_LIMBS];
+    size_t used = 0;
+    size_t group = 28 / bits;
+    for(size_t i = 0; i < count; i += group) {
+        size_t n = count - i < group ? count - i : group;
+        uint64_t carry = 0;
+        for(size_t j = 0; j < n; ++j) {
+            carry = (carry << bits) | digit_value(digits[i + j]);
+        }
+        uint64_t multiplier = (uint64_t)1 << (n * bits);
+        for(size_t k = 0; k < used; ++k) {
+            uint64_t product = limbs[k] * multiplier + carry;
+            limbs[k] = product % LIMB_BASE;
+            carry = product / LIMB_BASE;
+        }
+        while(carry) {
+            limbs[used] = carry % LIMB_BASE;
+            carry /= LIMB_BASE;
+            used += 1;
+        }
+    }
+
+    push_unsigned(buffer, limbs[used - 1]);
+    for(size_t k = used - 1; k-- > 0;) {
+        char limb_digits[9];
+        uint32_t limb = limbs[k];
+        for(size_t d = 9; d-- > 0;) {
+            limb_digits[d] = '0' + limb % 10;
+            limb /= 10;
+        }
+        push_string(buffer, limb_digits, 9);
+    }
+    return true;
+}
+
+// results of Clinger's fast path are only exact if operations aren't done
+// with extended precision, as on x87
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#define CHOMPJS_EXACT_DOUBLE_OPERATIONS
+static const double powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+#endif
+
+/** 128-bit product of two 64-bit numbers */
+static inline void multiply(uint64_t a, uint64_t b, uint64_t* high, uint64_t* low) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)a * b;
+    *high = (uint64_t)(product >> 64);
+    *low = (uint64_t)product;
+#else
+    uint64_t a_low = (uint32_t)a, a_high = a >> 32;
+    uint64_t b_low = (uint32_t)b, b_high = b >> 32;
+    uint64_t low_low = a_low * b_low;
+    uint64_t high_low = a_high * b_low;
+    uint64_t low_high = a_low * b_high;
+    uint64_t middle = (low_low >> 32) + (uint32_t)high_low + (uint32_t)low_high;
+    *high = a_high * b_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32);
+    *low = (middle << 32) | (uint32_t)low_low;
+#endif
+}
+
+static inline int leading_zeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(value);
+#else
+    int zeros = 0;
+    while(!(value & ((uint64_t)1 << 63))) {
+        value <<= 1;
+        zeros += 1;
+    }
+    return zeros;
+#endif
+}
+
+/**
+    Eisel-Lemire algorithm, as described in "Number Parsing at a Gigabyte per Second"
+    by Daniel Lemire. Mantissa is multiplied by a 128-bit approximation of the power
+    of ten, which is precise enough to round correctly apart from rare ambiguous
+    cases. Those, together with subnormal, zero and infinite results, are left
+    to the caller
+*/
+static bool eisel_lemire(uint64_t mantissa, int64_t exponent, double* value) {
+    if(mantissa == 0 || exponent < SMALLEST_POWER_OF_FIVE || exponent > LARGEST_POWER_OF_FIVE) {
+        return false;
+    }
+    int zeros = leading_zeros(mantissa);
+    mantissa <<= zeros;
+
+    // 10^q = 5^q * 2^q, the power of two only changes the binary exponent
+    size_t index = 2 * (size_t)(exponent - SMALLEST_POWER_OF_FIVE);
+    uint64_t high, low;
+    multiply(mantissa, powers_of_five[index], &high, &low);
+    // lower bits might change result after rounding, take low half of the power into account
+    const uint64_t precision_mask = UINT64_MAX >> 55;
+    if((high & precision_mask) == precision_mask) {
+        uint64_t second_high, second_low;
+        multiply(mantissa, powers_of_five[index + 1], &second_high, &second_low);
+        low += second_high;
+        if(second_high > low) {
+            high += 1;
+        }
+    }
+    // approximation might still be too imprecise
+    if(low == UINT64_MAX && (exponent < -27 || exponent > 55)) {
+        return false;
+    }
+
+    int upper_bit = (int)(high >> 63);
+    int shift = upper_bit + 9;
+    uint64_t bits = high >> shift;
+    // floor(log2(10^q)) + 63, with 1023 bias of double exponent
+    int64_t power = ((217706 * exponent) >> 16) + 63 + upper_bit - zeros + 1023;
+    if(power <= 0) {
+        return false;
+    }
+    // halfway between two doubles, round to even
+    if(low <= 1 && exponent >= -4 && exponent <= 23 && (bits & 3) == 1
+            && (bits << shift) == high) {
+        bits &= ~(uint64_t)1;
+    }
+    bits += bits & 1;
+    bits >>= 1;
+    if(bits >= ((uint64_t)2 << 52)) {
+        bits = (uint64_t)1 << 52;
+        power += 1;
+    }
+    if(power >= 0x7FF) {
+        return false;
+    }
+    bits &= ~((uint64_t)1 << 52);
+    bits |= (uint64_t)power << 52;
+    memcpy(value, &bits, sizeof(double));
+    return true;
+}
+
+bool fast_double(uint64_t mantissa, int64_t exponent, double* value) {
+#ifdef CHOMPJS_EXACT_DOUBLE_OPERATIONS
+    // both mantissa and power of ten are exactly representable, so
+    // the only rounding is done by the operation itself
+    if(mantissa <= ((uint64_t)1 << 53) && exponent >= -22 && exponent <= 22) {
+        double d = (double)mantissa;
+        *value = exponent < 0 ? d / powers_of_ten[-exponent] : d * powers_of_ten[exponent];
+        return true;
+    }
+#endif
+    return eisel_lemire(mantissa, exponent, value);
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#ifndef CHOMPJS_NUMBER_H
+#define CHOMPJS_NUMBER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "buffer.h"
+
+/**
+    Number conversions done while parsing, without libc formatting
+    and without Python API
+*/
+
+/**
+    Biggest supported non-decimal integer literal. Its decimal form stays
+    below default `sys.get_int_max_str_digits()` limit of Python
+*/
+#define MAX_INTEGER_BITS 14000
+
+/** Write decimal form of the number */
+void push_unsigned(struct CharBuffer* buffer, uint64_t value);
+
+/**
+    Write decimal form of an integer given by its digits in base 2, 8 or 16,
+    of any length up to MAX_INTEGER_BITS. No digits mean 0. False if too long
+*/
+bool push_integer_digits(struct CharBuffer* buffer, const char* digits, size_t count, int base);
+
+/** Digit value in bases up to 36, 36 for characters that aren't digits */
+int digit_value(char c);
+
+/**
+    Correctly rounded value of mantissa * 10^exponent, computed with a single
+    floating point operation when both are small (Clinger's fast path) or with
+    Eisel-Lemire algorithm otherwise. False in rare cases it can't decide, and
+    for subnormal, zero and infinite results. Caller has to fall back to
+    a slower conversion then
+*/
+bool fast_double(uint64_t mantissa, int64_t exponent, double* value);
+
+#endif
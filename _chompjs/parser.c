@@ -4,53 +4,215 @@
  */
 
 #include "parser.h"
+#include "scan.h"
+#include "escape.h"
+#include "number.h"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
-#include <string.h>
 
 #define INITIAL_NESTING_DEPTH 20
+#define MAX_INITIAL_OUTPUT_SIZE (64 << 10)
+// how far a candidate '{' is checked before it's accepted
+#define CANDIDATE_CHECK_LENGTH 256
+// input parsed between clock checks of `advance_until_deadline`, a few microseconds of work
+#define DEADLINE_CHECK_BYTES 1024
 
-struct State states[] = {
-    {begin},
-    {json},
-    {value},
-    {end},
-    {error},
+/** Character classes, used instead of locale dependent <ctype.h> functions */
+enum CharClass {
+    // ' ', '\t', '\n', '\v', '\f', '\r'
+    CC_WHITESPACE = 1,
+    CC_DIGIT = 2,
+    // letters, digits and '_', characters that can't follow a literal such as `true`
+    CC_IDENTIFIER = 4,
+    // characters continuing a base-10 number: digits, '.', 'e', 'E', '+', '-', '_'
+    CC_NUMBER = 8,
 };
 
-enum StateIndex {
-    BEGIN_STATE, JSON_STATE, VALUE_STATE, END_STATE, ERROR_STATE
+#define S_ CC_WHITESPACE
+#define D_ (CC_DIGIT | CC_IDENTIFIER | CC_NUMBER)
+#define L_ CC_IDENTIFIER
+// 'e', 'E' and '_'
+#define E_ (CC_IDENTIFIER | CC_NUMBER)
+#define N_ CC_NUMBER
+
+static const unsigned char char_classes[256] = {
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  S_, S_, S_, S_, S_, 0,  0,  // 0x00
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  // 0x10
+    S_, 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  N_, 0,  N_, N_, 0,  // 0x20  !"#$%&'()*+,-./
+    D_, D_, D_, D_, D_, D_, D_, D_, D_, D_, 0,  0,  0,  0,  0,  0,  // 0x30 0-9:;<=>?
+    0,  L_, L_, L_, L_, E_, L_, L_, L_, L_, L_, L_, L_, L_, L_, L_,  // 0x40 @A-O
+    L_, L_, L_, L_, L_, L_, L_, L_, L_, L_, L_, 0,  0,  0,  0,  E_,  // 0x50 P-Z[\]^_
+    0,  L_, L_, L_, L_, E_, L_, L_, L_, L_, L_, L_, L_, L_, L_, L_,  // 0x60 `a-o
+    L_, L_, L_, L_, L_, L_, L_, L_, L_, L_, L_, 0,  0,  0,  0,  0,   // 0x70 p-z{|}~
+    // bytes of multibyte UTF-8 characters don't belong to any class
 };
 
-void advance(struct Parser* parser) {
-    parser->state = parser->state->change(parser);
+#undef S_
+#undef D_
+#undef L_
+#undef E_
+#undef N_
+
+static inline bool has_class(char c, enum CharClass char_class) {
+    return char_classes[(unsigned char)c] & char_class;
 }
 
-char next_char(struct Parser* parser) {
-    while(1) {
-        if(isspace(parser->input[parser->input_position])) {
+const struct ParserLimits no_limits = {SIZE_MAX, SIZE_MAX, SIZE_MAX};
+
+/*
+    Handlers of states of internal state machine, each returns the next state.
+    End and error states are handled directly in `run_states`
+    * begin - start parsing
+    * json - handle special characters: "[", "{", "}", "]", ",", ":"
+    * value - handle a JSON value, such as strings and numbers
+    * single_value - handle a value outside of any object, then finish work
+*/
+static ParserState begin(struct Parser* parser);
+static ParserState json(struct Parser* parser);
+static ParserState value(struct Parser* parser);
+static ParserState single_value(struct Parser* parser);
+
+/*
+    Helper functions used in "value" state
+    * handle_value - dispatch on the first character of a value
+    * handle_quoted - handles quoted strings
+    * handle_numeric - handle numbers
+    * handle_numeric_standard_base - handle numbers in standard base-10
+    * handle_numeric_non_standard_base - handle numbers in non-standard bases (hex, oct)
+    * handle_unrecognized - save all unrecognized data as a string
+*/
+static ParserState handle_value(struct Parser* parser);
+static ParserState handle_quoted(struct Parser* parser);
+static ParserState handle_numeric(struct Parser* parser);
+static ParserState handle_numeric_standard_base(struct Parser* parser);
+static ParserState handle_numeric_non_standard_base(struct Parser* parser, int base);
+static ParserState handle_unrecognized(struct Parser* parser);
+
+static inline void run_states(struct Parser* parser, size_t stop) {
+    // states are switched in a single loop, until the parser finishes or fails
+    for(;;) {
+        if(parser->input_position >= stop) {
+            return;
+        }
+        if(parser->failure != INVALID_INPUT) {
+            parser->state = ERROR_STATE;
+        }
+        switch(parser->state) {
+        case BEGIN_STATE:
+            parser->state = begin(parser);
+        break;
+        case JSON_STATE:
+            parser->state = json(parser);
+        break;
+        case VALUE_STATE:
+            parser->state = value(parser);
+        break;
+        case SINGLE_VALUE_STATE:
+            parser->state = single_value(parser);
+        break;
+        // terminating '\0' is written even if the output is limited, there
+        // is always room left for a single character
+        case END_STATE:
+            push(&parser->output, '\0');
             parser->input_position += 1;
-            continue;
+            parser->parser_status = FINISHED;
+            return;
+        case ERROR_STATE:
+            push(&parser->output, '\0');
+            parser->input_position += 1;
+            parser->parser_status = ERROR;
+            return;
+        }
+    }
+}
+
+void advance(struct Parser* parser) {
+    run_states(parser, SIZE_MAX);
+}
+
+void advance_until(struct Parser* parser, size_t stop) {
+    run_states(parser, stop);
+}
+
+void advance_until_deadline(struct Parser* parser, size_t stop, uint64_t deadline) {
+    // clock is read between short slices of the input, reading it after every
+    // state would take longer than parsing most of them
+    for(;;) {
+        size_t slice_stop = parser->input_position + DEADLINE_CHECK_BYTES;
+        if(slice_stop > stop || slice_stop < parser->input_position) {
+            slice_stop = stop;
+        }
+        run_states(parser, slice_stop);
+        if(parser->parser_status != CAN_ADVANCE || parser->input_position >= stop
+                || monotonic_ns() >= deadline) {
+            return;
         }
-        return parser->input[parser->input_position];
     }
-    return '\0';
+}
+
+char peek(struct Parser* parser, size_t offset) {
+    size_t position = parser->input_position + offset;
+    if(position >= parser->input_length) {
+        return '\0';
+    }
+    return parser->input[position];
+}
+
+bool matches(struct Parser* parser, const char* s, size_t length) {
+    if(parser->input_position + length > parser->input_length) {
+        return false;
+    }
+    return memcmp(parser->input + parser->input_position, s, length) == 0;
+}
+
+char next_char(struct Parser* parser) {
+    // tokens usually aren't preceded by whitespace, avoid calling the kernel then
+    char c = peek(parser, 0);
+    if(!has_class(c, CC_WHITESPACE)) {
+        return c;
+    }
+    parser->input_position += scan_whitespace(
+        parser->input + parser->input_position,
+        parser->input + parser->input_length
+    );
+    return peek(parser, 0);
 }
 
 char last_char(struct Parser* parser) {
     return top(&parser->output);
 }
 
+/** Check if `size` more characters can be written, mark the failure if they can't */
+static inline bool reserve_output(struct Parser* parser, size_t size) {
+    if(parser->failure != INVALID_INPUT) {
+        return false;
+    }
+    if(size > parser->limits.max_output_bytes - parser->object_output_length) {
+        parser->failure = OUTPUT_LIMIT_EXCEEDED;
+        return false;
+    }
+    if(!check_capacity(&parser->output, size)) {
+        parser->failure = OUT_OF_MEMORY;
+        return false;
+    }
+    parser->object_output_length += size;
+    STAT_ADD(parser, bytes_emitted, size);
+    return true;
+}
+
 void emit(char c, struct Parser* parser) {
-    push(&parser->output, c);
-    parser->input_position += 1;   
+    emit_in_place(c, parser);
+    parser->input_position += 1;
 }
 
 void emit_in_place(char c, struct Parser* parser) {
-    push(&parser->output, c);
+    if(reserve_output(parser, 1)) {
+        parser->output.data[parser->output.index] = c;
+        parser->output.index += 1;
+    }
 }
 
 void unemit(struct Parser* parser) {
@@ -58,119 +220,451 @@ void unemit(struct Parser* parser) {
 }
 
 void emit_string(const char *s, size_t size, struct Parser* parser) {
-    push_string(&parser->output, s, size);
-    parser->input_position += size;   
+    emit_string_in_place(s, size, parser);
+    parser->input_position += size;
 }
 
 void emit_string_in_place(const char *s, size_t size, struct Parser* parser) {
-    push_string(&parser->output, s, size);
+    if(reserve_output(parser, size)) {
+        memcpy(parser->output.data + parser->output.index, s, size);
+        parser->output.index += size;
+    }
 }
 
-void emit_number_in_place(long value, struct Parser* parser) {
-    push_number(&parser->output, value);
+bool emit_integer_in_place(const char* digits, size_t count, int base, struct Parser* parser) {
+    if(parser->failure != INVALID_INPUT) {
+        return true;
+    }
+    // every bit adds at most 0.302 of a decimal digit, room is made in advance
+    // so that writing the digits can't fail halfway
+    size_t bits = count * (base == 16 ? 4 : base == 8 ? 3 : 1);
+    if(bits > MAX_INTEGER_BITS) {
+        bits = MAX_INTEGER_BITS;
+    }
+    if(!check_capacity(&parser->output, bits * 31 / 100 + 2)) {
+        parser->failure = OUT_OF_MEMORY;
+        return true;
+    }
+    size_t start = parser->output.index;
+    if(!push_integer_digits(&parser->output, digits, count, base)) {
+        return false;
+    }
+    size_t length = parser->output.index - start;
+    parser->output.index = start;
+    if(reserve_output(parser, length)) {
+        parser->output.index += length;
+    }
+    return true;
 }
 
-void init_parser(struct Parser* parser, const char* string) {
+void init_parser(struct Parser* parser, const char* string, size_t length) {
     parser->input = string;
+    parser->input_length = length;
+    parser->unescaped_input = NULL;
+    parser->unescaped_capacity = 0;
     // allocate in advance more memory for output than for input because we might need
     // to add extra characters
     // for example `{a: undefined}` will be translated as `{"a": "undefined"}`
-    parser->output_size = 2 * strlen(string) + 1;
+    // Big inputs usually contain many objects, each emitted separately, so the
+    // buffer grows to the size of the largest one instead
+    parser->output_size = 2 * parser->input_length + 1;
+    if(parser->output_size > MAX_INITIAL_OUTPUT_SIZE) {
+        parser->output_size = MAX_INITIAL_OUTPUT_SIZE;
+    }
     init_char_buffer(&parser->output, parser->output_size);
     parser->input_position = 0;
     init_char_buffer(&parser->nesting_depth, INITIAL_NESTING_DEPTH);
     parser->unrecognized_nesting_depth = 0;
     parser->parser_status = CAN_ADVANCE;
-    parser->state = &states[BEGIN_STATE];
+    parser->state = BEGIN_STATE;
+    parser->is_key = false;
+    parser->sink = NULL;
+    parser->limits = no_limits;
+    parser->object_start = 0;
+    parser->rewritten = false;
+    memset(parser->preceding, '\0', PRECEDING_LENGTH);
+    parser->candidate_cut = false;
+    parser->failure = INVALID_INPUT;
+    parser->object_output_length = 0;
+    reset_parser_stats(parser);
+}
+
+bool unescape_input(struct Parser* parser) {
+    // decoded input is never longer than the original one, buffer is kept
+    // when parser is reused
+    if(parser->unescaped_capacity < parser->input_length + 1) {
+        free(parser->unescaped_input);
+        parser->unescaped_input = malloc(parser->input_length + 1);
+        if(parser->unescaped_input == NULL) {
+            parser->unescaped_capacity = 0;
+            parser->failure = OUT_OF_MEMORY;
+            parser->parser_status = ERROR;
+            return false;
+        }
+        parser->unescaped_capacity = parser->input_length + 1;
+    }
+    parser->input_length = decode_escapes(
+        parser->input, parser->input_length, parser->unescaped_input
+    );
+    parser->input = parser->unescaped_input;
+    return true;
+}
+
+void start_at_value(struct Parser* parser, size_t position) {
+    parser->input_position = position;
+    char c = next_char(parser);
+    if(c == '{' || c == '[') {
+        return;
+    }
+    parser->state = SINGLE_VALUE_STATE;
+}
+
+bool find_object(struct Parser* parser, size_t* position) {
+    size_t input_position = parser->input_position;
+    bool found = begin(parser) == JSON_STATE;
+    if(found) {
+        *position = parser->object_start;
+    }
+    // nothing is parsed yet, parsing starts over from the same position
+    parser->input_position = input_position;
     parser->is_key = false;
+    parser->candidate_cut = false;
+    return found;
+}
+
+void reset_parser_input(struct Parser* parser, const char* string, size_t length) {
+    parser->input = string;
+    parser->input_length = length;
+    parser->input_position = 0;
+    clear(&parser->output);
+    clear(&parser->nesting_depth);
+    parser->unrecognized_nesting_depth = 0;
+    parser->parser_status = CAN_ADVANCE;
+    parser->state = BEGIN_STATE;
+    parser->is_key = false;
+    parser->object_start = 0;
+    parser->rewritten = false;
+    memset(parser->preceding, '\0', PRECEDING_LENGTH);
+    parser->candidate_cut = false;
+    parser->failure = INVALID_INPUT;
+    parser->object_output_length = 0;
+    reset_parser_stats(parser);
+}
+
+void append_preceding(char* preceding, const char* data, size_t length) {
+    if(length >= PRECEDING_LENGTH) {
+        memcpy(preceding, data + length - PRECEDING_LENGTH, PRECEDING_LENGTH);
+        return;
+    }
+    memmove(preceding, preceding + length, PRECEDING_LENGTH - length);
+    memcpy(preceding + PRECEDING_LENGTH - length, data, length);
 }
 
 void reset_parser_output(struct Parser* parser) {
     clear(&parser->output);
+    start_next_object(parser);
+}
+
+void start_next_object(struct Parser* parser) {
+    clear(&parser->nesting_depth);
+    parser->failure = INVALID_INPUT;
+    parser->object_output_length = 0;
     parser->parser_status = CAN_ADVANCE;
-    parser->state = &states[BEGIN_STATE];
+    parser->state = BEGIN_STATE;
     parser->is_key = false;
+    parser->rewritten = false;
     parser->input_position -= 1;
 }
 
+void reset_parser_stats(struct Parser* parser) {
+#ifdef CHOMPJS_STATS
+    memset(&parser->stats, 0, sizeof(parser->stats));
+    parser->output.growths = 0;
+#else
+    (void)parser;
+#endif
+}
+
+#ifdef CHOMPJS_STATS
+const struct ParserStats* collect_parser_stats(struct Parser* parser) {
+    parser->stats.bytes_scanned = parser->input_position < parser->input_length
+        ? parser->input_position : parser->input_length;
+    parser->stats.output_growths = parser->output.growths;
+    return &parser->stats;
+}
+#endif
+
 void release_parser(struct Parser* parser) {
     release_char_buffer(&parser->output);
+    release_char_buffer(&parser->nesting_depth);
+    free(parser->unescaped_input);
 }
 
-struct State* begin(struct Parser* parser) {
+bool report(struct Parser* parser, TokenType type, size_t start) {
+    // token might have been cut short by the output limit
+    if(parser->failure != INVALID_INPUT) {
+        return false;
+    }
+    if(parser->sink == NULL) {
+        return true;
+    }
+    return parser->sink->handle(
+        parser->sink->context,
+        type,
+        parser->output.data + start,
+        parser->output.index - start
+    );
+}
+
+/** Keywords after which an expression starts, `return[1, 2]` is an array and not indexing */
+static const char* const expression_keywords[] = {
+    "return", "typeof", "in", "of", "case", "void", "yield", "await", "else",
+    "do", "throw", "delete", "true", "false", "null", NULL,
+};
+
+/** Character at given input position, positions below 0 are looked up in `preceding` */
+static inline char char_at(struct Parser* parser, ptrdiff_t position) {
+    if(position >= 0) {
+        return parser->input[position];
+    } else if(position < -PRECEDING_LENGTH) {
+        return '\0';
+    }
+    return parser->preceding[PRECEDING_LENGTH + position];
+}
+
+/** Check if the word that ends just before current input position is one of `expression_keywords` */
+static bool follows_expression_keyword(struct Parser* parser) {
+    ptrdiff_t end = (ptrdiff_t)parser->input_position;
+    ptrdiff_t start = end;
+    while(start > end - PRECEDING_LENGTH
+            && (has_class(char_at(parser, start - 1), CC_IDENTIFIER) || char_at(parser, start - 1) == '$')) {
+        start -= 1;
+    }
+    // word is too long to be a keyword, or it's a property such as `a.return`
+    char before = char_at(parser, start - 1);
+    if(has_class(before, CC_IDENTIFIER) || before == '$' || before == '.') {
+        return false;
+    }
+    size_t length = end - start;
+    for(const char* const* keyword = expression_keywords; *keyword != NULL; ++keyword) {
+        if(strlen(*keyword) != length) {
+            continue;
+        }
+        size_t i = 0;
+        while(i < length && (*keyword)[i] == char_at(parser, start + i)) {
+            i += 1;
+        }
+        if(i == length) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+    Check if bracket at current input position obviously doesn't start an object.
+    '[' directly following a name or a call is indexing, such as `a[0]` or `f()[0]`,
+    unless the name is a keyword such as `return`.
+    '{' which has ';' before the first ',' or closing bracket on the same level is
+    a CSS block or a block of code, such as `a { color: red; }` or `{ f(a, b); }`
+*/
+static bool is_rejected_candidate(struct Parser* parser, char bracket) {
+    parser->candidate_cut = false;
+    if(bracket == '[') {
+        char previous = char_at(parser, (ptrdiff_t)parser->input_position - 1);
+        if(has_class(previous, CC_IDENTIFIER) || previous == '$') {
+            return !follows_expression_keyword(parser);
+        }
+        return previous == ')';
+    }
+
+    const char* s = parser->input + parser->input_position + 1;
+    const char* end = parser->input + parser->input_length;
+    if(end - s > CANDIDATE_CHECK_LENGTH) {
+        end = s + CANDIDATE_CHECK_LENGTH;
+    }
+    size_t depth = 0;
+    for(; s < end; ++s) {
+        switch(*s) {
+        case '{':
+        case '[':
+        case '(':
+            depth += 1;
+        break;
+        case '}':
+        case ']':
+        case ')':
+            if(depth == 0) {
+                return false;
+            }
+            depth -= 1;
+        break;
+        case ',':
+            if(depth == 0) {
+                return false;
+            }
+        break;
+        case ';':
+            if(depth == 0) {
+                return true;
+            }
+        break;
+        case '"':
+        case '\'':
+        case '`':
+            {
+                char quote = *s;
+                s += 1;
+                while(s < end && *s != quote) {
+                    if(*s == '\\' && s + 1 < end) {
+                        s += 1;
+                    }
+                    s += 1;
+                }
+            }
+        break;
+        // comments and HTML entities, such as `&quot;`, aren't worth checking
+        case '/':
+        case '&':
+        case '\0':
+            return false;
+        }
+    }
+    parser->candidate_cut = end == parser->input + parser->input_length;
+    return false;
+}
+
+static ParserState begin(struct Parser* parser) {
     // Ignoring characters until either '{' or '[' appears
     for(;;) {
-        switch(next_char(parser)) {
+        parser->input_position += scan_candidates(
+            parser->input + parser->input_position,
+            parser->input + parser->input_length
+        );
+        char c = peek(parser, 0);
+        switch(c) {
         case '{':
-            parser->is_key = true;
-        case '[':;
-            return &states[JSON_STATE];
-        break;
+        case '[':
+            if(is_rejected_candidate(parser, c)) {
+                parser->input_position += 1;
+                break;
+            }
+            if(c == '{') {
+                parser->is_key = true;
+            }
+            parser->object_start = parser->input_position;
+            parser->object_output_length = 0;
+            return JSON_STATE;
         case '\0':;
-            return &states[END_STATE];
+            return END_STATE;
         case '/':
             {
-                char next_c = parser->input[parser->input_position+1];
+                char next_c = peek(parser, 1);
                 if(next_c == '/' || next_c == '*') {
                     handle_comments(parser);
+                    break;
                 }
             }                
         default:
             parser->input_position += 1;
         }
     }
-    return &states[ERROR_STATE];
+    return ERROR_STATE;
 }
 
-struct State* json(struct Parser* parser) {
+/** Enter an object or an array, false if it's nested too deep */
+static bool open_bracket(struct Parser* parser, char bracket) {
+    if(size(&parser->nesting_depth) >= parser->limits.max_depth) {
+        parser->failure = DEPTH_LIMIT_EXCEEDED;
+        return false;
+    }
+    if(!push(&parser->nesting_depth, bracket)) {
+        parser->failure = OUT_OF_MEMORY;
+        return false;
+    }
+    return true;
+}
+
+static ParserState json(struct Parser* parser) {
     for(;;) {
+        // output limit might have been exceeded by the last token
+        if(parser->failure != INVALID_INPUT) {
+            return ERROR_STATE;
+        }
         switch(next_char(parser)) {
         case '{':
-            push(&parser->nesting_depth, '{');
+            if(!open_bracket(parser, '{')) {
+                return ERROR_STATE;
+            }
+            STAT_MAX(parser, peak_depth, size(&parser->nesting_depth));
             parser->is_key = true;
             emit('{', parser);
+            if(!report(parser, TOKEN_OBJECT_START, parser->output.index - 1)) {
+                return ERROR_STATE;
+            }
         break;
         case '[':
-            push(&parser->nesting_depth, '[');
+            if(!open_bracket(parser, '[')) {
+                return ERROR_STATE;
+            }
+            STAT_MAX(parser, peak_depth, size(&parser->nesting_depth));
             emit('[', parser);
+            if(!report(parser, TOKEN_ARRAY_START, parser->output.index - 1)) {
+                return ERROR_STATE;
+            }
         break;
         case '}':
             if(last_char(parser) == ',') {
                 unemit(parser);
+                parser->rewritten = true;
             }
             pop(&parser->nesting_depth);
             parser->is_key = top(&parser->nesting_depth) == '{';
             emit('}', parser);
+            if(!report(parser, TOKEN_OBJECT_END, parser->output.index - 1)) {
+                return ERROR_STATE;
+            }
             if(size(&parser->nesting_depth) <= 0) {
-                return &states[END_STATE];
+                return END_STATE;
             }
         break;
         case ']':
             if(last_char(parser) == ',') {
                 unemit(parser);
+                parser->rewritten = true;
             }
             pop(&parser->nesting_depth);
             parser->is_key = top(&parser->nesting_depth) == '{';
             emit(']', parser);
+            if(!report(parser, TOKEN_ARRAY_END, parser->output.index - 1)) {
+                return ERROR_STATE;
+            }
             if(size(&parser->nesting_depth) <= 0) {
-                return &states[END_STATE];
+                return END_STATE;
             }
         break;
         case ':':
             parser->is_key = false;
             emit(':', parser);
+            if(!report(parser, TOKEN_COLON, parser->output.index - 1)) {
+                return ERROR_STATE;
+            }
         break;
         case ',':
             emit(',', parser);
             parser->is_key = top(&parser->nesting_depth) == '{';
+            if(!report(parser, TOKEN_COMMA, parser->output.index - 1)) {
+                return ERROR_STATE;
+            }
         break;
 
         case '/':;
-            char next_c = parser->input[parser->input_position+1];
+            char next_c = peek(parser, 1);
             if(next_c == '/' || next_c == '*') {
                 handle_comments(parser);
+                parser->rewritten = true;
             } else {
-                return &states[VALUE_STATE];
+                return VALUE_STATE;
             }
         break;
 
@@ -178,79 +672,129 @@ struct State* json(struct Parser* parser) {
         // cause an infinite loop without this check
         case '>':
         case ')':;
-            return &states[ERROR_STATE];
+            return ERROR_STATE;
         break;
 
         default:
-            return &states[VALUE_STATE];
+            return VALUE_STATE;
         }
     }
 
-    return &states[ERROR_STATE];
+    return ERROR_STATE;
 }
 
-struct State* _handle_string(struct Parser* parser, const char* string, size_t length) {
-    char next_char = parser->input[parser->input_position+length+1];
-    if(next_char == '_' || isalnum(next_char)) {
+static ParserState _handle_string(struct Parser* parser, const char* string, size_t length) {
+    char next_char = peek(parser, length);
+    if(has_class(next_char, CC_IDENTIFIER)) {
         return handle_unrecognized(parser);
     }
     emit_string(string, length, parser);
-    return &states[JSON_STATE];
+    return JSON_STATE;
+}
+
+static ParserState value(struct Parser* parser) {
+    char previous = last_char(parser);
+    size_t start = parser->output.index;
+    ParserState next = handle_value(parser);
+    if(next != JSON_STATE || parser->output.index == start) {
+        return next;
+    }
+    // inside of an object a value only follows a bracket, ',' or ':', so that
+    // `[6 3]` isn't read as `[63]`. Builder has the same rule
+    if(size(&parser->nesting_depth) > 0 && previous != '[' && previous != '{' && previous != ',' && previous != ':') {
+        return ERROR_STATE;
+    }
+    if(!report(parser, TOKEN_VALUE, start)) {
+        return ERROR_STATE;
+    }
+    // values are consumed by the sink, output buffer can be reused. A single
+    // character is left in place of the value, so that a comma before it
+    // isn't taken for a trailing one
+    if(parser->sink != NULL && parser->sink->consumes_values) {
+        parser->output.index = start;
+        push(&parser->output, '0');
+    }
+    return next;
 }
 
-struct State* value(struct Parser* parser) {
+static ParserState handle_value(struct Parser* parser) {
     char c = next_char(parser);
-    const char* position = parser->input + parser->input_position;
 
-    if(c == '"' || c == '\'' || c == '`') {
+    // literals are told apart by their first character, then compared as a whole
+    switch(c) {
+    case '"':
+    case '\'':
+    case '`':
+        STAT_ADD(parser, quoted_values, 1);
         return handle_quoted(parser);
-    } else if(isdigit(c) || c == '.' || c == '-') {
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+    case '.':
+    case '-':
         if(parser->is_key) {
             return handle_unrecognized(parser);
-        } else {
-            return handle_numeric(parser);
         }
-    } else if(strncmp(position, "true", 4) == 0) {
-        return _handle_string(parser, "true", 4);
-    } else if(strncmp(position, "false", 5) == 0) {
-        return _handle_string(parser, "false", 5);
-    } else if(strncmp(position, "null", 4) == 0) {
-        return _handle_string(parser, "null", 4);
-    } else if(c == ']' || c == '}' || c == '[' || c == '{') {
-        return &states[JSON_STATE];
-    } else if(strncmp(position, "NaN", 3) == 0) {
-        return _handle_string(parser, "NaN", 3);
-    } else {
-        return handle_unrecognized(parser);
+        STAT_ADD(parser, numeric_values, 1);
+        return handle_numeric(parser);
+    case 't':
+        if(matches(parser, "true", 4)) {
+            return _handle_string(parser, "true", 4);
+        }
+    break;
+    case 'f':
+        if(matches(parser, "false", 5)) {
+            return _handle_string(parser, "false", 5);
+        }
+    break;
+    case 'n':
+        if(matches(parser, "null", 4)) {
+            return _handle_string(parser, "null", 4);
+        }
+    break;
+    case 'N':
+        if(matches(parser, "NaN", 3)) {
+            return _handle_string(parser, "NaN", 3);
+        }
+    break;
+    case ']':
+    case '}':
+    case '[':
+    case '{':
+        return JSON_STATE;
     }
-
-    return &states[JSON_STATE];
-}
-
-struct State* end(struct Parser* parser) {
-    emit('\0', parser);
-    parser->parser_status = FINISHED;
-    return parser->state;
+    return handle_unrecognized(parser);
 }
 
-struct State* error(struct Parser* parser) {
-    emit('\0', parser);
-    parser->parser_status = ERROR;
-    return parser->state;
+static ParserState single_value(struct Parser* parser) {
+    if(value(parser) != JSON_STATE) {
+        return ERROR_STATE;
+    }
+    return END_STATE;
 }
 
-struct State* handle_quoted(struct Parser* parser) {
+static ParserState handle_quoted(struct Parser* parser) {
     char current_quotation = next_char(parser);
+    const char* input_end = parser->input + parser->input_length;
+    if(current_quotation != '"') {
+        parser->rewritten = true;
+    }
     emit('"', parser);
 
     for(;;) {
-        char c = parser->input[parser->input_position];
+        // copy whole run of characters that don't need special handling
+        size_t run = scan_quoted(
+            parser->input + parser->input_position, input_end, current_quotation
+        );
+        emit_string(parser->input + parser->input_position, run, parser);
+
+        char c = peek(parser, 0);
         // handle escape sequences such as \\ and \'
         if(c == '\\') {
-            char escaped = parser->input[parser->input_position+1];
+            char escaped = peek(parser, 1);
             if(escaped == '\'') {
                 emit('\'', parser);
                 parser->input_position += 1;
+                parser->rewritten = true;
             } else {
                 emit('\\', parser);
                 emit(escaped, parser);   
@@ -259,12 +803,12 @@ struct State* handle_quoted(struct Parser* parser) {
         }
         // in case of malformed quotation we can reach end of the input
         if(c == '\0') {
-            return &states[ERROR_STATE];
+            return ERROR_STATE;
         }
         // if we're closing the quotations, we're done with the string
         if(c == current_quotation) {
             emit('"', parser);
-            return &states[JSON_STATE];
+            return JSON_STATE;
         }
         // otherwise, emit character
         if(c == '"') {
@@ -275,22 +819,27 @@ struct State* handle_quoted(struct Parser* parser) {
         }
     }
             
-    return &states[ERROR_STATE];
+    return ERROR_STATE;
 }
 
-struct State* handle_numeric(struct Parser* parser) {
+static ParserState handle_numeric(struct Parser* parser) {
     char c = next_char(parser);
     if(c >= 49 && c <= 57) { // 1-9 range
         return handle_numeric_standard_base(parser);
     } else if(c == '.') {
+        parser->rewritten = true;
         emit_in_place('0', parser);
         emit('.', parser);
         return handle_numeric_standard_base(parser);
     } else if(c == '-') {
-        emit('-', parser);
+        // signs are repeated in a loop, long runs of them can't exhaust the stack
+        while(c == '-') {
+            emit('-', parser);
+            c = next_char(parser);
+        }
         return handle_numeric(parser);
     } else if(c == '0') {
-        char nc = tolower(parser->input[parser->input_position+1]);
+        char nc = peek(parser, 1);
         if(nc == '.') {
             emit('0', parser);
             emit('.', parser);
@@ -300,52 +849,86 @@ struct State* handle_numeric(struct Parser* parser) {
         } else if(nc == 'o' || nc == 'O') {
             parser->input_position += 2;
             return handle_numeric_non_standard_base(parser, 8);
-        } else if(isdigit(nc)) {
+        } else if(has_class(nc, CC_DIGIT)) {
             return handle_numeric_non_standard_base(parser, 8);
         } else if(nc == 'b' || nc == 'B') {
             parser->input_position += 2;
             return handle_numeric_non_standard_base(parser, 2);
         } else {
             emit('0', parser);
-            return &states[JSON_STATE];
+            return JSON_STATE;
         }
     } else {
-        return &states[ERROR_STATE];
+        return ERROR_STATE;
     }
-    return &states[JSON_STATE];
+    return JSON_STATE;
 }
 
-struct State* handle_numeric_standard_base(struct Parser* parser) {
+static ParserState handle_numeric_standard_base(struct Parser* parser) {
+    // the first character is taken as it is
     char c = next_char(parser);
-    do {
-        if(c != '_') {
-            emit(c, parser);
-        } else {
+    for(;;) {
+        if(c == '_') {
             parser->input_position += 1;
+            parser->rewritten = true;
+        } else {
+            emit(c, parser);
         }
-        c = tolower(parser->input[parser->input_position]);
-    } while(isdigit(c) || c == '.' || c == 'e' || c == 'E' || c == '+' || c =='-' || c == '_');
+        // characters that don't need to be changed are copied at once
+        size_t run = 0;
+        if(parser->input_position < parser->input_length) {
+            const char* s = parser->input + parser->input_position;
+            size_t left = parser->input_length - parser->input_position;
+            while(run < left && has_class(s[run], CC_NUMBER) && s[run] != '_' && s[run] != 'E') {
+                run += 1;
+            }
+            emit_string(s, run, parser);
+        }
+        c = peek(parser, 0);
+        if(!has_class(c, CC_NUMBER)) {
+            break;
+        }
+        // exponent is always written in lowercase
+        if(c == 'E') {
+            c = 'e';
+        }
+    }
     if(last_char(parser) == '.') {
         emit_in_place('0', parser);
+        parser->rewritten = true;
     }
-    return &states[JSON_STATE];
+    return JSON_STATE;
 }
 
-struct State* handle_numeric_non_standard_base(struct Parser* parser, int base) {
-    char* end;
-    long n = strtol(parser->input + parser->input_position, &end, base);
-    emit_number_in_place(n, parser);
-    parser->input_position = end - parser->input;
-    return &states[JSON_STATE];
+static ParserState handle_numeric_non_standard_base(struct Parser* parser, int base) {
+    // digits are converted exactly, numbers too big for that are an error
+    size_t digits = 0;
+    parser->rewritten = true;
+    if(base == 16 && peek(parser, 0) == '0' && (peek(parser, 1) == 'x' || peek(parser, 1) == 'X')
+            && digit_value(peek(parser, 2)) < 16) {
+        digits = 2;
+    }
+    size_t first_digit = digits;
+    while(digit_value(peek(parser, digits)) < base) {
+        digits += 1;
+    }
+    if(!emit_integer_in_place(
+            parser->input + parser->input_position + first_digit, digits - first_digit, base, parser)) {
+        return ERROR_STATE;
+    }
+    parser->input_position += digits;
+    return JSON_STATE;
 }
 
-struct State* handle_unrecognized(struct Parser* parser) {
+static ParserState handle_unrecognized(struct Parser* parser) {
+    STAT_ADD(parser, unrecognized_values, 1);
+    parser->rewritten = true;
     emit_in_place('"', parser);
     char currently_quoted_with = '\0';
 
     parser->unrecognized_nesting_depth = 0;
-    do {
-        char c = parser->input[parser->input_position];
+    while(peek(parser, 0) != '\0') {
+        char c = peek(parser, 0);
 
         switch(c) {
             case '\\':
@@ -393,11 +976,11 @@ struct State* handle_unrecognized(struct Parser* parser) {
                     parser->unrecognized_nesting_depth -= 1;
                 } else {
                     // remove trailing whitespaces after value
-                    while(isspace(last_char(parser))) {
+                    while(has_class(last_char(parser), CC_WHITESPACE)) {
                         pop(&parser->output);
                     }
                     emit_in_place('"', parser);
-                    return &states[JSON_STATE];
+                    return JSON_STATE;
                 }
             break;
 
@@ -405,11 +988,11 @@ struct State* handle_unrecognized(struct Parser* parser) {
             case ':':
                 if(!currently_quoted_with && parser->unrecognized_nesting_depth <= 0) {
                     // remove trailing whitespaces after key
-                    while(isspace(last_char(parser))) {
+                    while(has_class(last_char(parser), CC_WHITESPACE)) {
                         pop(&parser->output);
                     }
                     emit_in_place('"', parser);
-                    return &states[JSON_STATE];
+                    return JSON_STATE;
                 } else {
                     emit(c, parser);
                 }
@@ -418,29 +1001,31 @@ struct State* handle_unrecognized(struct Parser* parser) {
             default:
                 emit(c, parser);
         }
-    } while (parser->input[parser->input_position] != '\0');
+    }
 
-    return &states[ERROR_STATE];
+    return ERROR_STATE;
 }
 
 void handle_comments(struct Parser* parser) {
-    char c, next_c;
+    const char* input_end = parser->input + parser->input_length;
+    STAT_ADD(parser, comments, 1);
 
     parser->input_position += 1;
-    if(parser->input[parser->input_position] == '/' ) {
+    if(peek(parser, 0) == '/' ) {
+        parser->input_position += 1;
+        parser->input_position += scan_until(
+            parser->input + parser->input_position, input_end, '\n'
+        );
+    } else if(peek(parser, 0) == '*') {
         for(;;) {
-            parser->input_position+=1;
-            c = parser->input[parser->input_position];
-            if((c == '\0') || (c == '\n')) {
-                break;
+            parser->input_position += 1;
+            parser->input_position += scan_until(
+                parser->input + parser->input_position, input_end, '*'
+            );
+            if(peek(parser, 0) == '\0') {
+                return;
             }
-        }
-    } else if(parser->input[parser->input_position] == '*') {
-        for(;;) {
-            parser->input_position+=1;
-            c = parser->input[parser->input_position];
-            next_c = parser->input[parser->input_position+1];
-            if((c == '\0') || (c == '*' && next_c == '/')) {
+            if(peek(parser, 1) == '/') {
                 break;
             }
         }
@@ -8,45 +8,34 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "buffer.h"
+#include "stats.h"
 
 struct Parser;
 
-/**
-    States of internal state machine:
-    * begin - start parsing
-    * json - handle special characters: "[", "{", "}", "]", ",", ":"
-    * value - handle a JSON value, such as strings and numbers
-    * end - finish work
-    * error - finish work, mark an error
-*/
-struct State* begin(struct Parser* parser);
-struct State* json(struct Parser* parser);
-struct State* value(struct Parser* parser);
-struct State* end(struct Parser* parser);
-struct State* error(struct Parser* parser);
-
-/*
-    Helper functions used in "value" state
-    * handle_quoted - handles quoted strings
-    * handle_numeric - handle numbers
-    * handle_numeric_standard_base - handle numbers in standard base-10
-    * handle_numeric_non_standard_base - handle numbers in non-standard bases (hex, oct)
-    * handle_unrecognized - save all unrecognized data as a string
-*/
-struct State* handle_quoted(struct Parser* parser);
-struct State* handle_numeric(struct Parser* parser);
-struct State* handle_numeric_standard_base(struct Parser* parser);
-struct State* handle_numeric_non_standard_base(struct Parser* parser, int base);
-struct State* handle_unrecognized(struct Parser* parser);
+// characters kept from before the input, enough for the longest keyword checked
+// before '[', such as `typeof`, and the character before it
+#define PRECEDING_LENGTH 8
 
 /**
-    State wrapper
+    States of internal state machine:
+    * BEGIN_STATE - start parsing
+    * JSON_STATE - handle special characters: "[", "{", "}", "]", ",", ":"
+    * VALUE_STATE - handle a JSON value, such as strings and numbers
+    * END_STATE - finish work
+    * ERROR_STATE - finish work, mark an error
+    * SINGLE_VALUE_STATE - handle a value outside of any object, then finish work
 */
-struct State {
-    struct State* (*change)(struct Parser *);
-};
+typedef enum {
+    BEGIN_STATE,
+    JSON_STATE,
+    VALUE_STATE,
+    END_STATE,
+    ERROR_STATE,
+    SINGLE_VALUE_STATE,
+} ParserState;
 
 /** Possible results of internal state machine state change state */
 typedef enum {
@@ -55,28 +44,120 @@ typedef enum {
     ERROR,
 } ParserStatus;
 
+/** Reason of ERROR status */
+typedef enum {
+    // input is not a valid object
+    INVALID_INPUT,
+    OUTPUT_LIMIT_EXCEEDED,
+    DEPTH_LIMIT_EXCEEDED,
+    OUT_OF_MEMORY,
+} ParserFailure;
+
+/**
+    Limits protecting against hostile or broken inputs. Output and depth
+    are limited for every object separately, SIZE_MAX means no limit
+*/
+struct ParserLimits {
+    size_t max_input_bytes;
+    size_t max_output_bytes;
+    size_t max_depth;
+};
+
+/** Limits of a parser that was just initialized */
+extern const struct ParserLimits no_limits;
+
+/** Kinds of tokens written into output buffer */
+typedef enum {
+    TOKEN_OBJECT_START,
+    TOKEN_OBJECT_END,
+    TOKEN_ARRAY_START,
+    TOKEN_ARRAY_END,
+    TOKEN_COLON,
+    TOKEN_COMMA,
+    TOKEN_VALUE,
+} TokenType;
+
+/**
+    Optional receiver of tokens written into output buffer. Token data points
+    into output buffer and is only valid during the call. Values are reported
+    in their JSON form: quoted strings, numbers or true/false/null/NaN.
+    Returning false stops parsing with an error. When `consumes_values` is set,
+    output buffer space taken by a value is reused once it's reported.
+*/
+struct TokenSink {
+    bool (*handle)(void* context, TokenType type, const char* data, size_t length);
+    void* context;
+    bool consumes_values;
+};
+
 /** Main object, responsible for everything */
 struct Parser {
     const char* input;
+    size_t input_length;
+    char* unescaped_input;
+    size_t unescaped_capacity;
     size_t output_size;
     struct CharBuffer output;
     size_t input_position;
     ParserStatus parser_status;
-    struct State* state;
+    ParserState state;
     struct CharBuffer nesting_depth;
     size_t unrecognized_nesting_depth;
     bool is_key;
+    struct TokenSink* sink;
+    // position of the first character of the current object
+    size_t object_start;
+    // output of the current object differs from its input
+    bool rewritten;
+    // characters just before the input, when it's a part of a bigger text, '\0' otherwise.
+    // The last one is right before the input
+    char preceding[PRECEDING_LENGTH];
+    // current object was accepted without being checked, because the input
+    // ended too early. More input might show that it's not an object
+    bool candidate_cut;
+    // kept when input is reset, checking input size is left to the caller
+    struct ParserLimits limits;
+    ParserFailure failure;
+    // length of output of the current object, including values consumed by the sink
+    size_t object_output_length;
+#ifdef CHOMPJS_STATS
+    struct ParserStats stats;
+#endif
 };
 
-/** Switch state of internal state machine */
+/** Run internal state machine until the current object is finished or an error occurs */
 void advance(struct Parser* parser);
 
+/**
+    Same as `advance`, but stop between states once the input position reaches
+    `stop`. A single state, such as a long string, can go past it
+*/
+void advance_until(struct Parser* parser, size_t stop);
+
+/**
+    Same as `advance_until`, but also stop between states once `monotonic_ns`
+    reaches `deadline`. Clock is checked after every kilobyte of input or so
+*/
+void advance_until_deadline(struct Parser* parser, size_t stop, uint64_t deadline);
+
+/** Get char at given offset from current input position, '\0' past the end of input */
+char peek(struct Parser* parser, size_t offset);
+
+/** Check if input at current position starts with given string */
+bool matches(struct Parser* parser, const char* s, size_t length);
+
 /** Get next char, ignore whitespaces */
 char next_char(struct Parser* parser);
 
 /** Get previously handled char */
 char last_char(struct Parser* parser);
 
+/**
+    Functions sending data to output buffer never write past `max_output_bytes`
+    limit or when memory can't be allocated. Parser fails once it gets back
+    to the main loop then, input position is advanced as usual
+*/
+
 /** Send character to output buffer, advance input position */
 void emit(char c, struct Parser* parser);
 
@@ -92,18 +173,66 @@ void emit_string(const char *s, size_t size, struct Parser* parser);
 /** Send string to output buffer, keep old input position */
 void emit_string_in_place(const char *s, size_t size, struct Parser* parser);
 
-/** Send number to output buffer, keep old input position */
-void emit_number_in_place(long value, struct Parser* parser);
+/**
+    Send decimal form of an integer given by its digits in base 2, 8 or 16 to output
+    buffer, keep old input position. False if the number is too big
+*/
+bool emit_integer_in_place(const char* digits, size_t count, int base, struct Parser* parser);
+
+/**
+    Report token written into output buffer since `start` position to token sink.
+    False if the sink rejects it, or if writing the token failed
+*/
+bool report(struct Parser* parser, TokenType type, size_t start);
 
 /** Handle comments in JSON body */
 void handle_comments(struct Parser* parser);
 
-/** Initialize main parser object */
-void init_parser(struct Parser* parser, const char* string);
+/** Initialize main parser object, input doesn't need to be NUL-terminated */
+void init_parser(struct Parser* parser, const char* string, size_t length);
+
+/**
+    Decode Python-style escape sequences of the input before parsing it.
+    False if memory can't be allocated, parser fails with OUT_OF_MEMORY then
+*/
+bool unescape_input(struct Parser* parser);
+
+/**
+    Start parsing at given input position, at a value of any type, not only
+    at an object or an array
+*/
+void start_at_value(struct Parser* parser, size_t position);
+
+/**
+    Find position of the first object of the input the same way parsing
+    does, without parsing it. False if there's none. Parser state is left
+    as it was
+*/
+bool find_object(struct Parser* parser, size_t* position);
+
+/**
+    Append characters to a `preceding` lookbehind, only the last PRECEDING_LENGTH
+    of them are kept
+*/
+void append_preceding(char* preceding, const char* data, size_t length);
+
+/** Point parser to a new input, buffers allocated so far are reused */
+void reset_parser_input(struct Parser* parser, const char* string, size_t length);
 
 /** Reset main parser object output buffer */
 void reset_parser_output(struct Parser* parser);
 
+/** Continue with the next object, output of previous ones is kept */
+void start_next_object(struct Parser* parser);
+
+/** Zero statistics counters, done whenever parser gets a new input */
+void reset_parser_stats(struct Parser* parser);
+
+#ifdef CHOMPJS_STATS
+/** Finish counting statistics of the current input and return them */
+const struct ParserStats* collect_parser_stats(struct Parser* parser);
+#endif
+
 /** Release main parser object and its memory */
 void release_parser(struct Parser* parser);
 
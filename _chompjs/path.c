@@ -0,0 +1,356 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#include "path.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_INDEX_DIGITS 18
+
+/** Read next segment of the path, return position after it or NULL on syntax error */
+static const char* read_segment(
+    const char* s, const char* end, bool first, struct PathSegment* segment, char** keys
+) {
+    if(*s == '[') {
+        s += 1;
+        if(s < end && (*s == '"' || *s == '\'')) {
+            // quoted key, backslash escapes the next character
+            char quote = *s++;
+            char* out = *keys;
+            segment->key = out;
+            while(s < end && *s != quote) {
+                if(*s == '\\' && s + 1 < end) {
+                    s += 1;
+                }
+                *out++ = *s++;
+            }
+            if(s >= end) {
+                return NULL;
+            }
+            segment->key_length = out - segment->key;
+            *keys = out;
+            s += 1;
+        } else {
+            segment->key = s;
+            while(s < end && isdigit((unsigned char)*s)) {
+                s += 1;
+            }
+            segment->key_length = s - segment->key;
+            if(segment->key_length == 0) {
+                return NULL;
+            }
+        }
+        if(s >= end || *s != ']') {
+            return NULL;
+        }
+        return s + 1;
+    }
+
+    if(!first) {
+        if(*s != '.') {
+            return NULL;
+        }
+        s += 1;
+    }
+    segment->key = s;
+    while(s < end && *s != '.' && *s != '[') {
+        s += 1;
+    }
+    segment->key_length = s - segment->key;
+    return segment->key_length > 0 ? s : NULL;
+}
+
+static void read_index(struct PathSegment* segment) {
+    segment->has_index = segment->key_length > 0 && segment->key_length <= MAX_INDEX_DIGITS;
+    segment->index = 0;
+    for(size_t i = 0; segment->has_index && i < segment->key_length; ++i) {
+        char c = segment->key[i];
+        if(!isdigit((unsigned char)c)) {
+            segment->has_index = false;
+        }
+        segment->index = segment->index * 10 + (c - '0');
+    }
+}
+
+bool parse_path(struct Path* path, const char* string, size_t length) {
+    const char* end = string + length;
+    path->count = 0;
+    path->segments = malloc((length + 1) * sizeof(struct PathSegment));
+    path->keys = malloc(length + 1);
+    if(path->segments == NULL || path->keys == NULL) {
+        release_path(path);
+        return false;
+    }
+
+    char* keys = path->keys;
+    const char* s = string;
+    while(s < end) {
+        struct PathSegment* segment = &path->segments[path->count];
+        s = read_segment(s, end, path->count == 0, segment, &keys);
+        if(s == NULL) {
+            release_path(path);
+            return false;
+        }
+        read_index(segment);
+        path->count += 1;
+    }
+    if(path->count == 0) {
+        release_path(path);
+        return false;
+    }
+    return true;
+}
+
+void release_path(struct Path* path) {
+    free(path->segments);
+    free(path->keys);
+    path->segments = NULL;
+    path->keys = NULL;
+    path->count = 0;
+}
+
+/** Skip whitespaces and comments */
+static const char* skip_space(const char* p, const char* end) {
+    for(;;) {
+        while(p < end && isspace((unsigned char)*p)) {
+            p += 1;
+        }
+        if(end - p < 2 || p[0] != '/') {
+            return p;
+        }
+        if(p[1] == '/') {
+            const char* line_end = memchr(p, '\n', end - p);
+            p = line_end != NULL ? line_end : end;
+        } else if(p[1] == '*') {
+            p += 2;
+            while(p < end && !(p[0] == '*' && p + 1 < end && p[1] == '/')) {
+                p += 1;
+            }
+            p = p < end ? p + 2 : end;
+        } else {
+            return p;
+        }
+    }
+}
+
+/** Skip quoted string starting at `p`, return position after closing quote */
+static const char* skip_quoted(const char* p, const char* end) {
+    char quote = *p++;
+    while(p < end && *p != quote) {
+        p += *p == '\\' ? 2 : 1;
+    }
+    return p < end ? p + 1 : end;
+}
+
+/** Skip a value of any type, return position of ',' or closing bracket after it */
+static const char* skip_value(const char* p, const char* end) {
+    size_t depth = 0;
+    while(p < end) {
+        switch(*p) {
+            case '"':
+            case '\'':
+            case '`':
+                p = skip_quoted(p, end);
+            continue;
+            case '/':
+                if(end - p >= 2 && (p[1] == '/' || p[1] == '*')) {
+                    p = skip_space(p, end);
+                    continue;
+                }
+            break;
+            case '{':
+            case '[':
+            case '(':
+                depth += 1;
+            break;
+            case '}':
+            case ']':
+            case ')':
+                if(depth == 0) {
+                    return p;
+                }
+                depth -= 1;
+            break;
+            case ',':
+                if(depth == 0) {
+                    return p;
+                }
+            break;
+        }
+        p += 1;
+    }
+    return end;
+}
+
+static bool key_matches(const char* key, size_t length, const struct PathSegment* segment) {
+    size_t matched = 0;
+    for(size_t i = 0; i < length; ++i, ++matched) {
+        if(key[i] == '\\' && i + 1 < length) {
+            i += 1;
+        }
+        if(matched >= segment->key_length || key[i] != segment->key[matched]) {
+            return false;
+        }
+    }
+    return matched == segment->key_length;
+}
+
+/** Find value of the key in object starting after `p`, the last one wins as in json.loads */
+static const char* find_in_object(const char* p, const char* end, const struct PathSegment* segment) {
+    const char* found = NULL;
+    p += 1;
+    for(;;) {
+        p = skip_space(p, end);
+        if(p >= end) {
+            return NULL;
+        } else if(*p == '}') {
+            return found;
+        }
+
+        const char* key = p;
+        size_t key_length;
+        if(*p == '"' || *p == '\'' || *p == '`') {
+            p = skip_quoted(p, end);
+            key += 1;
+            key_length = p - key - 1;
+        } else {
+            while(p < end && *p != ':' && *p != ',' && *p != '}') {
+                p += 1;
+            }
+            key_length = p - key;
+            while(key_length > 0 && isspace((unsigned char)key[key_length - 1])) {
+                key_length -= 1;
+            }
+        }
+
+        p = skip_space(p, end);
+        if(p >= end || *p != ':') {
+            return NULL;
+        }
+        p = skip_space(p + 1, end);
+        if(key_matches(key, key_length, segment)) {
+            found = p;
+        }
+        p = skip_value(p, end);
+        if(p < end && *p == ',') {
+            p += 1;
+        }
+    }
+}
+
+/** Find element of array starting at `p` */
+static const char* find_in_array(const char* p, const char* end, const struct PathSegment* segment) {
+    p += 1;
+    for(size_t index = 0; ; ++index) {
+        p = skip_space(p, end);
+        if(p >= end || *p == ']') {
+            return NULL;
+        }
+        if(index == segment->index) {
+            return p;
+        }
+        p = skip_value(p, end);
+        if(p >= end || *p != ',') {
+            return NULL;
+        }
+        p += 1;
+    }
+}
+
+bool locate_path(const struct Path* path, const char* input, size_t length, size_t root, size_t* position) {
+    const char* end = input + length;
+    const char* p = input + root;
+    for(size_t i = 0; p != NULL && i < path->count; ++i) {
+        const struct PathSegment* segment = &path->segments[i];
+        p = skip_space(p, end);
+        if(p >= end) {
+            return false;
+        } else if(*p == '{') {
+            p = find_in_object(p, end, segment);
+        } else if(*p == '[' && segment->has_index) {
+            p = find_in_array(p, end, segment);
+        } else {
+            return false;
+        }
+    }
+    if(p == NULL) {
+        return false;
+    }
+    *position = p - input;
+    return true;
+}
+
+bool init_item_scanner(struct ItemScanner* scanner, const char* input, size_t length, size_t position) {
+    scanner->input = input;
+    scanner->end = input + length;
+    const char* p = skip_space(input + position, scanner->end);
+    if(p >= scanner->end || (*p != '{' && *p != '[')) {
+        return false;
+    }
+    scanner->is_object = *p == '{';
+    scanner->position = p + 1;
+    scanner->started = false;
+    scanner->finished = false;
+    scanner->failed = false;
+    return true;
+}
+
+/** Stop scanning, input is malformed at `p` */
+static bool fail_scanner(struct ItemScanner* scanner, const char* p) {
+    scanner->position = p;
+    scanner->finished = true;
+    scanner->failed = true;
+    return false;
+}
+
+bool next_item(struct ItemScanner* scanner, const char** item) {
+    if(scanner->finished) {
+        return false;
+    }
+    const char* p = skip_space(scanner->position, scanner->end);
+    // lone ',' is accepted as an empty body, such as `[,]`, same as in the parser
+    if(!scanner->started && p < scanner->end && *p == ',') {
+        const char* close = skip_space(p + 1, scanner->end);
+        if(close >= scanner->end || (*close != '}' && *close != ']')) {
+            return fail_scanner(scanner, p);
+        }
+        p = close;
+    }
+    if(p >= scanner->end || *p == ',') {
+        return fail_scanner(scanner, p);
+    }
+    // closing bracket doesn't need to match, same as in the parser
+    if(*p == '}' || *p == ']') {
+        scanner->position = p;
+        scanner->finished = true;
+        return false;
+    }
+    scanner->started = true;
+    *item = p;
+    return true;
+}
+
+bool skip_key(struct ItemScanner* scanner, const char* position, const char** value) {
+    const char* p = skip_space(position, scanner->end);
+    if(p >= scanner->end || *p != ':') {
+        return fail_scanner(scanner, p);
+    }
+    *value = skip_space(p + 1, scanner->end);
+    return true;
+}
+
+bool skip_item(struct ItemScanner* scanner, const char* position) {
+    const char* p = skip_space(position, scanner->end);
+    if(p < scanner->end && *p == ',') {
+        scanner->position = p + 1;
+        return true;
+    } else if(p < scanner->end && (*p == '}' || *p == ']')) {
+        scanner->position = p;
+        return true;
+    }
+    return fail_scanner(scanner, p);
+}
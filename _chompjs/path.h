@@ -0,0 +1,78 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#ifndef CHOMPJS_PATH_H
+#define CHOMPJS_PATH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+    Single step of a path: object key or array index. Keys consisting
+    only of digits are used as indexes when the container is an array
+*/
+struct PathSegment {
+    const char* key;
+    size_t key_length;
+    size_t index;
+    bool has_index;
+};
+
+/**
+    Path to a value inside of an object, such as `props.pageProps.product`,
+    `items[0].name` or `data["key.with.dots"]`
+*/
+struct Path {
+    struct PathSegment* segments;
+    size_t count;
+    char* keys;
+};
+
+/** Parse path string, false if its syntax is invalid */
+bool parse_path(struct Path* path, const char* string, size_t length);
+
+/** Release memory held by the path */
+void release_path(struct Path* path);
+
+/**
+    Find position of a value selected by the path inside of the object starting
+    at `root`, found with `find_object`. Only brackets and quotes are counted
+    in skipped values, nothing is emitted. False if the path doesn't exist
+*/
+bool locate_path(const struct Path* path, const char* input, size_t length, size_t root, size_t* position);
+
+/**
+    Walks over elements of an array or members of an object, one at a time.
+    Scanner only finds where keys and values start, they are parsed by
+    the caller, which then tells the scanner where they end
+*/
+struct ItemScanner {
+    const char* input;
+    const char* position;
+    const char* end;
+    bool is_object;
+    // some element or member was found already
+    bool started;
+    bool finished;
+    // input is malformed at `position`
+    bool failed;
+};
+
+/** Start at the array or object at given position of the input, false if there's none */
+bool init_item_scanner(struct ItemScanner* scanner, const char* input, size_t length, size_t position);
+
+/**
+    Find start of the next element of an array, or of the key of the next member
+    of an object. False when there are no more of them, or if input is malformed
+*/
+bool next_item(struct ItemScanner* scanner, const char** item);
+
+/** Continue after a key ending at `position`, find start of its value */
+bool skip_key(struct ItemScanner* scanner, const char* position, const char** value);
+
+/** Continue after a value ending at `position`, false if it's not followed by ',' or a closing bracket */
+bool skip_item(struct ItemScanner* scanner, const char* position);
+
+#endif
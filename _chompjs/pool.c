@@ -0,0 +1,97 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#include "pool.h"
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+typedef HANDLE ThreadHandle;
+#else
+#include <pthread.h>
+typedef pthread_t ThreadHandle;
+#endif
+
+struct Pool {
+    size_t count;
+    size_t next;
+    ParallelTask task;
+    void* context;
+};
+
+static size_t take_index(struct Pool* pool) {
+#ifdef _WIN32
+    return (size_t)InterlockedExchangeAdd64((volatile LONG64*)&pool->next, 1);
+#else
+    return __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+static void work(struct Pool* pool) {
+    for(;;) {
+        size_t index = take_index(pool);
+        if(index >= pool->count) {
+            return;
+        }
+        pool->task(pool->context, index);
+    }
+}
+
+#ifdef _WIN32
+static unsigned __stdcall worker_main(void* pool) {
+    work(pool);
+    return 0;
+}
+
+static int start_thread(ThreadHandle* thread, struct Pool* pool) {
+    *thread = (HANDLE)_beginthreadex(NULL, 0, worker_main, pool, 0, NULL);
+    return *thread != 0;
+}
+
+static void join_thread(ThreadHandle thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#else
+static void* worker_main(void* pool) {
+    work(pool);
+    return NULL;
+}
+
+static int start_thread(ThreadHandle* thread, struct Pool* pool) {
+    return pthread_create(thread, NULL, worker_main, pool) == 0;
+}
+
+static void join_thread(ThreadHandle thread) {
+    pthread_join(thread, NULL);
+}
+#endif
+
+void run_parallel(size_t count, size_t workers, ParallelTask task, void* context) {
+    struct Pool pool = {count, 0, task, context};
+    if(workers > count) {
+        workers = count;
+    }
+
+    ThreadHandle* threads = NULL;
+    size_t started = 0;
+    if(workers > 1) {
+        threads = malloc((workers - 1) * sizeof(ThreadHandle));
+    }
+    while(threads != NULL && started < workers - 1) {
+        if(!start_thread(&threads[started], &pool)) {
+            break;
+        }
+        started += 1;
+    }
+
+    work(&pool);
+    for(size_t i = 0; i < started; ++i) {
+        join_thread(threads[i]);
+    }
+    free(threads);
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#ifndef CHOMPJS_POOL_H
+#define CHOMPJS_POOL_H
+
+#include <stddef.h>
+
+/** Task run for a single index */
+typedef void (*ParallelTask)(void* context, size_t index);
+
+/**
+    Run `task` for every index in [0, count) on up to `workers` native
+    threads, calling thread included. Returns once all tasks are done.
+    Tasks are taken in increasing order, but can finish in any order.
+    Falls back to running everything in calling thread if threads
+    can't be started
+*/
+void run_parallel(size_t count, size_t workers, ParallelTask task, void* context);
+
+#endif
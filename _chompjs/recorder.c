@@ -0,0 +1,69 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#include "recorder.h"
+
+#include <stdlib.h>
+
+#define INITIAL_RECORDED_TOKENS 64
+
+static bool record_token(void* context, TokenType type, const char* data, size_t length) {
+    struct TokenRecorder* recorder = context;
+    if(recorder->count == recorder->capacity) {
+        size_t capacity = recorder->capacity ? 2 * recorder->capacity : INITIAL_RECORDED_TOKENS;
+        struct RecordedToken* tokens = realloc(
+            recorder->tokens, capacity * sizeof(struct RecordedToken)
+        );
+        if(tokens == NULL) {
+            return false;
+        }
+        recorder->tokens = tokens;
+        recorder->capacity = capacity;
+    }
+    // output buffer can be reallocated later, keep offsets instead of pointers
+    struct RecordedToken* token = &recorder->tokens[recorder->count];
+    token->type = type;
+    token->start = data - recorder->parser->output.data;
+    token->length = length;
+    recorder->count += 1;
+    return true;
+}
+
+void init_token_recorder(struct TokenRecorder* recorder, struct Parser* parser) {
+    recorder->parser = parser;
+    recorder->tokens = NULL;
+    recorder->count = 0;
+    recorder->capacity = 0;
+    recorder->sink.handle = record_token;
+    recorder->sink.context = recorder;
+    recorder->sink.consumes_values = false;
+    parser->sink = &recorder->sink;
+}
+
+bool replay_tokens(struct TokenRecorder* recorder, struct TokenSink* sink) {
+    return replay_token_range(recorder, sink, 0, recorder->count);
+}
+
+bool replay_token_range(
+    struct TokenRecorder* recorder, struct TokenSink* sink, size_t first, size_t last
+) {
+    const char* output = recorder->parser->output.data;
+    for(size_t i = first; i < last; ++i) {
+        struct RecordedToken* token = &recorder->tokens[i];
+        if(!sink->handle(sink->context, token->type, output + token->start, token->length)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void clear_token_recorder(struct TokenRecorder* recorder) {
+    recorder->count = 0;
+}
+
+void release_token_recorder(struct TokenRecorder* recorder) {
+    free(recorder->tokens);
+    recorder->tokens = NULL;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#ifndef CHOMPJS_RECORDER_H
+#define CHOMPJS_RECORDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "parser.h"
+
+/** Token position inside parser output buffer */
+struct RecordedToken {
+    TokenType type;
+    size_t start;
+    size_t length;
+};
+
+/**
+    Records tokens reported by the parser, so they can be handed to another
+    token sink later, for example once GIL is acquired. Doesn't use Python API,
+    can be used from any thread
+*/
+struct TokenRecorder {
+    struct Parser* parser;
+    struct RecordedToken* tokens;
+    size_t count;
+    size_t capacity;
+    struct TokenSink sink;
+};
+
+/** Initialize recorder and attach it to the parser */
+void init_token_recorder(struct TokenRecorder* recorder, struct Parser* parser);
+
+/** Report all recorded tokens to the sink, false if it stopped */
+bool replay_tokens(struct TokenRecorder* recorder, struct TokenSink* sink);
+
+/** Report tokens in range [first, last) to the sink, false if it stopped */
+bool replay_token_range(
+    struct TokenRecorder* recorder, struct TokenSink* sink, size_t first, size_t last
+);
+
+/** Forget recorded tokens, memory is kept */
+void clear_token_recorder(struct TokenRecorder* recorder);
+
+/** Release recorder memory */
+void release_token_recorder(struct TokenRecorder* recorder);
+
+#endif
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#include "scan.h"
+
+#include <stdbool.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CHOMPJS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(CHOMPJS_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define CHOMPJS_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+typedef size_t (*whitespace_kernel)(const char* s, const char* end);
+typedef size_t (*any_kernel)(const char* s, const char* end, char a, char b, char c, char d);
+
+static whitespace_kernel whitespace_impl = NULL;
+static any_kernel any_impl = NULL;
+
+static inline bool is_whitespace(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static size_t scan_whitespace_scalar(const char* s, const char* end) {
+    const char* p = s;
+    while(p < end && is_whitespace(*p)) {
+        p += 1;
+    }
+    return p - s;
+}
+
+static size_t scan_any_scalar(const char* s, const char* end, char a, char b, char c, char d) {
+    const char* p = s;
+    while(p < end && *p != a && *p != b && *p != c && *p != d) {
+        p += 1;
+    }
+    return p - s;
+}
+
+#ifdef CHOMPJS_SSE2
+static inline unsigned first_set(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+static size_t scan_whitespace_sse2(const char* s, const char* end) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i range = _mm_set1_epi8('\r' - '\t');
+    const char* p = s;
+    while(end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        // '\t' - '\r' range check done as a single unsigned comparison
+        __m128i shifted = _mm_sub_epi8(v, tab);
+        __m128i in_range = _mm_cmpeq_epi8(_mm_min_epu8(shifted, range), shifted);
+        __m128i whitespace = _mm_or_si128(_mm_cmpeq_epi8(v, space), in_range);
+        unsigned mask = ~_mm_movemask_epi8(whitespace) & 0xFFFF;
+        if(mask) {
+            return p - s + first_set(mask);
+        }
+        p += 16;
+    }
+    return p - s + scan_whitespace_scalar(p, end);
+}
+
+static size_t scan_any_sse2(const char* s, const char* end, char a, char b, char c, char d) {
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    const __m128i vc = _mm_set1_epi8(c);
+    const __m128i vd = _mm_set1_epi8(d);
+    const char* p = s;
+    while(end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        __m128i found = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, vc), _mm_cmpeq_epi8(v, vd))
+        );
+        unsigned mask = _mm_movemask_epi8(found);
+        if(mask) {
+            return p - s + first_set(mask);
+        }
+        p += 16;
+    }
+    return p - s + scan_any_scalar(p, end, a, b, c, d);
+}
+#endif
+
+#ifdef CHOMPJS_AVX2
+__attribute__((target("avx2")))
+static size_t scan_whitespace_avx2(const char* s, const char* end) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i range = _mm256_set1_epi8('\r' - '\t');
+    const char* p = s;
+    while(end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        __m256i shifted = _mm256_sub_epi8(v, tab);
+        __m256i in_range = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, range), shifted);
+        __m256i whitespace = _mm256_or_si256(_mm256_cmpeq_epi8(v, space), in_range);
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(whitespace);
+        if(mask) {
+            return p - s + first_set(mask);
+        }
+        p += 32;
+    }
+    return p - s + scan_whitespace_sse2(p, end);
+}
+
+__attribute__((target("avx2")))
+static size_t scan_any_avx2(const char* s, const char* end, char a, char b, char c, char d) {
+    const __m256i va = _mm256_set1_epi8(a);
+    const __m256i vb = _mm256_set1_epi8(b);
+    const __m256i vc = _mm256_set1_epi8(c);
+    const __m256i vd = _mm256_set1_epi8(d);
+    const char* p = s;
+    while(end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        __m256i found = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, vc), _mm256_cmpeq_epi8(v, vd))
+        );
+        unsigned mask = (unsigned)_mm256_movemask_epi8(found);
+        if(mask) {
+            return p - s + first_set(mask);
+        }
+        p += 32;
+    }
+    return p - s + scan_any_sse2(p, end, a, b, c, d);
+}
+#endif
+
+static void select_kernels(void) {
+    whitespace_kernel whitespace = scan_whitespace_scalar;
+    any_kernel any = scan_any_scalar;
+#ifdef CHOMPJS_SSE2
+    whitespace = scan_whitespace_sse2;
+    any = scan_any_sse2;
+#endif
+#ifdef CHOMPJS_AVX2
+    if(__builtin_cpu_supports("avx2")) {
+        whitespace = scan_whitespace_avx2;
+        any = scan_any_avx2;
+    }
+#endif
+    any_impl = any;
+    whitespace_impl = whitespace;
+}
+
+void init_scan_kernels(void) {
+    if(any_impl == NULL) {
+        select_kernels();
+    }
+}
+
+size_t scan_whitespace(const char* s, const char* end) {
+    // most whitespace runs are short, don't bother with the kernel for them
+    if(s >= end || !is_whitespace(*s)) {
+        return 0;
+    }
+    if(whitespace_impl == NULL) {
+        select_kernels();
+    }
+    return whitespace_impl(s, end);
+}
+
+size_t scan_quoted(const char* s, const char* end, char quote) {
+    if(any_impl == NULL) {
+        select_kernels();
+    }
+    return any_impl(s, end, quote, '"', '\\', '\0');
+}
+
+size_t scan_until(const char* s, const char* end, char c) {
+    if(any_impl == NULL) {
+        select_kernels();
+    }
+    return any_impl(s, end, c, c, '\0', '\0');
+}
+
+size_t scan_candidates(const char* s, const char* end) {
+    if(any_impl == NULL) {
+        select_kernels();
+    }
+    return any_impl(s, end, '{', '[', '/', '\0');
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#ifndef CHOMPJS_SCAN_H
+#define CHOMPJS_SCAN_H
+
+#include <stddef.h>
+
+/**
+    Scanning kernels used in hot loops of the parser. Vectorized versions
+    (SSE2, AVX2) are selected at runtime on x86-64, with scalar fallback
+    used everywhere else. All of them read only from [s, end) range and
+    return length of a scanned run.
+*/
+
+/**
+    Select kernels for the current CPU. Without it they are selected
+    on first use, which isn't safe if threads are already parsing
+*/
+void init_scan_kernels(void);
+
+/** Length of whitespace run at the beginning of the range */
+size_t scan_whitespace(const char* s, const char* end);
+
+/** Length of run not containing `quote`, '"', '\\' or '\0' */
+size_t scan_quoted(const char* s, const char* end, char quote);
+
+/** Length of run not containing `c` or '\0' */
+size_t scan_until(const char* s, const char* end, char c);
+
+/** Length of run not containing '{', '[', '/' or '\0', where an object or a comment might start */
+size_t scan_candidates(const char* s, const char* end);
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#include "stats.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+uint64_t monotonic_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+#ifdef CHOMPJS_STATS
+
+size_t size_bucket_limit(size_t bucket) {
+    if(bucket + 1 >= SIZE_BUCKETS) {
+        return 0;
+    }
+    // 1KB, 16KB, 256KB, 4MB, 64MB
+    return (size_t)1024 << (4 * bucket);
+}
+
+static size_t size_bucket(size_t input_length) {
+    size_t bucket = 0;
+    while(bucket + 1 < SIZE_BUCKETS && input_length >= size_bucket_limit(bucket)) {
+        bucket += 1;
+    }
+    return bucket;
+}
+
+static size_t latency_bucket(uint64_t nanoseconds) {
+    uint64_t microseconds = nanoseconds / 1000;
+    size_t bucket = 0;
+    while(bucket + 1 < LATENCY_BUCKETS && microseconds >= 2) {
+        microseconds /= 2;
+        bucket += 1;
+    }
+    return bucket;
+}
+
+void record_call(
+    struct ModuleStats* module_stats, const struct ParserStats* stats, size_t input_length,
+    uint64_t nanoseconds
+) {
+    struct SizeBucket* bucket = &module_stats->buckets[size_bucket(input_length)];
+    bucket->calls += 1;
+    bucket->bytes += input_length;
+    bucket->nanoseconds += nanoseconds;
+    bucket->latency[latency_bucket(nanoseconds)] += 1;
+
+    struct ParserStats* totals = &module_stats->totals;
+    totals->bytes_scanned += stats->bytes_scanned;
+    totals->bytes_emitted += stats->bytes_emitted;
+    totals->output_growths += stats->output_growths;
+    if(stats->peak_depth > totals->peak_depth) {
+        totals->peak_depth = stats->peak_depth;
+    }
+    totals->unrecognized_values += stats->unrecognized_values;
+    totals->quoted_values += stats->quoted_values;
+    totals->numeric_values += stats->numeric_values;
+    totals->comments += stats->comments;
+}
+
+#endif
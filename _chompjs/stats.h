@@ -0,0 +1,79 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#ifndef CHOMPJS_STATS_H
+#define CHOMPJS_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Monotonic clock, in nanoseconds */
+uint64_t monotonic_ns(void);
+
+/**
+    Parser statistics, collected only when built with CHOMPJS_STATS defined:
+
+    $ CHOMPJS_STATS=1 python setup.py build_ext --inplace
+
+    Without it counters don't exist and STAT_* macros expand to nothing
+*/
+#ifdef CHOMPJS_STATS
+
+/** Counters of a single call */
+struct ParserStats {
+    size_t bytes_scanned;
+    size_t bytes_emitted;
+    size_t output_growths;
+    size_t peak_depth;
+    size_t unrecognized_values;
+    size_t quoted_values;
+    size_t numeric_values;
+    size_t comments;
+};
+
+#define STAT_ADD(parser, counter, value) ((parser)->stats.counter += (value))
+#define STAT_MAX(parser, counter, value) do { \
+        size_t stat_value_ = (value); \
+        if(stat_value_ > (parser)->stats.counter) { \
+            (parser)->stats.counter = stat_value_; \
+        } \
+    } while(0)
+
+// inputs are bucketed by size: below 1KB, 16KB, 256KB, 4MB, 64MB and larger
+#define SIZE_BUCKETS 6
+// latencies are bucketed by powers of two of microseconds
+#define LATENCY_BUCKETS 24
+
+/** Aggregated calls of inputs of similar size */
+struct SizeBucket {
+    size_t calls;
+    uint64_t bytes;
+    uint64_t nanoseconds;
+    size_t latency[LATENCY_BUCKETS];
+};
+
+/** Statistics of all calls made so far */
+struct ModuleStats {
+    struct SizeBucket buckets[SIZE_BUCKETS];
+    struct ParserStats totals;
+};
+
+/** Add a finished call to aggregated statistics */
+void record_call(
+    struct ModuleStats* module_stats, const struct ParserStats* stats, size_t input_length,
+    uint64_t nanoseconds
+);
+
+/** Upper bound of input size of a bucket, 0 for the last one */
+size_t size_bucket_limit(size_t bucket);
+
+#else
+
+#define STAT_ADD(parser, counter, value) ((void)0)
+#define STAT_MAX(parser, counter, value) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,440 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#include "tape.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_TAPE_DEPTH 16
+#define INITIAL_TAPE_SIZE 64
+#define INITIAL_ARENA_SIZE 1024
+#define ENTRY_INPUT_RATIO 8
+// strings up to this length are looked up in a direct-mapped table and stored once,
+// a colliding string replaces the old one
+#define MAX_SHARED_LENGTH 32
+#define SHARED_STRINGS_SIZE 1024
+#define NO_SHARED_STRING SIZE_MAX
+
+/** Position inside currently written container, same as in the builder */
+enum LevelState {
+    EXPECT_FIRST, EXPECT_NEXT, EXPECT_CLOSE, AFTER_VALUE, AFTER_KEY, EXPECT_VALUE
+};
+
+static bool write_token(void* context, TokenType type, const char* data, size_t length);
+
+static bool is_hex(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+/** Check body of JSON string the way the builder decodes it, tell if it has escape sequences */
+static bool check_string(const char* s, size_t length, bool* escaped) {
+    *escaped = false;
+    for(size_t i = 0; i < length; ++i) {
+        unsigned char c = s[i];
+        if(c < 0x20) {
+            return false;
+        } else if(c != '\\') {
+            continue;
+        }
+        *escaped = true;
+        if(i + 1 >= length) {
+            return false;
+        }
+        i += 1;
+        switch(s[i]) {
+            case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+            break;
+            case 'u':
+                if(i + 4 >= length || !is_hex(s[i+1]) || !is_hex(s[i+2])
+                        || !is_hex(s[i+3]) || !is_hex(s[i+4])) {
+                    return false;
+                }
+                i += 4;
+            break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+/** Check JSON number syntax, NaN is accepted as well */
+static bool check_number(const char* s, size_t length) {
+    if(length == 3 && memcmp(s, "NaN", 3) == 0) {
+        return true;
+    }
+    size_t i = 0;
+    if(i < length && s[i] == '-') {
+        i += 1;
+    }
+    if(i < length && s[i] == '0') {
+        i += 1;
+    } else if(i < length && is_digit(s[i])) {
+        while(i < length && is_digit(s[i])) {
+            i += 1;
+        }
+    } else {
+        return false;
+    }
+    if(i < length && s[i] == '.') {
+        i += 1;
+        if(i >= length || !is_digit(s[i])) {
+            return false;
+        }
+        while(i < length && is_digit(s[i])) {
+            i += 1;
+        }
+    }
+    if(i < length && (s[i] == 'e' || s[i] == 'E')) {
+        i += 1;
+        if(i < length && (s[i] == '+' || s[i] == '-')) {
+            i += 1;
+        }
+        if(i >= length || !is_digit(s[i])) {
+            return false;
+        }
+        while(i < length && is_digit(s[i])) {
+            i += 1;
+        }
+    }
+    return i == length;
+}
+
+/** Append an entry to the tape, NULL if memory can't be allocated */
+static struct TapeEntry* push_entry(struct TapeWriter* writer, TapeType type) {
+    struct Tape* tape = &writer->tape;
+    if(tape->count == tape->capacity) {
+        size_t capacity = tape->capacity ? 2 * tape->capacity : INITIAL_TAPE_SIZE;
+        struct TapeEntry* entries = realloc(tape->entries, capacity * sizeof(struct TapeEntry));
+        if(entries == NULL) {
+            writer->out_of_memory = true;
+            return NULL;
+        }
+        tape->entries = entries;
+        tape->capacity = capacity;
+    }
+    struct TapeEntry* entry = &tape->entries[tape->count];
+    entry->position = 0;
+    entry->type = type;
+    entry->escaped = false;
+    tape->count += 1;
+    return entry;
+}
+
+/** Move container state after a value was added to it, false if it's not expected there */
+static bool add_value(struct TapeWriter* writer, bool is_string) {
+    if(writer->depth == 0) {
+        // only a single value is allowed at the top level
+        return writer->tape.count == 0;
+    }
+    struct TapeLevel* level = &writer->levels[writer->depth - 1];
+    if(level->state == EXPECT_FIRST || level->state == EXPECT_NEXT) {
+        if(level->type == TAPE_ARRAY) {
+            level->state = AFTER_VALUE;
+        } else if(is_string) {
+            level->state = AFTER_KEY;
+        } else {
+            return false;
+        }
+    } else if(level->state == EXPECT_VALUE) {
+        level->state = AFTER_VALUE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/** Append length and text of a value to the arena, return its offset */
+static bool append_text(struct CharBuffer* arena, const char* data, size_t length, size_t* offset) {
+    // length takes at most 10 bytes
+    if(!check_capacity(arena, length + 10)) {
+        return false;
+    }
+    *offset = arena->index;
+    unsigned char* out = (unsigned char*)arena->data + arena->index;
+    size_t value = length;
+    while(value >= 0x80) {
+        *out++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (unsigned char)value;
+    memcpy(out, data, length);
+    arena->index = (char*)out + length - arena->data;
+    return true;
+}
+
+/**
+    Hash of first and last 8 bytes of a short string, colliding strings
+    only replace each other in the table
+*/
+static inline uint32_t short_hash(const char* s, size_t length) {
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    memcpy(&head, s, length < 8 ? length : 8);
+    if(length > 8) {
+        memcpy(&tail, s + length - 8, 8);
+    }
+    uint64_t hash = head * 0x9E3779B185EBCA87ULL ^ (tail + length) * 0xC2B2AE3D27D4EB4FULL;
+    return (uint32_t)(hash >> 32);
+}
+
+/** Store text of a short string once, the same key is usually repeated in every object */
+static bool append_shared_text(struct TapeWriter* writer, const char* data, size_t length, size_t* offset) {
+    if(writer->shared_strings == NULL) {
+        writer->shared_strings = malloc(SHARED_STRINGS_SIZE * sizeof(size_t));
+        if(writer->shared_strings == NULL) {
+            return append_text(&writer->tape.arena, data, length, offset);
+        }
+        for(size_t i = 0; i < SHARED_STRINGS_SIZE; ++i) {
+            writer->shared_strings[i] = NO_SHARED_STRING;
+        }
+    }
+    size_t* slot = &writer->shared_strings[short_hash(data, length) & (SHARED_STRINGS_SIZE - 1)];
+    // short strings have a single byte of length
+    const char* arena = writer->tape.arena.data;
+    if(*slot != NO_SHARED_STRING && (unsigned char)arena[*slot] == length
+            && memcmp(arena + *slot + 1, data, length) == 0) {
+        *offset = *slot;
+        return true;
+    }
+    if(!append_text(&writer->tape.arena, data, length, offset)) {
+        return false;
+    }
+    *slot = *offset;
+    return true;
+}
+
+static bool write_value(struct TapeWriter* writer, const char* data, size_t length) {
+    TapeType type;
+    bool escaped = false;
+    switch(data[0]) {
+        case '"':
+            if(length < 2 || !check_string(data + 1, length - 2, &escaped)) {
+                return false;
+            }
+            type = TAPE_STRING;
+        break;
+        case 't':
+            type = TAPE_TRUE;
+        break;
+        case 'f':
+            type = TAPE_FALSE;
+        break;
+        case 'n':
+            type = TAPE_NULL;
+        break;
+        default:
+            if(!check_number(data, length)) {
+                return false;
+            }
+            type = TAPE_NUMBER;
+    }
+    if(!add_value(writer, type == TAPE_STRING)) {
+        return false;
+    }
+    if(writer->check_only) {
+        writer->tape.count += 1;
+        return true;
+    }
+    struct TapeEntry* entry = push_entry(writer, type);
+    if(entry == NULL) {
+        return false;
+    }
+    if(type == TAPE_STRING || type == TAPE_NUMBER) {
+        size_t offset;
+        bool appended = type == TAPE_STRING && length <= MAX_SHARED_LENGTH
+            ? append_shared_text(writer, data, length, &offset)
+            : append_text(&writer->tape.arena, data, length, &offset);
+        if(!appended) {
+            writer->out_of_memory = true;
+            return false;
+        }
+        entry->position = offset;
+        entry->escaped = escaped;
+    }
+    return true;
+}
+
+static bool open_container(struct TapeWriter* writer, TapeType type) {
+    if(!add_value(writer, false)) {
+        return false;
+    }
+    if(writer->depth == writer->capacity) {
+        size_t capacity = writer->capacity ? 2 * writer->capacity : INITIAL_TAPE_DEPTH;
+        struct TapeLevel* levels = realloc(writer->levels, capacity * sizeof(struct TapeLevel));
+        if(levels == NULL) {
+            writer->out_of_memory = true;
+            return false;
+        }
+        writer->levels = levels;
+        writer->capacity = capacity;
+    }
+    if(writer->check_only) {
+        writer->tape.count += 1;
+    } else if(push_entry(writer, type) == NULL) {
+        return false;
+    }
+    struct TapeLevel* level = &writer->levels[writer->depth];
+    level->entry = writer->tape.count - 1;
+    level->type = type;
+    level->state = EXPECT_FIRST;
+    writer->depth += 1;
+    return true;
+}
+
+static bool close_container(struct TapeWriter* writer, TapeType type) {
+    if(writer->depth == 0) {
+        return false;
+    }
+    struct TapeLevel* level = &writer->levels[writer->depth - 1];
+    if(level->type != type || level->state == AFTER_KEY || level->state == EXPECT_VALUE) {
+        return false;
+    }
+    if(!writer->check_only) {
+        writer->tape.entries[level->entry].position = writer->tape.count;
+    }
+    writer->depth -= 1;
+    return true;
+}
+
+static bool write_to_tape(struct TapeWriter* writer, TokenType type, const char* data, size_t length) {
+    struct TapeLevel* level = writer->depth ? &writer->levels[writer->depth - 1] : NULL;
+
+    switch(type) {
+        case TOKEN_OBJECT_START:
+            return open_container(writer, TAPE_OBJECT);
+        case TOKEN_ARRAY_START:
+            return open_container(writer, TAPE_ARRAY);
+        case TOKEN_OBJECT_END:
+            return close_container(writer, TAPE_OBJECT);
+        case TOKEN_ARRAY_END:
+            return close_container(writer, TAPE_ARRAY);
+        case TOKEN_COLON:
+            if(level == NULL || level->state != AFTER_KEY) {
+                return false;
+            }
+            level->state = EXPECT_VALUE;
+            return true;
+        case TOKEN_COMMA:
+            if(level == NULL) {
+                return false;
+            } else if(level->state == AFTER_VALUE) {
+                level->state = EXPECT_NEXT;
+            } else if(level->state == EXPECT_FIRST) {
+                level->state = EXPECT_CLOSE;
+            } else {
+                return false;
+            }
+            return true;
+        case TOKEN_VALUE:
+            return length > 0 && write_value(writer, data, length);
+    }
+    return false;
+}
+
+static bool write_token(void* context, TokenType type, const char* data, size_t length) {
+    struct TapeWriter* writer = context;
+    if(writer->failed) {
+        return true;
+    }
+    if(!write_to_tape(writer, type, data, length)) {
+        writer->failed = true;
+        // parser keeps going over an invalid object, so that the next one is looked
+        // for in the same place as when the builder doesn't stop on errors
+        return writer->check_only && !writer->out_of_memory;
+    }
+    return true;
+}
+
+static void attach_writer(struct TapeWriter* writer, struct Parser* parser, bool check_only) {
+    writer->levels = NULL;
+    writer->depth = 0;
+    writer->capacity = 0;
+    writer->shared_strings = NULL;
+    writer->check_only = check_only;
+    writer->failed = false;
+    writer->out_of_memory = false;
+    writer->sink.handle = write_token;
+    writer->sink.context = writer;
+    writer->sink.consumes_values = true;
+    parser->sink = &writer->sink;
+}
+
+void init_tape_writer(struct TapeWriter* writer, struct Parser* parser) {
+    // an entry per ENTRY_INPUT_RATIO bytes of input is reserved up front, pages that
+    // aren't written to don't take memory, and the rest is trimmed once writing is done
+    size_t capacity = parser->input_length / ENTRY_INPUT_RATIO;
+    writer->tape.entries = NULL;
+    if(capacity > INITIAL_TAPE_SIZE) {
+        writer->tape.entries = malloc(capacity * sizeof(struct TapeEntry));
+    }
+    writer->tape.count = 0;
+    writer->tape.capacity = writer->tape.entries != NULL ? capacity : 0;
+    init_char_buffer(&writer->tape.arena, INITIAL_ARENA_SIZE);
+    attach_writer(writer, parser, false);
+}
+
+void init_tape_checker(struct TapeWriter* writer, struct Parser* parser) {
+    // entries are only counted
+    writer->tape.entries = NULL;
+    writer->tape.count = 0;
+    writer->tape.capacity = 0;
+    init_char_buffer(&writer->tape.arena, 0);
+    attach_writer(writer, parser, true);
+}
+
+void reset_tape_checker(struct TapeWriter* writer) {
+    writer->tape.count = 0;
+    writer->depth = 0;
+    writer->failed = false;
+}
+
+bool take_tape(struct TapeWriter* writer, struct Tape* tape) {
+    if(writer->failed || writer->depth > 0 || writer->tape.count == 0) {
+        return false;
+    }
+    *tape = writer->tape;
+    // buffers grow by doubling, most of the slack would be kept for as long as the result
+    struct TapeEntry* entries = realloc(tape->entries, tape->count * sizeof(struct TapeEntry));
+    if(entries != NULL) {
+        tape->entries = entries;
+        tape->capacity = tape->count;
+    }
+    if(tape->arena.index > 0) {
+        char* arena = realloc(tape->arena.data, tape->arena.index);
+        if(arena != NULL) {
+            tape->arena.data = arena;
+            tape->arena.memory_buffer_length = tape->arena.index;
+        }
+    }
+    writer->tape.entries = NULL;
+    writer->tape.count = 0;
+    writer->tape.capacity = 0;
+    init_char_buffer(&writer->tape.arena, 0);
+    return true;
+}
+
+void release_tape_writer(struct TapeWriter* writer) {
+    release_tape(&writer->tape);
+    free(writer->levels);
+    writer->levels = NULL;
+    writer->capacity = 0;
+    free(writer->shared_strings);
+    writer->shared_strings = NULL;
+}
+
+void release_tape(struct Tape* tape) {
+    free(tape->entries);
+    tape->entries = NULL;
+    tape->count = 0;
+    tape->capacity = 0;
+    release_char_buffer(&tape->arena);
+    tape->arena.data = NULL;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#ifndef CHOMPJS_TAPE_H
+#define CHOMPJS_TAPE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "buffer.h"
+#include "parser.h"
+
+typedef enum {
+    TAPE_OBJECT,
+    TAPE_ARRAY,
+    TAPE_STRING,
+    // number or NaN
+    TAPE_NUMBER,
+    TAPE_TRUE,
+    TAPE_FALSE,
+    TAPE_NULL,
+} TapeType;
+
+/**
+    Single value written to the tape, 8 bytes long. Elements of a container
+    follow its entry, members of an object are stored as a key followed
+    by its value
+*/
+struct TapeEntry {
+    // containers: index of the entry after their last element,
+    // strings and numbers: offset of their length and JSON text in the arena
+    uint64_t position : 59;
+    // string contains escape sequences, its text can't be compared as it is
+    uint64_t escaped : 1;
+    uint64_t type : 4;
+};
+
+/**
+    Parsed object stored as one flat array of entries, with JSON text
+    of strings and numbers kept in a separate arena, each preceded by its
+    length. Short strings that repeat, such as keys, are stored only once.
+    Values are checked while they are written, so they can be converted
+    into Python objects later, only when they are needed
+*/
+struct Tape {
+    struct TapeEntry* entries;
+    size_t count;
+    size_t capacity;
+    struct CharBuffer arena;
+};
+
+/** Container being currently written */
+struct TapeLevel {
+    size_t entry;
+    TapeType type;
+    int state;
+};
+
+/**
+    Writes tokens reported by the parser to the tape, following the same
+    rules as the builder does. Doesn't use Python API, can be used from
+    any thread
+*/
+struct TapeWriter {
+    struct Tape tape;
+    struct TapeLevel* levels;
+    size_t depth;
+    size_t capacity;
+    // arena offsets of short strings written so far, allocated on first use
+    size_t* shared_strings;
+    // only the structure and values are checked, nothing is written
+    bool check_only;
+    bool failed;
+    bool out_of_memory;
+    struct TokenSink sink;
+};
+
+/** Initialize writer with an empty tape and attach it to the parser */
+void init_tape_writer(struct TapeWriter* writer, struct Parser* parser);
+
+/**
+    Initialize writer that only checks if tokens form a valid object, the same
+    one the writer would accept, and attach it to the parser. Invalid objects
+    don't stop the parser, `failed` is set instead
+*/
+void init_tape_checker(struct TapeWriter* writer, struct Parser* parser);
+
+/** Drop state of the object checked so far, prepare for checking next one */
+void reset_tape_checker(struct TapeWriter* writer);
+
+/**
+    Move complete tape out of the writer, trimming its unused memory.
+    False if tokens didn't form a valid object, the tape is left in place then
+*/
+bool take_tape(struct TapeWriter* writer, struct Tape* tape);
+
+/** Release writer, together with its tape unless it was taken */
+void release_tape_writer(struct TapeWriter* writer);
+
+/** Release memory held by the tape */
+void release_tape(struct Tape* tape);
+
+/** JSON text of a string or number entry */
+static inline const char* entry_text(const struct Tape* tape, const struct TapeEntry* entry, size_t* length) {
+    const unsigned char* p = (const unsigned char*)tape->arena.data + entry->position;
+    size_t value = 0;
+    int shift = 0;
+    while(*p & 0x80) {
+        value |= (size_t)(*p++ & 0x7F) << shift;
+        shift += 7;
+    }
+    *length = value | (size_t)*p << shift;
+    return (const char*)p + 1;
+}
+
+/** Index of the entry following the value at `index`, skipping elements of containers */
+static inline size_t next_entry(const struct Tape* tape, size_t index) {
+    const struct TapeEntry* entry = &tape->entries[index];
+    if(entry->type == TAPE_OBJECT || entry->type == TAPE_ARRAY) {
+        return entry->position;
+    }
+    return index + 1;
+}
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#include "tracker.h"
+
+void init_bracket_tracker(struct BracketTracker* tracker) {
+    tracker->depth = 0;
+    tracker->groups = 0;
+    tracker->quote = '\0';
+    tracker->escaped = false;
+    tracker->comment = NO_COMMENT;
+    tracker->previous = '\0';
+}
+
+void track_brackets(struct BracketTracker* tracker, const char* data, size_t length) {
+    for(size_t i = 0; i < length; ++i) {
+        char c = data[i];
+        char previous = tracker->previous;
+        tracker->previous = c;
+
+        if(tracker->comment == LINE_COMMENT) {
+            if(c == '\n') {
+                tracker->comment = NO_COMMENT;
+            }
+            continue;
+        } else if(tracker->comment == BLOCK_COMMENT) {
+            if(previous == '*' && c == '/') {
+                tracker->comment = NO_COMMENT;
+                // "/*/" doesn't close the comment
+                tracker->previous = '\0';
+            }
+            continue;
+        }
+
+        if(tracker->quote) {
+            if(tracker->escaped) {
+                tracker->escaped = false;
+            } else if(c == '\\') {
+                tracker->escaped = true;
+            } else if(c == tracker->quote) {
+                tracker->quote = '\0';
+            }
+            continue;
+        }
+
+        switch(c) {
+            case '/':
+                if(previous == '/') {
+                    tracker->comment = LINE_COMMENT;
+                }
+            break;
+            case '*':
+                if(previous == '/') {
+                    tracker->comment = BLOCK_COMMENT;
+                    tracker->previous = '\0';
+                }
+            break;
+            case '"':
+            case '\'':
+            case '`':
+                // text outside of objects is not parsed, quotes there mean nothing
+                if(tracker->depth > 0) {
+                    tracker->quote = c;
+                }
+            break;
+            case '{':
+            case '[':
+                tracker->depth += 1;
+            break;
+            case '}':
+            case ']':
+                if(tracker->depth > 0) {
+                    tracker->depth -= 1;
+                    if(tracker->depth == 0) {
+                        tracker->groups += 1;
+                    }
+                }
+            break;
+        }
+    }
+}
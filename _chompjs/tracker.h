@@ -0,0 +1,39 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+#ifndef CHOMPJS_TRACKER_H
+#define CHOMPJS_TRACKER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Comment tracker is currently inside of */
+typedef enum {
+    NO_COMMENT,
+    LINE_COMMENT,
+    BLOCK_COMMENT,
+} CommentKind;
+
+/**
+    Incremental bracket counter, aware of quoted strings and comments.
+    Can be fed with input split at arbitrary positions. Used to cheaply guess
+    where top-level objects end, without running the parser itself
+*/
+struct BracketTracker {
+    size_t depth;
+    size_t groups;
+    char quote;
+    bool escaped;
+    CommentKind comment;
+    char previous;
+};
+
+/** Initialize tracker */
+void init_bracket_tracker(struct BracketTracker* tracker);
+
+/** Process next part of the input */
+void track_brackets(struct BracketTracker* tracker, const char* data, size_t length);
+
+#endif
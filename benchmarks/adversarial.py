@@ -0,0 +1,98 @@
+# -*- coding: utf-8 -*-
+"""
+Adversarial inputs: deep nesting, long runs of characters the parser copies,
+unterminated strings and comments. Every case is run at growing sizes in its
+own process, reporting time per MB and peak memory. Time should stay flat
+per MB, and with limits set peak memory shouldn't grow with the input.
+
+    $ python benchmarks/adversarial.py
+    $ python benchmarks/adversarial.py --sizes 1 2 4 8 16 --only deep_arrays
+
+Peak memory is read with `resource`, so it's only reported on Unix
+"""
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import time
+from typing import Callable
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+MB = 1024 * 1024
+
+LIMITS = {"max_depth": 512, "max_output_bytes": MB}
+
+CASES: dict[str, Callable[[int], str]] = {
+    "deep_arrays": lambda n: "[" * n,
+    "deep_objects": lambda n: "{a:" * (n // 3),
+    "minus_run": lambda n: "[" + "-" * n + "1]",
+    "long_string": lambda n: "['" + "x" * n + "']",
+    "unclosed_string": lambda n: "['" + "x" * n,
+    "unclosed_comment": lambda n: "[1, /*" + "x" * n,
+    "many_values": lambda n: "[" + "1," * (n // 2) + "]",
+    "rejected_candidates": lambda n: "{;" * (n // 2),
+    "escapes": lambda n: "['" + "\\u0041" * (n // 6) + "']",
+}
+
+
+def run_child(name: str, size: int, limited: bool) -> None:
+    import resource
+
+    import _chompjs
+
+    text = CASES[name](size * MB)
+    base = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    limits = LIMITS if limited else {}
+    started = time.perf_counter()
+    failed = ""
+    try:
+        for _ in _chompjs.parse_objects(text, **limits):
+            pass
+    except ValueError as e:
+        failed = type(e).__name__
+    seconds = time.perf_counter() - started
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # ru_maxrss is in kilobytes on Linux, in bytes on macOS
+    scale = 1 if sys.platform == "darwin" else 1024
+    print(json.dumps({"seconds": seconds, "memory": (peak - base) * scale, "failed": failed}))
+
+
+def measure(name: str, size: int, limited: bool) -> dict:
+    command = [sys.executable, os.path.abspath(__file__), "--child", name, str(size)]
+    if limited:
+        command.append("--limited")
+    output = subprocess.run(command, check=True, capture_output=True, text=True).stdout
+    return json.loads(output)
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sizes", type=int, nargs="+", default=[1, 4, 16], help="input sizes in MB")
+    parser.add_argument("--only", nargs="+", choices=sorted(CASES), help="run only given cases")
+    parser.add_argument("--child", nargs=2, help=argparse.SUPPRESS)
+    parser.add_argument("--limited", action="store_true", help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    if args.child:
+        run_child(args.child[0], int(args.child[1]), args.limited)
+        return
+
+    print(f"{'case':<22}{'MB':>5}{'s/MB':>10}{'peak MB':>10}{'limited s/MB':>14}{'peak MB':>10}  result")
+    for name in args.only or CASES:
+        for size in args.sizes:
+            plain = measure(name, size, False)
+            limited = measure(name, size, True)
+            print(
+                f"{name:<22}{size:>5}"
+                f"{plain['seconds'] / size:>10.4f}{plain['memory'] / MB:>10.1f}"
+                f"{limited['seconds'] / size:>14.4f}{limited['memory'] / MB:>10.1f}"
+                f"  {limited['failed'] or 'ok'}"
+            )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,134 @@
+# -*- coding: utf-8 -*-
+"""
+Throughput benchmarks of the parser. Reports MB/s and objects/s of the C
+extension functions, of the public Python API and of json/orjson over
+the same input when it's already valid JSON.
+
+    $ python benchmarks/bench.py
+    $ python benchmarks/bench.py --only nextjs --repeat 10
+    $ python benchmarks/bench.py --save before.json
+    $ python benchmarks/bench.py --baseline before.json
+    $ python benchmarks/bench.py --dump corpus/   # input files for the C driver
+"""
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import sys
+import time
+from typing import Any, Callable
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+import _chompjs  # noqa: E402
+import chompjs  # noqa: E402
+from corpus import Document, generate  # noqa: E402
+
+try:
+    import orjson
+except ImportError:
+    orjson = None
+
+
+def cases(document: Document) -> list[tuple[str, Callable[[], Any]]]:
+    text = document.text
+    result: list[tuple[str, Callable[[], Any]]] = []
+    if document.lines:
+        result += [
+            ("parse_objects", lambda: list(_chompjs.parse_objects(text))),
+            ("parse_objects native", lambda: list(_chompjs.parse_objects(text, native=True))),
+            ("parse_js_objects", lambda: list(chompjs.parse_js_objects(text))),
+        ]
+        if orjson is not None:
+            result += [
+                ("parse_js_objects orjson", lambda: list(chompjs.parse_js_objects(text, loader=orjson.loads))),
+                ("parse_js_objects orjson bytes", lambda: list(
+                    chompjs.parse_js_objects(text, loader=orjson.loads, loader_bytes=True)
+                )),
+            ]
+        lines = text.splitlines()
+        result.append(("json.loads", lambda: [json.loads(line) for line in lines]))
+        if orjson is not None:
+            result.append(("orjson.loads", lambda: [orjson.loads(line) for line in lines]))
+        return result
+
+    result += [
+        ("parse", lambda: _chompjs.parse(text)),
+        ("parse native", lambda: _chompjs.parse(text, native=True)),
+        ("parse_js_object", lambda: chompjs.parse_js_object(text)),
+    ]
+    if orjson is not None:
+        result += [
+            ("parse_js_object orjson", lambda: chompjs.parse_js_object(text, loader=orjson.loads)),
+            ("parse_js_object orjson bytes", lambda: chompjs.parse_js_object(
+                text, loader=orjson.loads, loader_bytes=True
+            )),
+        ]
+    if document.valid_json:
+        result.append(("json.loads", lambda: json.loads(text)))
+        if orjson is not None:
+            result.append(("orjson.loads", lambda: orjson.loads(text)))
+    return result
+
+
+def measure(function: Callable[[], Any], repeat: int) -> float:
+    """Best time of `repeat` runs, after a warm-up run"""
+    function()
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.perf_counter()
+        function()
+        best = min(best, time.perf_counter() - start)
+    return best
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--size", type=int, default=2 * 1024 * 1024, help="approximate size of each document")
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--repeat", type=int, default=5)
+    parser.add_argument("--only", action="append", help="run only given documents")
+    parser.add_argument("--save", help="save results as JSON")
+    parser.add_argument("--baseline", help="compare with results saved earlier")
+    parser.add_argument("--dump", help="write documents into a directory and exit")
+    args = parser.parse_args()
+
+    documents = [
+        document for document in generate(args.size, args.seed)
+        if not args.only or document.name in args.only
+    ]
+    if args.dump:
+        os.makedirs(args.dump, exist_ok=True)
+        for document in documents:
+            extension = "jsonl" if document.lines else "js"
+            with open(os.path.join(args.dump, "%s.%s" % (document.name, extension)), "w", encoding="utf-8") as f:
+                f.write(document.text)
+        return
+
+    baseline = {}
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+
+    results = {}
+    print("%-14s %-30s %10s %12s %8s" % ("document", "benchmark", "MB/s", "objects/s", "change"))
+    for document in documents:
+        size = len(document.text.encode("utf-8"))
+        objects = document.text.count("\n") if document.lines else 1
+        for name, function in cases(document):
+            elapsed = measure(function, args.repeat)
+            key = "%s/%s" % (document.name, name)
+            results[key] = size / elapsed / 1e6
+            change = ""
+            if key in baseline:
+                change = "%+.1f%%" % (100 * (results[key] / baseline[key] - 1))
+            print("%-14s %-30s %10.1f %12.0f %8s" % (document.name, name, results[key], objects / elapsed, change))
+
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,162 @@
+# -*- coding: utf-8 -*-
+"""
+Deterministic corpus used by benchmarks. Every document is generated from
+a fixed seed, so results of different runs and machines can be compared
+"""
+from __future__ import annotations
+
+import json
+import random
+from typing import Callable, NamedTuple
+
+
+class Document(NamedTuple):
+    name: str
+    text: str
+    # is the input valid JSON, so that json/orjson can be compared against
+    valid_json: bool
+    # single object or JSON Lines
+    lines: bool
+
+
+def _words(rng: random.Random, count: int) -> str:
+    words = ["lorem", "ipsum", "dolor", "sit", "amet", "zażółć", "gęślą", "jaźń", "東京", "€"]
+    return " ".join(rng.choice(words) for _ in range(count))
+
+
+def _product(rng: random.Random, i: int) -> dict:
+    return {
+        "id": i,
+        "sku": "SKU-%08d" % rng.randrange(10 ** 8),
+        "name": _words(rng, 4),
+        "price": {"amount": round(rng.uniform(1, 1000), 2), "currency": "EUR"},
+        "available": rng.random() > 0.2,
+        "rating": None if rng.random() < 0.1 else round(rng.uniform(1, 5), 1),
+        "tags": [_words(rng, 1) for _ in range(rng.randrange(5))],
+        "description": '<p class="desc">' + _words(rng, 30) + "</p>\n",
+        "images": [
+            {"url": "https://example.com/img/%d/%d.jpg" % (i, j), "width": 800, "height": 600}
+            for j in range(rng.randrange(1, 4))
+        ],
+    }
+
+
+def nextjs(rng: random.Random, size: int) -> Document:
+    """Large __NEXT_DATA__-like payload embedded in a script"""
+    products = []
+    length = 0
+    while length < size:
+        products.append(_product(rng, len(products)))
+        length += 700
+    data = {
+        "props": {
+            "pageProps": {"products": products, "category": {"id": 12, "path": ["a", "b", "c"]}},
+            "__N_SSP": True,
+        },
+        "page": "/category/[slug]",
+        "query": {"slug": "shoes"},
+        "buildId": "Wx3lCnUxTJ2RYGBzxq1hX",
+    }
+    return Document("nextjs", json.dumps(data, ensure_ascii=False), True, False)
+
+
+def jsonlines(rng: random.Random, size: int) -> Document:
+    """Many small records, one per line"""
+    lines = []
+    length = 0
+    while length < size:
+        record = {
+            "id": len(lines),
+            "user": _words(rng, 2),
+            "score": rng.randrange(-1000, 1000),
+            "ratio": rng.random(),
+            "flags": [rng.random() > 0.5 for _ in range(3)],
+        }
+        line = json.dumps(record, ensure_ascii=False)
+        lines.append(line)
+        length += len(line) + 1
+    return Document("jsonlines", "\n".join(lines) + "\n", True, True)
+
+
+def numbers(rng: random.Random, size: int) -> Document:
+    """Array of integers and floats in various notations"""
+    values = []
+    length = 0
+    while length < size:
+        kind = rng.randrange(4)
+        if kind == 0:
+            value = str(rng.randrange(-10 ** 6, 10 ** 6))
+        elif kind == 1:
+            value = repr(rng.uniform(-1e6, 1e6))
+        elif kind == 2:
+            value = "%de%d" % (rng.randrange(1, 10), rng.randrange(-20, 20))
+        else:
+            value = str(rng.randrange(10 ** 20))
+        values.append(value)
+        length += len(value) + 2
+    return Document("numbers", "[" + ", ".join(values) + "]", True, False)
+
+
+def strings(rng: random.Random, size: int) -> Document:
+    """Object with long string values containing escapes and non-ASCII text"""
+    items = {}
+    length = 0
+    while length < size:
+        value = _words(rng, rng.randrange(5, 50))
+        if rng.random() < 0.3:
+            value += ' "quoted" \\ path\\to\\file \t\n'
+        key = "key_%d" % len(items)
+        items[key] = value
+        length += len(key) + len(value) + 8
+    return Document("strings", json.dumps(items), True, False)
+
+
+def nested(rng: random.Random, size: int) -> Document:
+    """Deeply nested arrays and objects"""
+    parts = []
+    length = 0
+    while length < size:
+        depth = rng.randrange(50, 400)
+        part = '{"a": [' * depth + "1" + "]}" * depth
+        parts.append(part)
+        length += len(part) + 2
+    return Document("nested", "[" + ", ".join(parts) + "]", True, False)
+
+
+def json5(rng: random.Random, size: int) -> Document:
+    """JavaScript object literals: unquoted keys, quotes, comments, trailing commas"""
+    items = []
+    length = 0
+    while length < size:
+        item = (
+            "  // item %d\n"
+            "  {id: %d, name: '%s', hex: 0x%x, ratio: .%d, big: +%d,"
+            " tags: ['a', \"b\", `c`,], /* comment */ nested: {ok: true, no: null,},},\n"
+        ) % (len(items), len(items), _words(rng, 3), rng.randrange(1 << 20), rng.randrange(1000), rng.randrange(100))
+        items.append(item)
+        length += len(item)
+    return Document("json5", "[\n" + "".join(items) + "]", False, False)
+
+
+def unrecognized(rng: random.Random, size: int) -> Document:
+    """Values the parser can't recognize, kept as strings"""
+    items = []
+    length = 0
+    while length < size:
+        item = (
+            "{date: new Date(%d, %d, %d), callback: function(a, b) { return a; }, "
+            "value: undefined, ref: window.data.items[%d], expr: a + b * 2}"
+        ) % (rng.randrange(2000, 2030), rng.randrange(12), rng.randrange(28), rng.randrange(100))
+        items.append(item)
+        length += len(item) + 2
+    return Document("unrecognized", "[" + ", ".join(items) + "]", False, False)
+
+
+GENERATORS: list[Callable[[random.Random, int], Document]] = [
+    nextjs, jsonlines, numbers, strings, nested, json5, unrecognized,
+]
+
+
+def generate(size: int, seed: int = 0) -> list[Document]:
+    """Generate all documents, each roughly `size` bytes long"""
+    return [generator(random.Random(seed), size) for generator in GENERATORS]
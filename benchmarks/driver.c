@@ -0,0 +1,118 @@
+/*
+ * Copyright 2020-2026 Mariusz Obajtek. All rights reserved.
+ * License: https://github.com/Nykakin/chompjs/blob/master/LICENSE
+ */
+
+/**
+    Standalone benchmark driver, running the parser over a file without
+    the Python interpreter. Useful for profiling with perf:
+
+    $ cc -O2 -g -I_chompjs benchmarks/driver.c _chompjs/parser.c _chompjs/buffer.c \
+        _chompjs/scan.c _chompjs/escape.c _chompjs/number.c -o driver
+    $ python benchmarks/bench.py --dump corpus/
+    $ ./driver corpus/nextjs.js 50
+    $ perf record -g ./driver corpus/jsonlines.jsonl 50
+
+    All objects of the file are parsed, the same way `parse_objects` does.
+    With `-u` escape sequences of the input are decoded first
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "parser.h"
+
+static char* read_file(const char* path, size_t* length) {
+    FILE* f = fopen(path, "rb");
+    if(f == NULL) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    rewind(f);
+    char* data = malloc(size + 1);
+    if(data == NULL || fread(data, 1, size, f) != (size_t)size) {
+        free(data);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    data[size] = '\0';
+    *length = size;
+    return data;
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/** Parse all objects of the input, return their number */
+static size_t parse_all(const char* data, size_t length, int unicode_escape) {
+    struct Parser parser;
+    size_t objects = 0;
+    init_parser(&parser, data, length);
+    if(unicode_escape) {
+        unescape_input(&parser);
+    }
+    for(;;) {
+        while(parser.parser_status == CAN_ADVANCE) {
+            advance(&parser);
+        }
+        if(parser.output.index == 1) {
+            break;
+        }
+        if(parser.parser_status == FINISHED) {
+            objects += 1;
+        }
+        reset_parser_output(&parser);
+    }
+    release_parser(&parser);
+    return objects;
+}
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    int repeat = 20;
+    int unicode_escape = 0;
+    for(int i = 1; i < argc; ++i) {
+        if(strcmp(argv[i], "-u") == 0) {
+            unicode_escape = 1;
+        } else if(path == NULL) {
+            path = argv[i];
+        } else {
+            repeat = atoi(argv[i]);
+        }
+    }
+    if(path == NULL || repeat <= 0) {
+        fprintf(stderr, "usage: %s [-u] FILE [REPEAT]\n", argv[0]);
+        return 2;
+    }
+
+    size_t length;
+    char* data = read_file(path, &length);
+    if(data == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    size_t objects = parse_all(data, length, unicode_escape);
+    double best = 1e100;
+    for(int i = 0; i < repeat; ++i) {
+        double start = now();
+        parse_all(data, length, unicode_escape);
+        double elapsed = now() - start;
+        if(elapsed < best) {
+            best = elapsed;
+        }
+    }
+    printf(
+        "%s: %zu bytes, %zu objects, %.1f MB/s, %.0f objects/s\n",
+        path, length, objects, length / best / 1e6, objects / best
+    );
+    free(data);
+    return 0;
+}
@@ -0,0 +1,142 @@
+# -*- coding: utf-8 -*-
+"""
+Scaling of the parser across threads. Every thread parses the same corpus
+of small documents, total throughput and speedup over a single thread are
+reported for each thread count. Speedup should stay close to the number of
+threads as long as there are free cores for them.
+
+    $ python benchmarks/threads.py
+    $ python benchmarks/threads.py --threads 1 2 4 8 16 --rounds 20
+    $ python benchmarks/threads.py --interpreters
+
+With the GIL enabled only parsing itself runs in parallel, building Python
+objects (native mode) doesn't. Free-threaded builds (3.13t and later) scale
+in both modes. `--interpreters` runs every thread in its own subinterpreter
+instead, which needs `concurrent.interpreters` (3.14 and later)
+"""
+from __future__ import annotations
+
+import argparse
+import os
+import sys
+import threading
+import time
+from typing import Callable
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+sys.path.insert(0, ROOT)
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import _chompjs  # noqa: E402
+from corpus import generate  # noqa: E402
+
+# run inside of every subinterpreter, `documents` and `parse_round` are kept in its __main__
+SETUP = """
+import sys
+sys.path[:0] = {paths!r}
+import _chompjs
+from corpus import generate
+documents = [(document.text, document.lines) for document in generate({size}, {seed})]
+
+def parse_round(native):
+    for text, is_lines in documents:
+        if is_lines:
+            for _ in _chompjs.parse_objects(text, native=native):
+                pass
+        else:
+            _chompjs.parse(text, native=native)
+"""
+
+
+def parse_round(documents: list[tuple[str, bool]], native: bool) -> None:
+    for text, is_lines in documents:
+        if is_lines:
+            for _ in _chompjs.parse_objects(text, native=native):
+                pass
+        else:
+            _chompjs.parse(text, native=native)
+
+
+def run_threads(count: int, work: Callable[[int], None]) -> float:
+    """Wall time of `count` threads started together, each calling `work` with its index"""
+    barrier = threading.Barrier(count + 1)
+
+    def target(index: int) -> None:
+        barrier.wait()
+        work(index)
+
+    threads = [threading.Thread(target=target, args=(i,)) for i in range(count)]
+    for thread in threads:
+        thread.start()
+    barrier.wait()
+    start = time.perf_counter()
+    for thread in threads:
+        thread.join()
+    return time.perf_counter() - start
+
+
+def thread_work(documents: list[tuple[str, bool]], rounds: int, native: bool) -> Callable[[int], None]:
+    def work(index: int) -> None:
+        for _ in range(rounds):
+            parse_round(documents, native)
+    return work
+
+
+def interpreter_work(interpreters: list, rounds: int, native: bool) -> Callable[[int], None]:
+    code = "for _ in range(%d):\n    parse_round(%r)\n" % (rounds, native)
+
+    def work(index: int) -> None:
+        interpreters[index].exec(code)
+    return work
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4, 8])
+    parser.add_argument("--size", type=int, default=64 * 1024, help="approximate size of each document")
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--rounds", type=int, default=10, help="passes over the corpus made by every thread")
+    parser.add_argument("--interpreters", action="store_true", help="run every thread in its own subinterpreter")
+    args = parser.parse_args()
+
+    corpus = generate(args.size, args.seed)
+    documents = [(document.text, document.lines) for document in corpus]
+    size = sum(len(text.encode("utf-8")) for text, _ in documents)
+
+    interpreters = []
+    if args.interpreters:
+        try:
+            from concurrent import interpreters as subinterpreters  # type: ignore[import-not-found]
+        except ImportError:
+            sys.exit("concurrent.interpreters is not available, it needs Python 3.14 or later")
+        setup = SETUP.format(paths=[ROOT, os.path.dirname(os.path.abspath(__file__))], size=args.size, seed=args.seed)
+        for _ in range(max(args.threads)):
+            interpreter = subinterpreters.create()
+            interpreter.exec(setup)
+            interpreters.append(interpreter)
+
+    gil = getattr(sys, "_is_gil_enabled", lambda: True)()
+    print("Python %s, GIL %s, %d CPUs, %.1f MB per round" % (
+        sys.version.split()[0], "enabled" if gil else "disabled", os.cpu_count() or 1, size / 1e6
+    ))
+    print("%-8s %8s %10s %8s" % ("mode", "threads", "MB/s", "speedup"))
+    for native in (False, True):
+        mode = "native" if native else "text"
+        single = None
+        for count in args.threads:
+            if interpreters:
+                work = interpreter_work(interpreters, args.rounds, native)
+            else:
+                work = thread_work(documents, args.rounds, native)
+            elapsed = run_threads(count, work)
+            throughput = count * args.rounds * size / elapsed / 1e6
+            if single is None:
+                single = throughput / count
+            print("%-8s %8d %10.1f %8.2f" % (mode, count, throughput, throughput / single))
+
+    for interpreter in interpreters:
+        interpreter.close()
+
+
+if __name__ == "__main__":
+    main()
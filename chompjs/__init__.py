@@ -1,3 +1,10 @@
-from .chompjs import parse_js_object, parse_js_objects
+from .chompjs import (
+    parse_js_object, parse_js_objects, parse_file, find_js_objects, parse_js_assignments, parse_many, iter_items,
+    get_stats, reset_stats, Parser, StreamParser, ParseJob, parse_js_object_async, LimitExceededError
+)
 
-__all__ = ["parse_js_object", "parse_js_objects"]
\ No newline at end of file
+__all__ = [
+    "parse_js_object", "parse_js_objects", "parse_file", "find_js_objects", "parse_js_assignments",
+    "parse_many", "iter_items", "get_stats", "reset_stats", "Parser", "StreamParser",
+    "ParseJob", "parse_js_object_async", "LimitExceededError",
+]
\ No newline at end of file
@@ -1,15 +1,24 @@
 # -*- coding: utf-8 -*-
 from __future__ import annotations
 
+import collections.abc
 import json
+import mmap
+import os
 import warnings
 from typing import Any, Protocol, TypeVar, TYPE_CHECKING
-from _chompjs import parse, parse_objects # type: ignore[reportAttributeAccessIssue,attr-defined]
+from _chompjs import ( # type: ignore[reportAttributeAccessIssue,attr-defined]
+    LimitExceededError, lazy_array, lazy_object, create_parser, get_stats as _get_stats,
+    reset_stats as _reset_stats, parse, parse_objects, parse_assignments, parse_batch, parse_items,
+    parse_chunks, parse_stream, start_parse
+)
 
 
 if TYPE_CHECKING:
-    from collections.abc import Iterable, Mapping, Sequence
+    from collections.abc import Iterable, Iterator, Mapping, Sequence
+    from typing import Union
 
+    _Input = Union[str, bytes, bytearray, memoryview, mmap.mmap]
     _T = TypeVar("_T")
     _T2 = TypeVar("_T2")
     _T_co = TypeVar("_T_co", covariant=True)
@@ -18,11 +27,12 @@ if TYPE_CHECKING:
 
         def __call__(self, obj: str, / , *args: Any, **kwargs: Any) -> _T_co: ...
 
+# proxies returned with `lazy=True` are read-only, but otherwise behave like dicts and lists
+collections.abc.Mapping.register(lazy_object)
+collections.abc.Sequence.register(lazy_array)
 
-def _preprocess(string: str, unicode_escape: bool=False) -> str:
-    if unicode_escape:
-        string = string.encode().decode("unicode_escape")
-    return string
+# amount of parsed data after which memory pages of a mapped file are released
+_RELEASED_CHUNK_SIZE = 16 * 1024 * 1024
 
 
 def _process_loader_arguments(
@@ -44,27 +54,111 @@ def _process_loader_arguments(
     return (loader_args, loader_kwargs)
 
 
+def _uses_native_loader(
+    loader: _JsonLoader[_T_co],
+    loader_args: Sequence[Any],
+    loader_kwargs: Mapping[str, Any],
+) -> bool:
+    # default loader without extra options is replaced by building
+    # Python objects directly in C, skipping the intermediate JSON text
+    return loader is json.loads and not loader_args and not loader_kwargs
+
+
+def _iterate_objects(
+    string: _Input,
+    native: bool,
+    unicode_escape: bool,
+    workers: int | None,
+    cache_values: bool=False,
+    limits: Mapping[str, int | None] | None=None,
+    as_bytes: bool=False,
+    content_hash: bool=False,
+) -> Iterator[Any]:
+    if limits is None:
+        limits = {}
+    # chunks aren't hashed, hashes are only computed by sequential parsing
+    if workers is not None and workers > 1 and not content_hash:
+        return parse_chunks(
+            string, native=native, unicode_escape=unicode_escape, workers=workers,
+            cache_values=cache_values, as_bytes=as_bytes, **limits
+        )
+    return parse_objects(
+        string, native=native, unicode_escape=unicode_escape, cache_values=cache_values,
+        as_bytes=as_bytes, content_hash=content_hash, **limits
+    )
+
+
+def _limits(
+    max_input_bytes: int | None,
+    max_output_bytes: int | None,
+    max_depth: int | None,
+) -> dict[str, int | None]:
+    return {
+        "max_input_bytes": max_input_bytes,
+        "max_output_bytes": max_output_bytes,
+        "max_depth": max_depth,
+    }
+
+
+def _load_objects(
+    raw_objects: Iterable[str | bytes],
+    loader: _JsonLoader[_T_co],
+    loader_args: Sequence[Any],
+    loader_kwargs: Mapping[str, Any],
+) -> Iterable[_T_co]:
+    for raw_data in raw_objects:
+        try:
+            yield loader(raw_data, *loader_args, **loader_kwargs)
+        except ValueError:
+            continue
+
+
+def _load_hashed_objects(
+    raw_objects: Iterable[tuple[str | bytes, int]],
+    loader: _JsonLoader[_T_co],
+    loader_args: Sequence[Any],
+    loader_kwargs: Mapping[str, Any],
+) -> Iterable[tuple[_T_co, int]]:
+    for raw_data, content_hash in raw_objects:
+        try:
+            yield loader(raw_data, *loader_args, **loader_kwargs), content_hash
+        except ValueError:
+            continue
+
+
 def parse_js_object(
-    string: str,
+    string: _Input,
     unicode_escape: bool=False,
     loader: _JsonLoader[_T_co]=json.loads,
     loader_args: Sequence[Any] | None=None,
     loader_kwargs: Mapping[str, Any] | None=None,
     json_params: Mapping[str, Any] | None=None,
+    path: str | None=None,
+    max_input_bytes: int | None=None,
+    max_output_bytes: int | None=None,
+    max_depth: int | None=None,
+    loader_bytes: bool=False,
+    content_hash: bool=False,
+    lazy: bool=False,
 ) -> _T_co:
     """
     Extracts first JSON object encountered in the input string
 
     Parameters
     ----------
-    string: str
-        Input string
+    string: str | bytes
+        Input string. Any bytes-like object (bytes, bytearray, memoryview, mmap)
+        is read as UTF-8 data without being copied
 
     >>> parse_js_object("{a: 100}")
     {'a': 100}
+    >>> parse_js_object(b"{a: 100}")
+    {'a': 100}
 
     unicode_escape: bool, optional
-        Attempt to fix input string if it contains escaped special characters
+        Attempt to fix input string if it contains escaped special characters.
+        Escape sequences are decoded the same way as with `unicode_escape` codec,
+        but non-ASCII characters are kept intact
 
     >>> parse_js_object('{\\\\"a\\\\": 100}')
     {'\\\\"a\\\\"': 100}
@@ -72,7 +166,9 @@ def parse_js_object(
     {'a': 100}
 
     loader: func, optional
-        Function used to load processed input data. By default `json.loads` is used
+        Function used to load processed input data. By default `json.loads` is used.
+        Unless `loader_args` or `loader_kwargs` are given, default loader is replaced by
+        building Python objects directly in C, with the same results
 
     >>> import orjson
     >>> import chompjs
@@ -92,20 +188,89 @@ def parse_js_object(
     >>> parse_js_object("{'a': 10.1}", loader_kwargs={'parse_float': decimal.Decimal})
     {'a': Decimal('10.1')}
 
+    loader_bytes: bool, optional
+        Pass processed input data to the loader as UTF-8 encoded `bytes` instead
+        of `str`. Loaders reading bytes directly, such as `orjson.loads`, skip
+        decoding and encoding it again
+
+    >>> chompjs.parse_js_object("{'a': 12}", loader=orjson.loads, loader_bytes=True)
+    {'a': 12}
+
     .. deprecated:: 1.3.0
     json_params: dict, optional
         Use `loader_kwargs` instead
 
+    path: str, optional
+        Return only the value found under given path, such as `props.pageProps`,
+        `items[0].name` or `data["key.with.dots"]`. Rest of the object is skipped
+        without being parsed. Raises `ValueError` if the path doesn't exist
+
+    >>> parse_js_object("{props: {items: [{name: 'a'}, {name: 'b'}]}}", path="props.items[1]")
+    {'name': 'b'}
+    >>> parse_js_object("{props: {items: [{name: 'a'}, {name: 'b'}]}}", path="props.items[1].name")
+    'b'
+
+    max_input_bytes: int, optional
+        Maximum size of the input, in UTF-8 bytes
+
+    max_output_bytes: int, optional
+        Maximum size of JSON text produced for the extracted object, in bytes.
+        With the default loader values are built directly, size of their text
+        is counted instead
+
+    max_depth: int, optional
+        Maximum nesting depth of brackets of the extracted object
+
+    Limits bound time and memory spent on hostile or broken input. Going over any
+    of them raises `LimitExceededError`, a subclass of `ValueError`. By default
+    there are no limits
+
+    >>> parse_js_object("[[[1]]]", max_depth=2)
+    Traceback (most recent call last):
+      ...
+    chompjs.LimitExceededError: Nesting exceeds max_depth=2 near character 2
+
+    content_hash: bool, optional
+        Return `(object, hash)` pair instead of the object alone. The hash is a 64-bit
+        integer computed while parsing, equal objects get equal hashes regardless of
+        the order of their keys, so they can be deduplicated without serializing them
+        again. Only the last of duplicate keys counts, same as in the returned dict.
+        Strings are compared after decoding escape sequences, numbers as they are
+        written, so `1` and `1.0` get different hashes. Hashes are the same on every
+        platform and between runs
+
+    >>> a = parse_js_object("{a: 1, b: [1, 2]}", content_hash=True)
+    >>> b = parse_js_object("{'b': [1, 2], 'a': 1}", content_hash=True)
+    >>> a[0] == b[0] and a[1] == b[1]
+    True
+
+    lazy: bool, optional
+        Write the object to a compact tape instead of building Python objects, and
+        return a read-only proxy of it. Proxies of objects are `Mapping`, proxies
+        of arrays are `Sequence`, Python objects are only created for the values
+        that are accessed. Suits big objects that are only partly used. `loader`
+        isn't used, values are the same as with the default one. `to_python()`
+        method converts the whole proxy into dict or list
+
+    >>> data = parse_js_object("{items: [{id: 1}, {id: 2}], total: 2}", lazy=True)
+    >>> data["items"][1]["id"], len(data["items"]), data.get("missing")
+    (2, 2, None)
+    >>> data["items"].to_python()
+    [{'id': 1}, {'id': 2}]
+
     Returns
     -------
     list | dict
-        Extracted JSON object
+        Extracted JSON object, or its proxy with `lazy=True`
 
     Raises
     ------
     ValueError
         If failed to parse input properly
 
+    LimitExceededError
+        If input goes over one of the limits
+
     ```python
     >>> parse_js_object(None)
     Traceback (most recent call last):
@@ -114,7 +279,7 @@ def parse_js_object(
     >>> parse_js_object("No JSON objects in sight...")
     Traceback (most recent call last):
       ...
-    json.decoder.JSONDecodeError: Expecting value: line 1 column 1 (char 0)
+    ValueError: Error parsing input near character 27
 
     ```
 
@@ -126,19 +291,42 @@ def parse_js_object(
         loader_args, loader_kwargs, json_params
     )
 
-    string = _preprocess(string, unicode_escape)
-    parsed_data = parse(string)
+    limits = _limits(max_input_bytes, max_output_bytes, max_depth)
+    if lazy:
+        return parse(
+            string, unicode_escape=unicode_escape, path=path, content_hash=content_hash,
+            lazy=True, **limits
+        )
+    if _uses_native_loader(loader, loader_args, loader_kwargs):
+        return parse(
+            string, native=True, unicode_escape=unicode_escape, path=path,
+            content_hash=content_hash, **limits
+        )
+    parsed_data = parse(
+        string, unicode_escape=unicode_escape, path=path, as_bytes=loader_bytes,
+        content_hash=content_hash, **limits
+    )
+    if content_hash:
+        parsed_data, hash_value = parsed_data
+        return loader(parsed_data, *loader_args, **loader_kwargs), hash_value
     return loader(parsed_data, *loader_args, **loader_kwargs)
 
 
 def parse_js_objects(
-    string: str,
+    string: _Input,
     unicode_escape: bool=False,
     omitempty: bool=False, 
     loader: _JsonLoader[_T_co]=json.loads,
     loader_args: Sequence[Any] | None=None,
     loader_kwargs: Mapping[str, Any] | None=None,
     json_params: Mapping[str, Any] | None=None,
+    workers: int | None=None,
+    cache_values: bool=False,
+    max_input_bytes: int | None=None,
+    max_output_bytes: int | None=None,
+    max_depth: int | None=None,
+    loader_bytes: bool=False,
+    content_hash: bool=False,
 )-> Iterable[_T_co]:
     """
     Returns a generator extracting all JSON objects encountered in the input string.
@@ -146,8 +334,9 @@ def parse_js_objects(
 
     Parameters
     ----------
-    string: str
-        Input string
+    string: str | bytes
+        Input string. Any bytes-like object (bytes, bytearray, memoryview, mmap)
+        is read as UTF-8 data without being copied
 
     >>> it = parse_js_objects("{a: 100} {b: 100}")
     >>> next(it)
@@ -156,7 +345,9 @@ def parse_js_objects(
     {'b': 100}
 
     unicode_escape: bool, optional
-        Attempt to fix input string if it contains escaped special characters
+        Attempt to fix input string if it contains escaped special characters.
+        Escape sequences are decoded the same way as with `unicode_escape` codec,
+        but non-ASCII characters are kept intact
 
     >>> next(parse_js_objects('{\\\\"a\\\\": 100}'))
     {'\\\\"a\\\\"': 100}
@@ -172,7 +363,9 @@ def parse_js_objects(
     [{'a': 12}, {'b': 13}]
 
     loader: func, optional
-        Function used to load processed input data. By default `json.loads` is used
+        Function used to load processed input data. By default `json.loads` is used.
+        Unless `loader_args` or `loader_kwargs` are given, default loader is replaced by
+        building Python objects directly in C, with the same results
 
     >>> import orjson
     >>> import chompjs
@@ -192,10 +385,50 @@ def parse_js_objects(
     >>> next(parse_js_objects("{'a': 10.1}", loader_kwargs={'parse_float': decimal.Decimal}))
     {'a': Decimal('10.1')}
 
+    loader_bytes: bool, optional
+        Pass processed input data to the loader as `bytes`, see `parse_js_object`
+
     .. deprecated:: 1.3.0
     json_params: dict, optional
         Use `loader_kwargs` instead
 
+    workers: int, optional
+        Split the input into chunks at newlines and parse them on given number
+        of native threads, without holding the GIL. Results are the same and in
+        the same order. By default the input is parsed sequentially
+
+    >>> list(parse_js_objects("{a: 1}\\n{b: 2}\\n", workers=4))
+    [{'a': 1}, {'b': 2}]
+
+    cache_values: bool, optional
+        Reuse the same `str` object for equal short string values, like it's
+        always done for object keys. Saves memory when values repeat, such as
+        enumerations, at a small cost when they don't. Only applies when
+        objects are built natively
+
+    >>> a, b = parse_js_objects("{k: 'on'} {k: 'on'}", cache_values=True)
+    >>> a['k'] is b['k']
+    True
+
+    max_input_bytes: int, optional
+    max_output_bytes: int, optional
+    max_depth: int, optional
+        Limits of the input size and of every object, see `parse_js_object`.
+        Unlike invalid objects, an object going over a limit isn't skipped,
+        `LimitExceededError` is raised and iteration stops
+
+    content_hash: bool, optional
+        Yield `(object, hash)` pairs, see `parse_js_object`. Repeated objects can
+        be dropped without serializing them again. Input is always parsed
+        sequentially then, `workers` is ignored
+
+    >>> seen = set()
+    >>> for data, hash_value in parse_js_objects("{a: 1, b: 2} {b: 2, a: 1}", content_hash=True):
+    ...     if hash_value not in seen:
+    ...         seen.add(hash_value)
+    ...         print(data)
+    {'a': 1, 'b': 2}
+
     Returns
     -------
     generator
@@ -209,14 +442,798 @@ def parse_js_objects(
         loader_args, loader_kwargs, json_params
     )
 
-    string = _preprocess(string, unicode_escape)
-    for raw_data in parse_objects(string):
+    limits = _limits(max_input_bytes, max_output_bytes, max_depth)
+    if _uses_native_loader(loader, loader_args, loader_kwargs):
+        objects = _iterate_objects(
+            string, True, unicode_escape, workers, cache_values, limits, content_hash=content_hash
+        )
+    else:
+        raw_objects = _iterate_objects(
+            string, False, unicode_escape, workers, limits=limits, as_bytes=loader_bytes,
+            content_hash=content_hash
+        )
+        if content_hash:
+            objects = _load_hashed_objects(raw_objects, loader, loader_args, loader_kwargs)
+        else:
+            objects = _load_objects(raw_objects, loader, loader_args, loader_kwargs)
+
+    for data in objects:
+        if omitempty and not (data[0] if content_hash else data):
+            continue
+
+        yield data
+
+
+def parse_file(
+    path: str | os.PathLike[str],
+    unicode_escape: bool=False,
+    omitempty: bool=False,
+    loader: _JsonLoader[_T_co]=json.loads,
+    loader_args: Sequence[Any] | None=None,
+    loader_kwargs: Mapping[str, Any] | None=None,
+    workers: int | None=None,
+    cache_values: bool=False,
+    max_output_bytes: int | None=None,
+    max_depth: int | None=None,
+    loader_bytes: bool=False,
+) -> Iterator[_T_co]:
+    """
+    Returns a generator extracting all JSON objects from a file, such as a large
+    JSON Lines dump. The file is memory-mapped instead of being read, memory used
+    while parsing depends only on the size of the largest object
+
+    Parameters
+    ----------
+    path: str | os.PathLike
+        Path of the file. Its content is read as UTF-8 data
+
+    unicode_escape: bool, optional
+        Attempt to fix input if it contains escaped special characters, see
+        `parse_js_objects`. Decoded copy of the whole file is kept in memory
+
+    omitempty: bool, optional
+        Skip empty dictionaries and lists
+
+    loader: func, optional
+        Function used to load processed input data, see `parse_js_objects`
+
+    loader_args: list, optional
+        Allow passing down positional arguments to loader function
+
+    loader_kwargs: dict, optional
+        Allow passing down keyword arguments to loader function
+
+    loader_bytes: bool, optional
+        Pass processed input data to the loader as `bytes`, see `parse_js_object`
+
+    workers: int, optional
+        Number of native threads parsing chunks of the file, see `parse_js_objects`
+
+    cache_values: bool, optional
+        Reuse equal short string values, see `parse_js_objects`
+
+    max_output_bytes: int, optional
+    max_depth: int, optional
+        Limits of every object, see `parse_js_object`. Memory used for the
+        largest object is bounded by them
+
+    Returns
+    -------
+    generator
+        Iterating over it yields all JSON objects of the file. The file is
+        closed once the generator is exhausted or closed
+    """
+
+    loader_args, loader_kwargs = _process_loader_arguments(
+        loader_args, loader_kwargs, None
+    )
+    native = _uses_native_loader(loader, loader_args, loader_kwargs)
+
+    with open(path, "rb") as f:
+        # empty files can't be mapped
+        if os.fstat(f.fileno()).st_size == 0:
+            return
+        with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as data:
+            # pages of the mapping that were already parsed are dropped from
+            # memory, with unicode_escape a decoded copy is parsed instead
+            release = not unicode_escape and hasattr(mmap, "MADV_DONTNEED")
+            released = 0
+            limits = _limits(None, max_output_bytes, max_depth)
+            objects = _iterate_objects(
+                data, native, unicode_escape, workers, cache_values, limits, loader_bytes
+            )
+            try:
+                for raw_data in objects:
+                    if release and objects.position - released >= _RELEASED_CHUNK_SIZE:
+                        position = objects.position - objects.position % mmap.PAGESIZE
+                        data.madvise(mmap.MADV_DONTNEED, released, position - released)
+                        released = position
+
+                    if native:
+                        parsed_data = raw_data
+                    else:
+                        try:
+                            parsed_data = loader(raw_data, *loader_args, **loader_kwargs)
+                        except ValueError:
+                            continue
+                    if not parsed_data and omitempty:
+                        continue
+                    yield parsed_data
+            finally:
+                # the iterator holds the mapping, it has to be released before
+                # the mapping is closed
+                del objects
+
+
+def find_js_objects(string: _Input, content_hash: bool=False) -> Iterable[tuple[Any, ...]]:
+    """
+    Returns a generator locating all JSON objects encountered in the input string,
+    the same ones `parse_js_objects` would return, without copying or loading them.
+    Can be used to slice, hash or lazily parse only the objects that are needed
+
+    Parameters
+    ----------
+    string: str | bytes
+        Input string. Offsets into `str` are counted in characters, offsets
+        into bytes-like objects are counted in bytes
+
+    >>> text = 'var a = {"x": 1}; var b = [1, 2,];'
+    >>> list(find_js_objects(text))
+    [(8, 16, False), (26, 33, True)]
+    >>> text[26:33]
+    '[1, 2,]'
+
+    content_hash: bool, optional
+        Add content hash of every object as the fourth item, see `parse_js_object`.
+        Objects are still not loaded, repeated ones can be skipped before that
+
+    Returns
+    -------
+    generator
+        Iterating over it yields (start, end, rewritten) tuples. `rewritten` is False
+        when the object is already valid JSON text and can be loaded as it is.
+        Invalid objects are skipped
+    """
+
+    if not string:
+        return
+
+    yield from parse_objects(string, spans=True, content_hash=content_hash)
+
+
+def parse_js_assignments(
+    string: _Input,
+    loader: _JsonLoader[_T_co]=json.loads,
+    loader_args: Sequence[Any] | None=None,
+    loader_kwargs: Mapping[str, Any] | None=None,
+    loader_bytes: bool=False,
+    max_input_bytes: int | None=None,
+    max_output_bytes: int | None=None,
+    max_depth: int | None=None,
+) -> Iterable[tuple[str | None, _T_co]]:
+    """
+    Returns a generator extracting JavaScript objects assigned to names inside of
+    `<script>` tags of HTML document, such as `var data = {...}`, `window.__STATE__ = [...]`
+    or `data = JSON.parse('...')`. Bodies of `<script type="application/json">` tags
+    are returned under their `id` attribute. Input without any `<script>` tag
+    is treated as a single script
+
+    Parameters
+    ----------
+    string: str | bytes
+        HTML document or script text. Any bytes-like object (bytes, bytearray,
+        memoryview, mmap) is read as UTF-8 data without being copied
+
+    >>> html = '<script>window.__STATE__ = {a: 1}; var x = JSON.parse("[1, 2]")</script>'
+    >>> list(parse_js_assignments(html))
+    [('window.__STATE__', {'a': 1}), ('x', [1, 2])]
+    >>> html = '<script id="__NEXT_DATA__" type="application/json">{"props": {}}</script>'
+    >>> list(parse_js_assignments(html))
+    [('__NEXT_DATA__', {'props': {}})]
+
+    loader: func, optional
+        Function used to load processed input data, see `parse_js_objects`
+
+    loader_args: list, optional
+        Allow passing down positional arguments to loader function
+
+    loader_kwargs: dict, optional
+        Allow passing down keyword arguments to loader function
+
+    loader_bytes: bool, optional
+        Pass processed input data to the loader as `bytes`, see `parse_js_object`
+
+    max_input_bytes: int, optional
+    max_output_bytes: int, optional
+    max_depth: int, optional
+        Limits of the document size and of every assigned object, see `parse_js_object`.
+        An object going over a limit isn't skipped, `LimitExceededError` is raised
+        and iteration stops
+
+    >>> html = '<script>var a = {b: {c: [1]}}</script>'
+    >>> list(parse_js_assignments(html, max_depth=2))
+    Traceback (most recent call last):
+      ...
+    chompjs.LimitExceededError: Nesting exceeds max_depth=2 near character 8
+
+    Returns
+    -------
+    generator
+        Iterating over it yields (name, object) pairs in document order. Name is
+        None for JSON scripts without `id` attribute. Invalid objects are skipped
+    """
+
+    if not string:
+        return
+
+    loader_args, loader_kwargs = _process_loader_arguments(
+        loader_args, loader_kwargs, None
+    )
+
+    limits = _limits(max_input_bytes, max_output_bytes, max_depth)
+    if _uses_native_loader(loader, loader_args, loader_kwargs):
+        yield from parse_assignments(string, native=True, **limits)
+        return
+
+    for name, raw_data in parse_assignments(string, as_bytes=loader_bytes, **limits):
         try:
-            data = loader(raw_data, *loader_args, **loader_kwargs)
+            yield name, loader(raw_data, *loader_args, **loader_kwargs)
         except ValueError:
             continue
 
-        if not data and omitempty:
-            continue
 
-        yield data
+def _load_items(
+    raw_items: Iterable[Any],
+    loader: _JsonLoader[_T_co],
+    loader_args: Sequence[Any],
+    loader_kwargs: Mapping[str, Any],
+) -> Iterator[Any]:
+    for item in raw_items:
+        if isinstance(item, tuple):
+            key, raw_data = item
+            yield key, loader(raw_data, *loader_args, **loader_kwargs)
+        else:
+            yield loader(item, *loader_args, **loader_kwargs)
+
+
+def iter_items(
+    string: _Input,
+    path: str | None=None,
+    unicode_escape: bool=False,
+    loader: _JsonLoader[_T_co]=json.loads,
+    loader_args: Sequence[Any] | None=None,
+    loader_kwargs: Mapping[str, Any] | None=None,
+    max_input_bytes: int | None=None,
+    max_output_bytes: int | None=None,
+    max_depth: int | None=None,
+    loader_bytes: bool=False,
+) -> Iterator[Any]:
+    """
+    Returns an iterator over elements of the first array found in the input string,
+    or over (key, value) pairs of the first object. Elements are parsed one at a time
+    when they are requested, so the first of them is available right away and only
+    the current one is kept in memory, however big the whole container is
+
+    Parameters
+    ----------
+    string: str | bytes
+        Input string. Any bytes-like object (bytes, bytearray, memoryview, mmap)
+        is read as UTF-8 data without being copied
+
+    >>> list(iter_items("var data = [1, {a: 2}, 'x']"))
+    [1, {'a': 2}, 'x']
+    >>> list(iter_items("{a: 1, b: [2, 3]}"))
+    [('a', 1), ('b', [2, 3])]
+
+    path: str, optional
+        Iterate over the array or object found under given path instead, see
+        `parse_js_object`. Raises `ValueError` if the path doesn't exist
+
+    >>> list(iter_items("{props: {items: [{id: 1}, {id: 2}]}}", path="props.items"))
+    [{'id': 1}, {'id': 2}]
+
+    unicode_escape: bool, optional
+        Attempt to fix input string if it contains escaped special characters,
+        see `parse_js_object`
+
+    loader: func, optional
+        Function used to load processed input data of each element, see
+        `parse_js_object`. Keys of objects are always `str`
+
+    loader_args: list, optional
+        Allow passing down positional arguments to loader function
+
+    loader_kwargs: dict, optional
+        Allow passing down keyword arguments to loader function
+
+    max_input_bytes: int, optional
+        Maximum size of the input, in UTF-8 bytes
+
+    max_output_bytes: int, optional
+        Maximum size of JSON text produced for a single element, in bytes
+
+    max_depth: int, optional
+        Maximum nesting depth of brackets of a single element
+
+    loader_bytes: bool, optional
+        Pass processed input data to the loader as `bytes`, see `parse_js_object`
+
+    Returns
+    -------
+    iterator
+        Iterating over it yields elements of the array, or (key, value) pairs of
+        the object, in input order
+
+    Raises
+    ------
+    ValueError
+        If there's no array or object in the input. Elements before a malformed one
+        are still yielded, then the error is raised
+
+    LimitExceededError
+        If input goes over one of the limits
+
+    ```python
+    >>> list(iter_items("[1, 2"))
+    Traceback (most recent call last):
+      ...
+    ValueError: Error parsing input near character 5
+
+    ```
+
+    """
+    if not string:
+        raise ValueError("Invalid input")
+
+    loader_args, loader_kwargs = _process_loader_arguments(
+        loader_args, loader_kwargs, None
+    )
+
+    limits = _limits(max_input_bytes, max_output_bytes, max_depth)
+    if _uses_native_loader(loader, loader_args, loader_kwargs):
+        return parse_items(
+            string, native=True, unicode_escape=unicode_escape, path=path, **limits
+        )
+    raw_items = parse_items(
+        string, unicode_escape=unicode_escape, path=path, as_bytes=loader_bytes, **limits
+    )
+    return _load_items(raw_items, loader, loader_args, loader_kwargs)
+
+
+def parse_many(
+    strings: Iterable[_Input],
+    unicode_escape: bool=False,
+    loader: _JsonLoader[_T_co]=json.loads,
+    loader_args: Sequence[Any] | None=None,
+    loader_kwargs: Mapping[str, Any] | None=None,
+    workers: int | None=None,
+    return_exceptions: bool=False,
+    max_input_bytes: int | None=None,
+    max_output_bytes: int | None=None,
+    max_depth: int | None=None,
+    loader_bytes: bool=False,
+) -> list[_T_co | ValueError]:
+    """
+    Extracts first JSON object encountered in every input string.
+    Inputs are parsed in parallel by a pool of native threads, without holding the GIL
+
+    Parameters
+    ----------
+    strings: iterable of str | bytes
+        Input strings
+
+    >>> parse_many(["{a: 100}", b"[1, 2, 3]"])
+    [{'a': 100}, [1, 2, 3]]
+
+    unicode_escape: bool, optional
+        Attempt to fix input strings if they contain escaped special characters
+
+    loader: func, optional
+        Function used to load processed input data, see `parse_js_object`.
+        Custom loaders are called sequentially, after parsing is done
+
+    loader_args: list, optional
+        Allow passing down positional arguments to loader function
+
+    loader_kwargs: dict, optional
+        Allow passing down keyword arguments to loader function
+
+    loader_bytes: bool, optional
+        Pass processed input data to the loader as `bytes`, see `parse_js_object`
+
+    workers: int, optional
+        Number of threads used, by default number of available CPUs
+
+    return_exceptions: bool, optional
+        Return exceptions of failed inputs in place of their results instead of raising
+
+    >>> parse_many(["[1]", "}{"], return_exceptions=True)
+    [[1], ValueError('Error parsing input near character 2')]
+
+    max_input_bytes: int, optional
+    max_output_bytes: int, optional
+    max_depth: int, optional
+        Limits applied to every input, see `parse_js_object`. Inputs going over
+        them fail with `LimitExceededError`
+
+    Returns
+    -------
+    list
+        Extracted JSON objects, in the same order as inputs
+
+    Raises
+    ------
+    ValueError
+        If failed to parse any input properly and `return_exceptions` isn't set
+    """
+    loader_args, loader_kwargs = _process_loader_arguments(
+        loader_args, loader_kwargs, None
+    )
+    if workers is None:
+        workers = getattr(os, "process_cpu_count", os.cpu_count)() or 1
+
+    native = _uses_native_loader(loader, loader_args, loader_kwargs)
+    results = parse_batch(
+        strings, native=native, unicode_escape=unicode_escape, workers=workers,
+        as_bytes=loader_bytes, **_limits(max_input_bytes, max_output_bytes, max_depth)
+    )
+    if not native:
+        for i, raw_data in enumerate(results):
+            if isinstance(raw_data, ValueError):
+                continue
+            try:
+                results[i] = loader(raw_data, *loader_args, **loader_kwargs)
+            except ValueError as e:
+                results[i] = e
+
+    if not return_exceptions:
+        for result in results:
+            if isinstance(result, ValueError):
+                raise result
+    return results
+
+
+def get_stats() -> dict[str, Any] | None:
+    """
+    Returns parser statistics gathered since the module was loaded or since
+    the last `reset_stats` call. Statistics are only collected when the
+    extension is built with them enabled:
+
+        $ CHOMPJS_STATS=1 python setup.py build_ext --inplace
+
+    Otherwise parsing doesn't pay anything for them and None is returned.
+    `parse_js_object`, `Parser.parse` and `parse_many` record every input as a
+    call, `parse_js_objects`, `parse_file` and `find_js_objects` record a whole
+    iteration as one call. Parallel `parse_js_objects` isn't recorded
+
+    Returns
+    -------
+    dict | None
+        `totals` - counters summed over all calls: bytes_scanned, bytes_emitted,
+        output_growths (reallocations of the output buffer), peak_depth (maximum
+        over all calls), unrecognized_values, quoted_values, numeric_values, comments.
+        `buckets` - calls grouped by input size, each with max_size (None for
+        the last one), calls, bytes, seconds, throughput in bytes per second and
+        latency - histogram of call wall times, bucket `i` counting calls that
+        took less than 2**(i + 1) microseconds
+    """
+    return _get_stats()
+
+
+def reset_stats() -> None:
+    """Clears statistics returned by `get_stats`"""
+    _reset_stats()
+
+
+class Parser:
+    """
+    Reusable parser carrying its options. Buffers used while parsing are kept
+    between calls and grow in place, so parsing many small documents doesn't
+    allocate anything apart from the results
+
+    Parameters
+    ----------
+    unicode_escape: bool, optional
+        Attempt to fix input string if it contains escaped special characters,
+        see `parse_js_object`
+
+    omitempty: bool, optional
+        Skip empty dictionaries and lists returned by `parse_objects`
+
+    loader: func, optional
+        Function used to load processed input data, see `parse_js_object`
+
+    loader_args: list, optional
+        Allow passing down positional arguments to loader function
+
+    loader_kwargs: dict, optional
+        Allow passing down keyword arguments to loader function
+
+    loader_bytes: bool, optional
+        Pass processed input data to the loader as `bytes`, see `parse_js_object`
+
+    cache_values: bool, optional
+        Reuse equal short string values, see `parse_js_objects`. Object keys
+        are reused between all calls of the parser
+
+    max_input_bytes: int, optional
+    max_output_bytes: int, optional
+    max_depth: int, optional
+        Limits applied to every call, see `parse_js_object`
+
+    A parser can be shared between threads, but calls made at the same time
+    use buffers from a pool instead of its own
+
+    >>> parser = Parser(unicode_escape=True)
+    >>> parser.parse('{\\"a\\": 100}')
+    {'a': 100}
+    >>> list(parser.parse_objects('{a: 1} [] {b: 2}'))
+    [{'a': 1}, [], {'b': 2}]
+    """
+
+    def __init__(
+        self,
+        unicode_escape: bool=False,
+        omitempty: bool=False,
+        loader: _JsonLoader[_T_co]=json.loads,
+        loader_args: Sequence[Any] | None=None,
+        loader_kwargs: Mapping[str, Any] | None=None,
+        cache_values: bool=False,
+        max_input_bytes: int | None=None,
+        max_output_bytes: int | None=None,
+        max_depth: int | None=None,
+        loader_bytes: bool=False,
+    ) -> None:
+        self._loader_args, self._loader_kwargs = _process_loader_arguments(
+            loader_args, loader_kwargs, None
+        )
+        self._loader = loader
+        self._unicode_escape = unicode_escape
+        self._omitempty = omitempty
+        self._cache_values = cache_values
+        self._loader_bytes = loader_bytes
+        self._limits = _limits(max_input_bytes, max_output_bytes, max_depth)
+        self._native = _uses_native_loader(loader, self._loader_args, self._loader_kwargs)
+        self._parser = create_parser()
+
+    def parse(self, string: _Input, path: str | None=None) -> _T_co:
+        """Extract first JSON object of the input, same as `parse_js_object`"""
+        if not string:
+            raise ValueError("Invalid input")
+
+        if self._native:
+            return self._parser.parse(
+                string, native=True, unicode_escape=self._unicode_escape, path=path,
+                cache_values=self._cache_values, **self._limits
+            )
+        parsed_data = self._parser.parse(
+            string, unicode_escape=self._unicode_escape, path=path, as_bytes=self._loader_bytes,
+            **self._limits
+        )
+        return self._loader(parsed_data, *self._loader_args, **self._loader_kwargs)
+
+    def stats(self) -> dict[str, Any] | None:
+        """
+        Counters of the last `parse` call, same as `totals` of `get_stats`,
+        together with its wall time in seconds. None if statistics are disabled
+        """
+        return self._parser.stats()
+
+    def parse_objects(self, string: _Input) -> Iterator[_T_co]:
+        """Iterate over all JSON objects of the input, same as `parse_js_objects`"""
+        if not string:
+            return
+
+        if self._native:
+            objects = parse_objects(
+                string, native=True, unicode_escape=self._unicode_escape,
+                cache_values=self._cache_values, **self._limits
+            )
+        else:
+            objects = _load_objects(
+                parse_objects(
+                    string, unicode_escape=self._unicode_escape, as_bytes=self._loader_bytes,
+                    **self._limits
+                ),
+                self._loader, self._loader_args, self._loader_kwargs
+            )
+
+        for data in objects:
+            if not data and self._omitempty:
+                continue
+            yield data
+
+
+class StreamParser:
+    """
+    Extracts JSON objects from input received in chunks, such as JSON Lines dumps
+    or chunked HTTP bodies. Objects can be split between chunks at any position.
+    Only data of the object being currently parsed is kept in memory
+
+    Parameters
+    ----------
+    omitempty: bool, optional
+        Skip empty dictionaries and lists
+
+    loader: func, optional
+        Function used to load processed input data, see `parse_js_objects`
+
+    loader_args: list, optional
+        Allow passing down positional arguments to loader function
+
+    loader_kwargs: dict, optional
+        Allow passing down keyword arguments to loader function
+
+    loader_bytes: bool, optional
+        Pass processed input data to the loader as `bytes`, see `parse_js_object`
+
+    max_input_bytes: int, optional
+        Maximum size of data fed but not consumed yet. `feed` raises
+        `LimitExceededError` instead of buffering more of it
+
+    max_output_bytes: int, optional
+    max_depth: int, optional
+        Limits of every object, see `parse_js_object`
+
+    Iterating over the parser yields objects completed so far. It can't be
+    fed and iterated over by two threads at once, such calls raise `ValueError`
+
+    >>> parser = StreamParser()
+    >>> parser.feed('{"a": 1}\\n{"b"')
+    >>> list(parser)
+    [{'a': 1}]
+    >>> parser.feed(': 2}')
+    >>> list(parser)
+    [{'b': 2}]
+    >>> parser.close()
+    """
+
+    def __init__(
+        self,
+        omitempty: bool=False,
+        loader: _JsonLoader[_T_co]=json.loads,
+        loader_args: Sequence[Any] | None=None,
+        loader_kwargs: Mapping[str, Any] | None=None,
+        max_input_bytes: int | None=None,
+        max_output_bytes: int | None=None,
+        max_depth: int | None=None,
+        loader_bytes: bool=False,
+    ) -> None:
+        self._loader_args, self._loader_kwargs = _process_loader_arguments(
+            loader_args, loader_kwargs, None
+        )
+        self._loader = loader
+        self._omitempty = omitempty
+        self._native = _uses_native_loader(loader, self._loader_args, self._loader_kwargs)
+        self._stream = parse_stream(
+            native=self._native, as_bytes=loader_bytes,
+            **_limits(max_input_bytes, max_output_bytes, max_depth)
+        )
+
+    def feed(self, data: _Input) -> None:
+        """Add next chunk of input"""
+        self._stream.feed(data)
+
+    def close(self) -> None:
+        """Mark the end of input. Remaining incomplete data is dropped when iterated over"""
+        self._stream.close()
+
+    def __iter__(self) -> Iterator[_T_co]:
+        if self._native:
+            objects = self._stream
+        else:
+            objects = _load_objects(
+                self._stream, self._loader, self._loader_args, self._loader_kwargs
+            )
+
+        for data in objects:
+            if not data and self._omitempty:
+                continue
+            yield data
+
+
+class ParseJob:
+    """
+    Extracts first JSON object encountered in the input string in slices, see
+    `parse_js_object` for the meaning of parameters. Every call of `advance`
+    parses a part of the input limited by a byte or time budget, so long input
+    doesn't block an event loop or any other caller that has to stay responsive
+
+    Budgets are checked between tokens of the input, a single long string can
+    go over them. The loader is run once, after the whole object is parsed
+
+    >>> job = ParseJob("{a: [1, 2, 3], b: 'text'}")
+    >>> while not job.advance(max_bytes=8):
+    ...     pass
+    >>> job.result()
+    {'a': [1, 2, 3], 'b': 'text'}
+    """
+
+    def __init__(
+        self,
+        string: _Input,
+        unicode_escape: bool=False,
+        loader: _JsonLoader[_T_co]=json.loads,
+        loader_args: Sequence[Any] | None=None,
+        loader_kwargs: Mapping[str, Any] | None=None,
+        path: str | None=None,
+        max_input_bytes: int | None=None,
+        max_output_bytes: int | None=None,
+        max_depth: int | None=None,
+        loader_bytes: bool=False,
+    ) -> None:
+        if not string:
+            raise ValueError("Invalid input")
+        self._loader_args, self._loader_kwargs = _process_loader_arguments(
+            loader_args, loader_kwargs, None
+        )
+        self._loader = loader
+        self._native = _uses_native_loader(loader, self._loader_args, self._loader_kwargs)
+        self._job = start_parse(
+            string, native=self._native, unicode_escape=unicode_escape, path=path,
+            as_bytes=loader_bytes, **_limits(max_input_bytes, max_output_bytes, max_depth)
+        )
+        self._done = False
+
+    @property
+    def position(self) -> int:
+        """Number of input bytes parsed so far"""
+        return self._job.position
+
+    @property
+    def done(self) -> bool:
+        """Whether parsing is over and `result` can be called"""
+        return self._done
+
+    def advance(self, max_bytes: int | None=None, max_seconds: float | None=None) -> bool:
+        """
+        Parse next part of the input, at most about `max_bytes` of it or for about
+        `max_seconds`. With no budget given parsing runs to the end. Returns whether
+        parsing is over
+        """
+        self._done = self._job.advance(max_bytes, max_seconds)
+        return self._done
+
+    def result(self) -> _T_co:
+        """
+        Return the extracted object. Raises `ValueError` if parsing has failed or
+        isn't finished yet
+        """
+        parsed_data = self._job.result()
+        if self._native:
+            return parsed_data
+        return self._loader(parsed_data, *self._loader_args, **self._loader_kwargs)
+
+
+async def parse_js_object_async(
+    string: _Input,
+    unicode_escape: bool=False,
+    loader: _JsonLoader[_T_co]=json.loads,
+    loader_args: Sequence[Any] | None=None,
+    loader_kwargs: Mapping[str, Any] | None=None,
+    path: str | None=None,
+    max_input_bytes: int | None=None,
+    max_output_bytes: int | None=None,
+    max_depth: int | None=None,
+    loader_bytes: bool=False,
+    slice_seconds: float=0.005,
+) -> _T_co:
+    """
+    Same as `parse_js_object`, but parses the input in slices of about
+    `slice_seconds` and lets the event loop run other tasks between them.
+    Cancelling the task stops parsing and releases the parser
+
+    >>> import asyncio
+    >>> asyncio.run(parse_js_object_async("{a: 100}"))
+    {'a': 100}
+    """
+    import asyncio
+
+    job = ParseJob(
+        string, unicode_escape=unicode_escape, loader=loader, loader_args=loader_args,
+        loader_kwargs=loader_kwargs, path=path, max_input_bytes=max_input_bytes,
+        max_output_bytes=max_output_bytes, max_depth=max_depth, loader_bytes=loader_bytes,
+    )
+    while not job.advance(max_seconds=slice_seconds):
+        await asyncio.sleep(0)
+    return job.result()
@@ -1,11 +1,22 @@
 # -*- coding: utf-8 -*-
 from __future__ import unicode_literals
 
+import asyncio
+import collections.abc
 import functools
+import json
 import math
+import os
+import re
+import tempfile
+import threading
+import time
 import unittest
 
-from chompjs import parse_js_object, parse_js_objects
+from chompjs import (
+    parse_js_object, parse_js_objects, parse_file, find_js_objects, parse_js_assignments, parse_many, iter_items,
+    get_stats, reset_stats, Parser, StreamParser, ParseJob, parse_js_object_async, LimitExceededError
+)
 
 
 def parametrize_test(*arguments_list):
@@ -164,6 +175,13 @@ class TestParser(unittest.TestCase):
         ("[-0O1234]", [-668]),
         ("[-0b1111]", [-15]),
         ("[-0B1111]", [-15]),
+        ("[0xFFFFFFFFFFFFFFFF]", [18446744073709551615]),
+        ("[0x1234567890abcdef1234567890ABCDEF]", [0x1234567890abcdef1234567890ABCDEF]),
+        ("[-0o7777777777777777777777777]", [-0o7777777777777777777777777]),
+        ("[0b" + "1" * 100 + "]", [2 ** 100 - 1]),
+        ("[0x000000000000000000000000001]", [1]),
+        ("[12345678901234567890123]", [12345678901234567890123]),
+        ("[-9223372036854775808]", [-9223372036854775808]),
     )
     def test_integer_numeric_values(self, in_data, expected_data):
         result = parse_js_object(in_data)
@@ -188,6 +206,14 @@ class TestParser(unittest.TestCase):
         ("[3.1e+12]", [3.1E+12]),
         ("[.1E-23]", [.1e-23]),
         ("[.1e-23]", [.1e-23]),
+        ("[9373.711634780513]", [9373.711634780513]),
+        ("[-522768.14276955964]", [-522768.14276955964]),
+        ("[1.7976931348623157e308]", [1.7976931348623157e308]),
+        ("[2.2250738585072014e-308]", [2.2250738585072014e-308]),
+        ("[5e-324]", [5e-324]),
+        ("[9007199254740993.0]", [9007199254740992.0]),
+        ("[0.1e1]", [1.0]),
+        ("[-0.0]", [-0.0]),
     )
     def test_float_numeric_values(self, in_data, expected_data):
         result = parse_js_object(in_data)
@@ -270,6 +296,24 @@ class TestParser(unittest.TestCase):
         result = list(parse_js_objects(in_data))
         self.assertEqual(result, expected_data)
 
+    @parametrize_test(
+        ('window["__DATA__"] = {a: 1}', {'a': 1}),
+        ("var x = items[0] || f()[1] || [2];", [2]),
+        ("<style>body { color: red; }</style><script>var x = {a: 1}</script>", {'a': 1}),
+        ("if(x) { f(a, b); var y = {b: 2}; }", {'b': 2}),
+        ("{a: ';', b: [1, 2]}", {'a': ';', 'b': [1, 2]}),
+        ("case 1:return[1,2]", [1, 2]),
+        ("var a=typeof[1]", [1]),
+        ("x = true[true,]", [True]),
+        ("for(x in[1, 2]);", [1, 2]),
+        ("throw[3]", [3]),
+        ("a.return[0] || [4]", [4]),
+        ("returns[0] || [5]", [5]),
+    )
+    def test_skipped_candidates(self, in_data, expected_data):
+        result = parse_js_object(in_data)
+        self.assertEqual(result, expected_data)
+
 
 class TestParserExceptions(unittest.TestCase):
     @parametrize_test(
@@ -283,11 +327,26 @@ class TestParserExceptions(unittest.TestCase):
 
     @parametrize_test(
         ("{whose: 's's', category_name: '>'}", ValueError),
+        ("[0x" + "f" * 4000 + "]", ValueError),
     )
     def test_malformed_input(self, in_data, expected_exception):
         with self.assertRaises(expected_exception):
             parse_js_object(in_data)
 
+    @parametrize_test(
+        ('[6 3]',),
+        ('{a: 1 2}',),
+        ('[1\n1]',),
+        ('[0x1F.5]',),
+        ('[NaN null]',),
+    )
+    def test_adjacent_values(self, in_data):
+        # values aren't joined together, neither when objects are built directly nor by a loader
+        with self.assertRaises(ValueError):
+            parse_js_object(in_data)
+        with self.assertRaises(ValueError):
+            parse_js_object(in_data, loader_kwargs={'strict': True})
+
     @parametrize_test(
         (
             '{"test": """}',
@@ -300,13 +359,67 @@ class TestParserExceptions(unittest.TestCase):
             parse_js_object(in_data)
 
 
+# offsets around 16 and 32 byte blocks read by vectorized scanning kernels
+BLOCK_OFFSETS = (15, 16, 31, 32, 33)
+
+
+class TestScanBoundaries(unittest.TestCase):
+    def assertParsed(self, in_data, expected_data):
+        self.assertEqual(parse_js_object(in_data), expected_data)
+        self.assertEqual(parse_js_object(in_data, loader_kwargs={'strict': True}), expected_data)
+
+    @parametrize_test(*[(n,) for n in BLOCK_OFFSETS])
+    def test_strings(self, n):
+        self.assertParsed('["' + 'x' * n + '"]', ['x' * n])
+        self.assertParsed('["' + 'x' * n + '\\"' + 'y' * n + '"]', ['x' * n + '"' + 'y' * n])
+        self.assertParsed('["' + 'x' * n + '\\\\"]', ['x' * n + '\\'])
+        self.assertParsed("['" + 'x' * n + '"' + "']", ['x' * n + '"'])
+        self.assertParsed('x' * n + '{"' + 'k' * n + '": 1}', {'k' * n: 1})
+
+    @parametrize_test(*[(n,) for n in BLOCK_OFFSETS])
+    def test_whitespace(self, n):
+        self.assertParsed(' ' * n + '[' + '\t' * n + '1' + '\n' * n + ']', [1])
+
+    @parametrize_test(*[(n,) for n in BLOCK_OFFSETS])
+    def test_comments(self, n):
+        self.assertParsed('/*' + 'x' * n + '*/[1]', [1])
+        self.assertParsed('/*' + 'x' * (n - 3) + '* /[2]*/[1]', [1])
+        self.assertParsed('//' + 'x' * n + '\n[1]', [1])
+        self.assertParsed('[1, /*' + 'x' * n + '*/ 2]', [1, 2])
+        self.assertParsed('[1, //' + '[' * n + '\n 2]', [1, 2])
+
+    @parametrize_test(
+        ('/* c */{"a": 1}', [{'a': 1}]),
+        ('[1] /* [2]', [[1]]),
+        ('[1] // [2]', [[1]]),
+        ('/* ' + 'x' * 40 + ' [1]', []),
+        ('// ' + 'x' * 40 + ' [1]', []),
+        ('[1, /* ' + 'x' * 40 + ' 2]', []),
+        ('[1, // ' + 'x' * 40 + ' 2]', []),
+    )
+    def test_comments_to_end(self, in_data, expected_data):
+        # unterminated comments run to the end of input
+        self.assertEqual(list(parse_js_objects(in_data)), expected_data)
+        if expected_data:
+            self.assertEqual(parse_js_object(in_data), expected_data[0])
+        else:
+            with self.assertRaises(ValueError):
+                parse_js_object(in_data)
+
+
 class TestOptions(unittest.TestCase):
     @parametrize_test(
         ('{\\\"a\\\": 12}', {'a': 12}),
+        ('{\\"a\\": \\"\u00e9\\"}', {'a': '\u00e9'}),
+        ('{\\"a\\": \\"\\u00e9\\x41\\101\\"}', {'a': '\u00e9AA'}),
+        ('[\\"\\\\\\"quoted\\\\\\"\\"]', ['"quoted"']),
+        (b'{\\"a\\": 12}', {'a': 12}),
     )
     def test_unicode_escape(self, in_data, expected_data):
         result = parse_js_object(in_data, unicode_escape=True)
         self.assertEqual(result, expected_data)
+        result = next(parse_js_objects(in_data, unicode_escape=True))
+        self.assertEqual(result, expected_data)
 
     @parametrize_test(
         ('["\n"]', ["\n"]),
@@ -338,6 +451,132 @@ class TestOptions(unittest.TestCase):
         result = parse_js_object(in_data, loader=ast.literal_eval)
         self.assertEqual(result, expected_data)
 
+    @parametrize_test(
+        ("{'a': [1, 2.5, -0, 1e400, 123456789012345678901234567890]}",),
+        ("['\\u00e9\\ud834\\udd1e\\ud800', 'a\\\\b', '\\/']",),
+        ("{a: undefined, b: function() {return '\"';}, c: [true, false, null]}",),
+        ("[{'a': 1}, {'a': 2, 'a': 3}]",),
+    )
+    def test_native_loader(self, in_data):
+        import json
+        result = parse_js_object(in_data)
+        expected = parse_js_object(in_data, loader=lambda s: json.loads(s))
+        self.assertEqual(result, expected)
+
+    @parametrize_test(
+        ("{'a': '\u0105\u20ac', b: [1, null]}", {'a': '\u0105\u20ac', 'b': [1, None]}),
+        ("var x = [1, 2,]; {c: 'x'}", [1, 2]),
+    )
+    def test_loader_bytes(self, in_data, expected_data):
+        def loader(data, *args, **kwargs):
+            self.assertIsInstance(data, bytes)
+            return json.loads(data, *args, **kwargs)
+
+        result = parse_js_object(in_data, loader=loader, loader_bytes=True)
+        self.assertEqual(result, expected_data)
+        result = next(parse_js_objects(in_data, loader=loader, loader_bytes=True, workers=2))
+        self.assertEqual(result, expected_data)
+        result = parse_many([in_data], loader=loader, loader_bytes=True)
+        self.assertEqual(result, [expected_data])
+        parser = Parser(loader=loader, loader_kwargs={'strict': True}, loader_bytes=True)
+        self.assertEqual(parser.parse(in_data), expected_data)
+        stream = StreamParser(loader=loader, loader_bytes=True)
+        stream.feed(in_data)
+        stream.close()
+        self.assertEqual(next(iter(stream)), expected_data)
+
+    @parametrize_test(
+        ('["\\x41"]', ValueError),
+        ('["\\u12"]', ValueError),
+        ('["\t"]', ValueError),
+        ('[1}', ValueError),
+        ('{{}}', ValueError),
+        ('[1,,2]', ValueError),
+    )
+    def test_native_loader_errors(self, in_data, expected_exception):
+        with self.assertRaises(expected_exception):
+            parse_js_object(in_data)
+
+
+class TestPath(unittest.TestCase):
+    data = """var x = {
+        props: {pageProps: {product: {name: 'a', tags: ['x', 'y,z']}}, "a.b": [1, {c: 2}]},
+        // props: {}
+        'list': [[1, 2], "]", {d: undefined}],
+        dup: 1, dup: 2,
+    }"""
+
+    @parametrize_test(
+        ('props.pageProps.product', {'name': 'a', 'tags': ['x', 'y,z']}),
+        ('props.pageProps.product.tags[1]', 'y,z'),
+        ('props["a.b"][1].c', 2),
+        ("props['a.b'].0", 1),
+        ('list[0]', [1, 2]),
+        ('list[2].d', 'undefined'),
+        ('dup', 2),
+    )
+    def test_path(self, in_data, expected_data):
+        result = parse_js_object(self.data, path=in_data)
+        self.assertEqual(result, expected_data)
+        result = parse_js_object(self.data, path=in_data, loader_kwargs={'strict': True})
+        self.assertEqual(result, expected_data)
+
+    @parametrize_test(
+        ('props.missing', 'Path not found: props.missing'),
+        ('list[3]', 'Path not found: list[3]'),
+        ('props.pageProps.product.name.x', 'Path not found: props.pageProps.product.name.x'),
+        ('props..x', 'Invalid path: props..x'),
+        ('list[x]', 'Invalid path: list[x]'),
+        ('', 'Invalid path: '),
+    )
+    def test_path_errors(self, in_data, expected_exception_text):
+        with self.assertRaisesRegex(ValueError, re.escape(expected_exception_text)):
+            parse_js_object(self.data, path=in_data)
+
+    @parametrize_test(
+        ("a[0]; var d = {'b': [1, 2]}", 'b', [1, 2]),
+        ("x; return[{'b': 5}]", '[0].b', 5),
+        ("<style>p { color: red; }</style> x = {b: [3]}", 'b[0]', 3),
+    )
+    def test_path_root(self, in_data, path, expected_data):
+        # path starts at the same object parsing without it returns
+        self.assertEqual(parse_js_object(in_data, path=path), expected_data)
+
+    def test_items_path_root(self):
+        self.assertEqual(list(iter_items("a[0]; var d = {'b': [1, 2]}", path='b')), [1, 2])
+
+
+class TestInputTypes(unittest.TestCase):
+    @parametrize_test(
+        (b"{'a': 12}", {'a': 12}),
+        (bytearray(b"[1, 2, 3]"), [1, 2, 3]),
+        (memoryview(b"xx{a: [1, 2]}xx")[2:13], {'a': [1, 2]}),
+        ("{'a': '\u00e9'}".encode(), {'a': '\u00e9'}),
+        ("{'\u00e9': 12}", {'\u00e9': 12}),
+    )
+    def test_parse_input_types(self, in_data, expected_data):
+        result = parse_js_object(in_data)
+        self.assertEqual(result, expected_data)
+        result = parse_js_object(in_data, loader=json.loads, loader_kwargs={'strict': True})
+        self.assertEqual(result, expected_data)
+
+    @parametrize_test(
+        (memoryview(b"[1][2][3]")[:6], [[1], [2]]),
+        (b"{'a': 1}\n{'b': 2}", [{'a': 1}, {'b': 2}]),
+    )
+    def test_parse_objects_input_types(self, in_data, expected_data):
+        result = list(parse_js_objects(in_data))
+        self.assertEqual(result, expected_data)
+
+    @parametrize_test(
+        (memoryview(b"[1, 2, 3]")[:5], ValueError),
+        (b"[tru", ValueError),
+        (12, TypeError),
+    )
+    def test_truncated_input(self, in_data, expected_exception):
+        with self.assertRaises(expected_exception):
+            parse_js_object(in_data)
+
 
 class TestParseJsonObjects(unittest.TestCase):
     @parametrize_test(
@@ -363,11 +602,19 @@ class TestParseJsonObjects(unittest.TestCase):
         ),
         ('{"a": 12, broken}{"c": 100}', [{'c': 100}]),
         ('[12,,,,21][211,,,][12,12][12,,,21]', [[12, 12]]),
+        ('{a: >] [1, 2][3]', [[1, 2], [3]]),
+        ('[true]1 [null]a', [[True], [None]]),
+        ("a { top: 0; }\nx[1] = {b: 1}; y = [2]", [{'b': 1}, [2]]),
     )
     def test_parse_json_objects(self, in_data, expected_data):
         result = list(parse_js_objects(in_data))
         self.assertEqual(result, expected_data)
 
+    def test_parse_json_objects_skips_failed_objects(self):
+        # loader isn't called with objects the parser failed on
+        result = list(parse_js_objects("[1, 2) {a: >] [3]", loader=str))
+        self.assertEqual(result, ["[3]"])
+
     @parametrize_test(
         ("[1][][2]", [[1], [2]]),
         ("{'a': 12}{}{'b': 13}", [{'a': 12}, {'b': 13}]),
@@ -378,6 +625,735 @@ class TestParseJsonObjects(unittest.TestCase):
         result = list(parse_js_objects(in_data, omitempty=True))
         self.assertEqual(result, expected_data)
 
+    @parametrize_test(
+        ('{"a": 1, "b": "x"}\n' * 60000,),
+        ("{a: [1,\n2]}\n/* [3]\n */\n[`\n`]\n{b: 'c'}" * 40000 + "\n[4",),
+        ("[1, 2][3]{}" * 100000,),
+        ("{text: it's}\n[1]",),
+    )
+    def test_parse_json_objects_in_parallel(self, in_data):
+        # str loader compares processed text of objects
+        for loader in (json.loads, str):
+            expected_data = list(parse_js_objects(in_data, loader=loader))
+            for workers in (2, 3):
+                result = list(parse_js_objects(in_data, loader=loader, workers=workers))
+                self.assertEqual(result, expected_data)
+
+
+class TestSharedStrings(unittest.TestCase):
+    @parametrize_test(
+        ("{a: 1, b: {c: 2}}\n{a: 3, b: {c: 4}}",),
+        ("[{id: 1, name: 'x'}, {id: 2, name: 'y'}, {name: 'z', id: 3}]",),
+        ("{a: 1, b: 2}\n{b: 3}\n{a: 4, b: 5}",),
+    )
+    def test_keys_are_shared(self, in_data):
+        objects = list(parse_js_objects(in_data))
+        if isinstance(objects[0], list):
+            objects = objects[0]
+        keys = {}
+        for key in self._keys(objects):
+            self.assertIs(keys.setdefault(key, key), key)
+
+    def _keys(self, data):
+        if isinstance(data, dict):
+            for key, value in data.items():
+                yield key
+                yield from self._keys(value)
+        elif isinstance(data, list):
+            for value in data:
+                yield from self._keys(value)
+
+    def test_values_are_shared(self):
+        in_data = "{a: 'on', b: 'a\\n'}\n{a: 'on', b: 'a\\n'}"
+        first, second = parse_js_objects(in_data)
+        self.assertIsNot(first['a'], second['a'])
+        first, second = parse_js_objects(in_data, cache_values=True)
+        self.assertIs(first['a'], second['a'])
+        # strings with escape sequences are never shared
+        self.assertIsNot(first['b'], second['b'])
+        self.assertEqual(first, {'a': 'on', 'b': 'a\n'})
+
+        parser = Parser(cache_values=True)
+        self.assertIs(parser.parse("['on']")[0], parser.parse("{a: 'on'}")['a'])
+
+
+class TestLimits(unittest.TestCase):
+    @parametrize_test(
+        ("[" * 100000, {'max_depth': 64}),
+        ("{a: " * 100000, {'max_depth': 64}),
+        ("[[[1]]]", {'max_depth': 2}),
+        ("['" + "x" * 100000 + "']", {'max_output_bytes': 1024}),
+        ("[" + "1, " * 100000 + "]", {'max_output_bytes': 1024}),
+        ("[" + "-" * 100000 + "1]", {'max_output_bytes': 1024}),
+        ("{'" + "a\\u0041" * 10000 + "': 1}", {'max_output_bytes': 1024}),
+        ("[1]" + " " * 2000, {'max_input_bytes': 1024}),
+    )
+    def test_limit_exceeded(self, in_data, limits):
+        for loader_kwargs in (None, {'strict': False}):
+            with self.assertRaises(LimitExceededError):
+                parse_js_object(in_data, loader_kwargs=loader_kwargs, **limits)
+            with self.assertRaises(LimitExceededError):
+                list(parse_js_objects(in_data, loader_kwargs=loader_kwargs, **limits))
+            with self.assertRaises(LimitExceededError):
+                list(parse_js_objects(in_data, loader_kwargs=loader_kwargs, workers=2, **limits))
+        result, = parse_many([in_data], return_exceptions=True, **limits)
+        self.assertIsInstance(result, LimitExceededError)
+
+    @parametrize_test(
+        ("[[[1]]]", {'max_depth': 3}, [[[1]]]),
+        ("{a: 'xyz'}", {'max_output_bytes': 11}, {'a': 'xyz'}),
+        ("{a: 'xyz'}", {'max_input_bytes': 10}, {'a': 'xyz'}),
+        ("[" * 100 + "]" * 100, {'max_depth': None}, parse_js_object("[" * 100 + "]" * 100)),
+    )
+    def test_within_limits(self, in_data, limits, expected_data):
+        self.assertEqual(parse_js_object(in_data, **limits), expected_data)
+        self.assertEqual(Parser(**limits).parse(in_data), expected_data)
+
+    def test_limits_are_per_object(self):
+        in_data = "[1, 2] [3, 4] [5, 6]"
+        self.assertEqual(list(parse_js_objects(in_data, max_output_bytes=5)), [[1, 2], [3, 4], [5, 6]])
+        with self.assertRaises(LimitExceededError):
+            list(parse_js_objects(in_data, max_output_bytes=4))
+
+    def test_invalid_limits(self):
+        with self.assertRaises(ValueError):
+            parse_js_object("[]", max_depth=-1)
+        with self.assertRaises(TypeError):
+            parse_js_object("[]", max_depth=1.5)
+
+    def test_stream_limits(self):
+        parser = StreamParser(max_input_bytes=16, max_depth=2)
+        parser.feed("[1] [[")
+        with self.assertRaises(LimitExceededError):
+            parser.feed("x" * 16)
+        parser.feed("[2]]]")
+        with self.assertRaises(LimitExceededError):
+            list(parser)
+
+
+class TestParseFile(unittest.TestCase):
+    def setUp(self):
+        fd, self.path = tempfile.mkstemp(suffix=".jsonl")
+        os.close(fd)
+
+    def tearDown(self):
+        os.remove(self.path)
+
+    def write(self, data):
+        with open(self.path, "wb") as f:
+            f.write(data.encode())
+
+    @parametrize_test(
+        ('{"a": 1}\n{"b": [1, 2]}\n', [{'a': 1}, {'b': [1, 2]}]),
+        ("var x = {a: 'ż'}; [] {c: null}", [{'a': 'ż'}, [], {'c': None}]),
+        ("", []),
+        ("No JSON objects in sight...", []),
+    )
+    def test_parse_file(self, in_data, expected_data):
+        self.write(in_data)
+        self.assertEqual(list(parse_file(self.path)), expected_data)
+        self.assertEqual(list(parse_file(self.path, loader_kwargs={'strict': True})), expected_data)
+
+    def test_parse_file_closed_early(self):
+        self.write("[1]\n" * 1000)
+        objects = parse_file(self.path, omitempty=True)
+        self.assertEqual(next(objects), [1])
+        objects.close()
+        self.write("[2]")
+        self.assertEqual(list(parse_file(self.path)), [[2]])
+
+
+class TestFindJsObjects(unittest.TestCase):
+    @parametrize_test(
+        ('{"a": 1}\n[1, 2]\n', [('{"a": 1}', False), ('[1, 2]', False)]),
+        ("var x = {a: 1}; var y = ['b'];", [("{a: 1}", True), ("['b']", True)]),
+        ('[1, 2,] [/* c */] [.5] [0x10] [1_0]', [
+            ('[1, 2,]', True), ('[/* c */]', True), ('[.5]', True), ('[0x10]', True), ('[1_0]', True),
+        ]),
+        ('{"ą": "ż"} {a: >] [1, {"b": null}] [1', [('{"ą": "ż"}', False), ('[1, {"b": null}]', False)]),
+        ("No JSON objects in sight...", []),
+        ('[1,,2] {: 1} {a:} {a: 1, :2} {a: "\\q"} [3]', [('[3]', False)]),
+        ('{a: [1,, 2], b: {c: 1}} [{d: 2}]', [('[{d: 2}]', True)]),
+    )
+    def test_find_js_objects(self, in_data, expected_data):
+        for string in (in_data, in_data.encode()):
+            result = [
+                (string[start:end], rewritten) for start, end, rewritten in find_js_objects(string)
+            ]
+            if isinstance(string, bytes):
+                result = [(data.decode(), rewritten) for data, rewritten in result]
+            self.assertEqual(result, expected_data)
+
+    @parametrize_test(
+        ('[1,,2] x {: 1} y {a:} z {a: 1, :2} [{b: [3, 4,]}, 5]',),
+        ("[true, {a: {b:}}, [4]] [1, {c: [2]}]",),
+        ('{a: [1, }] [2] {b: 1, b: 2}',),
+    )
+    def test_same_objects_as_parsed(self, in_data):
+        expected = list(parse_js_objects(in_data))
+        result = [parse_js_object(in_data[start:end]) for start, end, _ in find_js_objects(in_data)]
+        self.assertEqual(result, expected)
+
+
+def content_hash(in_data, **kwargs):
+    return parse_js_object(in_data, content_hash=True, **kwargs)[1]
+
+
+class TestContentHash(unittest.TestCase):
+    @parametrize_test(
+        ("{a: 1, b: [1, 2]}", "{'b': [1, 2], \"a\": 1}"),
+        ("{a: {x: null, y: true}, b: 'c'}", "{b: 'c', a: {y: true, x: null,},}"),
+        ('["\\u00e9\\n", "\\ud83d\\ude00"]', '["é\\n", "😀"]'),
+        ("[0x10, 'a\"b']", '[16, "a\\"b"]'),
+        ("{a: 1} // comment", "/* comment */ {a: 1}"),
+        ("{a: 1, a: 1}", "{a: 1}"),
+        ("{a: 1, b: {c: 1, c: 3}, a: 2}", "{b: {c: 3}, a: 2}"),
+        ("[{\"\\u0061\": 1, a: 2}]", "[{a: 2}]"),
+    )
+    def test_equal_hashes(self, first, second):
+        self.assertEqual(content_hash(first), content_hash(second))
+        self.assertEqual(
+            content_hash(first, loader_kwargs={'strict': True}),
+            content_hash(second, loader_kwargs={'strict': True})
+        )
+
+    @parametrize_test(
+        ("[1, 2]", "[2, 1]"),
+        ("{a: 1}", "{a: '1'}"),
+        ("{a: 1, b: 2}", "{a: 2, b: 1}"),
+        ("{a: [1]}", "{a: {1: 1}}"),
+        ("[[1], 2]", "[1, [2]]"),
+        ("[]", "{}"),
+        ("[1]", "[1.0]"),
+        ("{a: 1, a: 2}", "{a: 1}"),
+        ("{a: 1, b: 2}", "{a: 1, b: 2, b: 3}"),
+    )
+    def test_different_hashes(self, first, second):
+        self.assertNotEqual(content_hash(first), content_hash(second))
+
+    def test_hashes_of_all_apis(self):
+        in_data = "var a = {x: [1, 'y']}; broken {z: ]; var b = {\"x\": [1, \"y\"]}; [] {}"
+        expected = content_hash("{x: [1, 'y']}")
+        objects = list(parse_js_objects(in_data, content_hash=True, omitempty=True))
+        self.assertEqual(objects, [({'x': [1, 'y']}, expected)] * 2)
+        objects = list(parse_js_objects(
+            in_data, content_hash=True, omitempty=True, loader_kwargs={'strict': True}, workers=2
+        ))
+        self.assertEqual(objects, [({'x': [1, 'y']}, expected)] * 2)
+        hashes = [
+            content for start, end, _, content in find_js_objects(in_data, content_hash=True)
+            if in_data[start:end] in ("{x: [1, 'y']}", '{"x": [1, "y"]}')
+        ]
+        self.assertEqual(hashes, [expected] * 2)
+        self.assertEqual(content_hash("{b: {x: [1, 'y']}}", path='b.x'), content_hash('[1, "y"]'))
+
+
+class TestLazy(unittest.TestCase):
+    @parametrize_test(
+        ("{a: 1, b: [1, 'x', {c: null}], 'd\\u00e9': true, a: 2}",),
+        ('[[], {}, [.5, -1.5e3, 123456789012345678901234567890], "\\"q\\""]',),
+        ("{" + ", ".join("k%d: %d" % (i, i) for i in range(40)) + ", k3: 'last'}",),
+    )
+    def test_same_values(self, in_data):
+        expected = parse_js_object(in_data)
+        result = parse_js_object(in_data, lazy=True)
+        self.assertEqual(result, expected)
+        self.assertEqual(result.to_python(), expected)
+        self.assertEqual(repr(result), repr(expected))
+        self.assertEqual(len(result), len(expected))
+        if isinstance(expected, dict):
+            self.assertIsInstance(result, collections.abc.Mapping)
+            self.assertEqual(list(result), list(expected))
+            self.assertEqual(result.items(), expected.items())
+            for key, value in expected.items():
+                self.assertIn(key, result)
+                self.assertEqual(result[key], value)
+        else:
+            self.assertIsInstance(result, collections.abc.Sequence)
+            self.assertEqual(list(result), expected)
+            self.assertEqual(result[::-1], expected[::-1])
+            self.assertEqual(result[-1], expected[-1])
+
+    def test_mapping_methods(self):
+        expected = {'a': 2, 'b': [1, {'c': None}], 'd': 'x'}
+        result = parse_js_object("{a: 1, b: [1, {c: null}], d: 'x', a: 2}", lazy=True)
+        for name in dir(collections.abc.Mapping):
+            if not name.startswith('_') or name in ('__contains__', '__iter__', '__len__', '__getitem__', '__eq__', '__ne__'):
+                self.assertTrue(hasattr(result, name), name)
+        self.assertEqual(result['b'], expected['b'])
+        self.assertIn('d', result)
+        self.assertNotIn('x', result)
+        self.assertEqual(list(iter(result)), list(expected))
+        self.assertEqual(len(result), 3)
+        self.assertEqual(result.get('a'), 2)
+        self.assertEqual(result.get('x', 5), 5)
+        self.assertEqual(result.keys(), expected.keys())
+        self.assertEqual(result.keys() & {'a', 'x'}, {'a'})
+        self.assertEqual(list(result.values()), list(expected.values()))
+        self.assertIn({'c': None}, result['b'])
+        self.assertEqual(result.items(), expected.items())
+        self.assertIn(('d', 'x'), result.items())
+        self.assertTrue(result == expected)
+        self.assertFalse(result != expected)
+
+    def test_sequence_methods(self):
+        expected = [1, 'x', {'a': [2]}, 1, [3]]
+        result = parse_js_object("[1, 'x', {a: [2]}, 1, [3]]", lazy=True)
+        for name in dir(collections.abc.Sequence):
+            if not name.startswith('_') or name in ('__contains__', '__iter__', '__len__', '__getitem__', '__reversed__'):
+                self.assertTrue(hasattr(result, name), name)
+        self.assertEqual(result[2], expected[2])
+        self.assertEqual(len(result), 5)
+        self.assertEqual(list(iter(result)), expected)
+        self.assertEqual(list(reversed(result)), expected[::-1])
+        self.assertIn({'a': [2]}, result)
+        self.assertIn([3], result)
+        self.assertNotIn(2, result)
+        for args in ((1,), ('x',), ([3],), (1, 1), (1, -2), (1, 0, 3)):
+            self.assertEqual(result.index(*args), expected.index(*args))
+        for args in ((2,), (1, 1, 3), ('x', 2)):
+            with self.assertRaises(ValueError):
+                result.index(*args)
+        self.assertEqual(result.count(1), 2)
+        self.assertEqual(result.count({'a': [2]}), 1)
+        self.assertEqual(result.count(2), 0)
+
+    def test_access(self):
+        data = parse_js_object("{items: [{id: 1, tags: ['a']}, {id: 2}], 'a.b': 3}", lazy=True)
+        self.assertEqual(data['items'][0]['tags'][0], 'a')
+        self.assertEqual(data.get('a.b'), 3)
+        self.assertIsNone(data.get('missing'))
+        self.assertNotIn('missing', data)
+        self.assertNotIn(1, data)
+        with self.assertRaises(KeyError):
+            data['missing']
+        with self.assertRaises(IndexError):
+            data['items'][2]
+        with self.assertRaises(TypeError):
+            data['items']['id']
+        with self.assertRaises(TypeError):
+            data['items'] = []
+        with self.assertRaises(TypeError):
+            hash(data)
+        # proxies keep the tape alive
+        items = data['items']
+        del data
+        self.assertEqual(items[1], {'id': 2})
+
+    def test_options(self):
+        self.assertEqual(parse_js_object("{a: {b: [1, 2]}}", path='a.b', lazy=True), [1, 2])
+        self.assertEqual(parse_js_object("{a: {b: [1, 2]}}", path='a.b[1]', lazy=True), 2)
+        self.assertEqual(
+            parse_js_object("{a: 1}", lazy=True, content_hash=True), parse_js_object("{a: 1}", content_hash=True)
+        )
+        self.assertEqual(parse_js_object('{\\"a\\": 1}', unicode_escape=True, lazy=True), {'a': 1})
+
+    @parametrize_test(
+        ('[1, 2',),
+        ('{a: [1, {b: "\x01"}]}',),
+        ('["\\x"]',),
+    )
+    def test_invalid(self, in_data):
+        with self.assertRaises(ValueError):
+            parse_js_object(in_data, lazy=True)
+
+    def test_limits(self):
+        with self.assertRaises(LimitExceededError):
+            parse_js_object('[[[1]]]', max_depth=2, lazy=True)
+        with self.assertRaises(LimitExceededError):
+            parse_js_object('["abcdef"]', max_output_bytes=5, lazy=True)
+
+
+class TestParseJsAssignments(unittest.TestCase):
+    @parametrize_test(
+        ('var a = {x: 1}; let b = [1, 2]', [('a', {'x': 1}), ('b', [1, 2])]),
+        (
+            '<div>x = {}</div><script>window.__STATE__ = {"a": true};</script>',
+            [('window.__STATE__', {'a': True})],
+        ),
+        (
+            '<script>var data = JSON.parse(\'{"a": "\\\\u00e9\\\\"", "b": [1]}\');</script>',
+            [('data', {'a': '\u00e9"', 'b': [1]})],
+        ),
+        (
+            '<script type="application/json" id="__NEXT_DATA__">{"props": {"a": 1}}</script>'
+            '<script type="application/ld+json">[1]</script>',
+            [('__NEXT_DATA__', {'props': {'a': 1}}), (None, [1])],
+        ),
+        (
+            '<script>if(a == {}) {}; f = () => {}; s = "t = {a: 1}"; // u = [1]\n'
+            'x += [2]; y = {a: 1, b: [2, 3]}</script><script type="text/template">z = {}</script>',
+            [('y', {'a': 1, 'b': [2, 3]})],
+        ),
+        ('<script>a = {"x": 1}</script><script>b = [broken</script><script>c = [3]</script>', [('a', {'x': 1}), ('c', [3])]),
+    )
+    def test_parse_js_assignments(self, in_data, expected_data):
+        result = list(parse_js_assignments(in_data))
+        self.assertEqual(result, expected_data)
+        result = list(parse_js_assignments(in_data.encode(), loader_kwargs={'strict': True}))
+        self.assertEqual(result, expected_data)
+
+    @parametrize_test(
+        ({'max_depth': 2},),
+        ({'max_output_bytes': 12},),
+        ({'max_input_bytes': 30},),
+    )
+    def test_limits(self, limits):
+        in_data = '<script>a = [1]; b = JSON.parse("[[[\\"abcdefgh\\"]]]")</script>'
+        self.assertEqual(len(list(parse_js_assignments(in_data))), 2)
+        for kwargs in ({}, {'loader_kwargs': {'strict': True}}):
+            with self.assertRaises(LimitExceededError):
+                list(parse_js_assignments(in_data, **kwargs, **limits))
+
+
+class TestIterItems(unittest.TestCase):
+    @parametrize_test(
+        ('var data = [1, "a", {b: [2, 3]}, null,]', None, [1, 'a', {'b': [2, 3]}, None]),
+        ("{a: 1, 2: 'x', \"c d\": [], e: {f: .5}}", None, [('a', 1), ('2', 'x'), ('c d', []), ('e', {'f': 0.5})]),
+        ('[] [1]', None, []),
+        ('{items: [1, 2], other: [3]}', 'items', [1, 2]),
+        ('{items: [{id: 1}, {id: 2}]}', 'items[1]', [('id', 2)]),
+        ('[\\"a\\", {\\"b\\": 1}]', None, ['a', {'b': 1}], True),
+    )
+    def test_iter_items(self, in_data, path, expected_data, unicode_escape=False):
+        result = list(iter_items(in_data, path=path, unicode_escape=unicode_escape))
+        self.assertEqual(result, expected_data)
+        result = list(iter_items(
+            in_data.encode(), path=path, unicode_escape=unicode_escape, loader_kwargs={'strict': True}
+        ))
+        self.assertEqual(result, expected_data)
+
+    def test_lazy(self):
+        items = iter_items('[1, {a: 2}, [3, 4], "x"')
+        self.assertEqual(next(items), 1)
+        self.assertEqual(next(items), {'a': 2})
+        self.assertEqual(items.position, 11)
+        self.assertEqual(next(items), [3, 4])
+        # last element isn't followed by ',' or a closing bracket, it might be cut
+        with self.assertRaises(ValueError):
+            next(items)
+        with self.assertRaises(StopIteration):
+            next(items)
+
+    @parametrize_test(
+        ('[,]', []),
+        ('[ , ]', []),
+        ('{,}', {}),
+        ('[1,]', [1]),
+        ('[1,,2]', ValueError),
+        ('[,1]', ValueError),
+        ('[1,,]', ValueError),
+        ('{a: 1,,}', ValueError),
+        ('{,a: 1}', ValueError),
+    )
+    def test_commas(self, in_data, expected_data):
+        # same results as parsing the whole object
+        if expected_data is ValueError:
+            with self.assertRaises(ValueError):
+                parse_js_object(in_data)
+            with self.assertRaises(ValueError):
+                list(iter_items(in_data))
+        else:
+            self.assertEqual(parse_js_object(in_data), expected_data)
+            result = list(iter_items(in_data))
+            self.assertEqual(dict(result) if isinstance(expected_data, dict) else result, expected_data)
+
+    @parametrize_test(
+        ('', None),
+        ('no arrays here', None),
+        ('{a: [1]}', 'b'),
+        ('{a: 1}', 'a'),
+        ('{a: [1]}', 'a['),
+    )
+    def test_invalid(self, in_data, path):
+        with self.assertRaises(ValueError):
+            iter_items(in_data, path=path)
+
+    def test_limits(self):
+        items = iter_items('[[1], [[[2]]], [3]]', max_depth=2)
+        self.assertEqual(next(items), [1])
+        with self.assertRaises(LimitExceededError):
+            next(items)
+
+
+class TestParseMany(unittest.TestCase):
+    @parametrize_test(
+        ([], []),
+        (["{a: 1}", b"[1, 2]", "var x = {'b': [true]}"], [{'a': 1}, [1, 2], {'b': [True]}]),
+        (["[%d]" % i for i in range(100)], [[i] for i in range(100)]),
+    )
+    def test_parse_many(self, in_data, expected_data):
+        for workers in (1, 4):
+            result = parse_many(in_data, workers=workers)
+            self.assertEqual(result, expected_data)
+            result = parse_many(in_data, workers=workers, loader=json.loads, loader_kwargs={'strict': True})
+            self.assertEqual(result, expected_data)
+
+    def test_parse_many_errors(self):
+        in_data = ["[1]", "}{", "[2]", '["\\x"]']
+        with self.assertRaises(ValueError):
+            parse_many(in_data)
+        result = parse_many(in_data, return_exceptions=True)
+        self.assertEqual(result[0], [1])
+        self.assertIsInstance(result[1], ValueError)
+        self.assertEqual(result[2], [2])
+        self.assertIsInstance(result[3], ValueError)
+
+    def test_parse_many_options(self):
+        result = parse_many(['{\\"a\\": 1}'], unicode_escape=True)
+        self.assertEqual(result, [{'a': 1}])
+
+
+class TestReusableParser(unittest.TestCase):
+    @parametrize_test(
+        ("{a: 1}", {'a': 1}),
+        ("[" * 100 + "]" * 100, functools.reduce(lambda a, _: [a], range(99), [])),
+        ('{"a": "' + "x" * 10000 + '\\u0105"}', {'a': "x" * 10000 + "\u0105"}),
+        ("var x = [1, 2, 'ab'];", [1, 2, 'ab']),
+        ("{a: 1}", {'a': 1}),
+    )
+    def test_parser_reuse(self, in_data, expected_data):
+        for loader_kwargs in (None, {'strict': True}):
+            parser = Parser(loader_kwargs=loader_kwargs)
+            for _ in range(3):
+                self.assertEqual(parser.parse(in_data), expected_data)
+
+    def test_parser_options(self):
+        parser = Parser(unicode_escape=True, omitempty=True)
+        self.assertEqual(parser.parse('{\\"a\\": [1]}', path="a[0]"), 1)
+        self.assertEqual(list(parser.parse_objects('[1] {} {\\"b\\": 2}')), [[1], {'b': 2}])
+        with self.assertRaises(ValueError):
+            parser.parse("}{")
+        self.assertEqual(parser.parse("[2]"), [2])
+
+
+class TestStats(unittest.TestCase):
+    def test_stats_disabled(self):
+        if get_stats() is not None:
+            self.skipTest("built with CHOMPJS_STATS")
+        self.assertIsNone(Parser().stats())
+        reset_stats()
+        self.assertIsNone(get_stats())
+
+    @parametrize_test(
+        ("[[[1]]]", {'peak_depth': 3, 'numeric_values': 1, 'bytes_scanned': 7}),
+        ("{a: 'x', /* c */ b: 0x10}", {'peak_depth': 1, 'quoted_values': 1, 'comments': 1}),
+        ("var x = {a: undefined}", {'unrecognized_values': 2, 'bytes_scanned': 22}),
+    )
+    def test_parser_stats(self, in_data, expected_counters):
+        if get_stats() is None:
+            self.skipTest("built without CHOMPJS_STATS")
+        parser = Parser()
+        parser.parse(in_data)
+        stats = parser.stats()
+        for name, value in expected_counters.items():
+            self.assertEqual(stats[name], value)
+        self.assertGreater(stats['bytes_emitted'], 0)
+        self.assertGreaterEqual(stats['seconds'], 0)
+
+    def test_module_stats(self):
+        if get_stats() is None:
+            self.skipTest("built without CHOMPJS_STATS")
+        reset_stats()
+        parse_js_object("[1]")
+        list(parse_js_objects("{a: 1}\n" * 1000))
+        stats = get_stats()
+        self.assertEqual([bucket['calls'] for bucket in stats['buckets'][:2]], [1, 1])
+        self.assertEqual(stats['buckets'][1]['bytes'], 7000)
+        self.assertEqual(sum(stats['buckets'][1]['latency']), 1)
+        self.assertIsNone(stats['buckets'][-1]['max_size'])
+        self.assertEqual(stats['totals']['numeric_values'], 1001)
+        reset_stats()
+        self.assertEqual(get_stats()['totals']['numeric_values'], 0)
+
+
+class TestStreamParser(unittest.TestCase):
+    @parametrize_test(
+        ('{"a": 1}\n{"b": [1, 2]}\n', [{'a': 1}, {'b': [1, 2]}]),
+        ("var x = {a: 'x}y'}; /* [1] */ var y = [1, 2];", [{'a': 'x}y'}, [1, 2]]),
+        ('// [1]\n[2]', [[2]]),
+        ('{"a": 12, broken}{"c": 100}', [{'c': 100}]),
+        ('[1][2', [[1]]),
+        ('{{a: "x"}\n><{b: "y"}\n;', [{'a': 'x'}, {'b': 'y'}]),
+        ('x typeof[4,5]', [[4, 5]]),
+        ('{a:1}; return[4,5]', [{'a': 1}, [4, 5]]),
+        ('a = true[true,]; items[0]; b.return[1]; returns[2]', [[True]]),
+    )
+    def test_stream_parser(self, in_data, expected_data):
+        for chunk_size in (1, 3, len(in_data)):
+            for loader_kwargs in (None, {'strict': True}):
+                parser = StreamParser(loader_kwargs=loader_kwargs)
+                result = []
+                for i in range(0, len(in_data), chunk_size):
+                    parser.feed(in_data[i:i+chunk_size])
+                    result.extend(parser)
+                parser.close()
+                result.extend(parser)
+                self.assertEqual(result, expected_data)
+
+    def test_stream_parser_waits_for_complete_objects(self):
+        parser = StreamParser()
+        parser.feed(b'[1, 2')
+        self.assertEqual(list(parser), [])
+        parser.feed(b'][3]{}')
+        self.assertEqual(list(parser), [[1, 2], [3], {}])
+        parser.close()
+        with self.assertRaises(ValueError):
+            parser.feed('[4]')
+
+
+class TestParseJob(unittest.TestCase):
+    @parametrize_test(
+        ("{a: [1, 'x', {b: null}], c: 0x1F, d: 'a\\u00e9b'}",),
+        ('var x = [1, 2, 3]; var y = {"a": 1};',),
+        ("[" + ", ".join("{id: %d, name: 'item %d'}" % (i, i) for i in range(200)) + "]",),
+    )
+    def test_sliced_parsing(self, in_data):
+        for max_bytes in (1, 7, None):
+            for loader_kwargs in (None, {'strict': True}):
+                job = ParseJob(in_data, loader_kwargs=loader_kwargs)
+                while not job.advance(max_bytes=max_bytes):
+                    self.assertFalse(job.done)
+                self.assertTrue(job.done)
+                self.assertEqual(job.result(), parse_js_object(in_data))
+
+    def test_time_budget(self):
+        in_data = '[' + ', '.join(['{a: "x", b: [1, 2]}'] * 50000) + ']'
+        job = ParseJob(in_data)
+        self.assertFalse(job.advance(max_seconds=0))
+        self.assertGreater(job.position, 0)
+        while not job.advance(max_seconds=0.001):
+            pass
+        self.assertEqual(job.result(), parse_js_object(in_data))
+
+    def test_time_budget_precision(self):
+        in_data = '[' + ', '.join(['{a: "x", b: [1, 2]}'] * 50000) + ']'
+        for loader_kwargs in (None, {'strict': True}):
+            job = ParseJob(in_data, loader_kwargs=loader_kwargs)
+            durations = []
+            while True:
+                started = time.perf_counter()
+                done = job.advance(max_seconds=0.0001)
+                if done:
+                    break
+                durations.append(time.perf_counter() - started)
+            # median is used, a single slice can be delayed by the scheduler
+            durations.sort()
+            self.assertLess(durations[len(durations) // 2], 0.0005)
+            self.assertGreater(len(durations), 1)
+
+    def test_errors(self):
+        job = ParseJob('{a: 1} {b: 2')
+        with self.assertRaises(ValueError):
+            job.result()
+        self.assertTrue(job.advance())
+        self.assertEqual(job.result(), {'a': 1})
+        job = ParseJob('[[[1]]]', max_depth=2)
+        while not job.advance(max_bytes=1):
+            pass
+        for _ in range(2):
+            with self.assertRaises(LimitExceededError):
+                job.result()
+        with self.assertRaises(ValueError):
+            ParseJob('')
+
+    def test_async(self):
+        in_data = '[' + ', '.join(['{a: "x", b: [1, 2]}'] * 20000) + ']'
+        ticks = []
+
+        async def tick():
+            while True:
+                ticks.append(None)
+                await asyncio.sleep(0)
+
+        async def main():
+            ticker = asyncio.ensure_future(tick())
+            result = await parse_js_object_async(in_data, slice_seconds=0.0001)
+            ticker.cancel()
+            return result
+
+        self.assertEqual(asyncio.run(main()), parse_js_object(in_data))
+        self.assertGreater(len(ticks), 1)
+
+    def test_async_cancel(self):
+        in_data = '[' + ', '.join(['{a: "x", b: [1, 2]}'] * 20000) + ']'
+
+        async def main():
+            task = asyncio.ensure_future(parse_js_object_async(in_data, slice_seconds=0.0001))
+            await asyncio.sleep(0)
+            task.cancel()
+            with self.assertRaises(asyncio.CancelledError):
+                await task
+            return await parse_js_object_async('{a: 1}')
+
+        self.assertEqual(asyncio.run(main()), {'a': 1})
+
+
+def retry(call, *args):
+    # objects used by another thread at the same time raise ValueError, same as generators
+    while True:
+        try:
+            return call(*args)
+        except ValueError:
+            pass
+
+
+class TestThreads(unittest.TestCase):
+    def test_shared_parser(self):
+        parser = Parser(loader_kwargs={'strict': True})
+        in_data = '{a: [1, "x", {b: null}]}' * 1000
+        results = []
+
+        def parse():
+            for _ in range(50):
+                results.append(parser.parse(in_data))
+
+        threads = [threading.Thread(target=parse) for _ in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(results, [{'a': [1, 'x', {'b': None}]}] * 200)
+
+    def test_stream_parser_fed_from_another_thread(self):
+        for loader_kwargs in (None, {'strict': True}):
+            parser = StreamParser(loader_kwargs=loader_kwargs)
+
+            def feed():
+                for i in range(2000):
+                    retry(parser.feed, '[%d, "%s"]\n' % (i, "x" * (i % 100)))
+                retry(parser.close)
+
+            feeder = threading.Thread(target=feed)
+            feeder.start()
+            result = []
+            while feeder.is_alive():
+                result.extend(retry(list, parser))
+            feeder.join()
+            result.extend(parser)
+            self.assertEqual(result, [[i, "x" * (i % 100)] for i in range(2000)])
+
+    def test_subinterpreters(self):
+        try:
+            import _interpreters as interpreters
+        except ImportError:
+            try:
+                import _xxsubinterpreters as interpreters
+            except ImportError:
+                self.skipTest("subinterpreters are not available")
+        path = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        interpreter = interpreters.create()
+        try:
+            interpreters.run_string(interpreter, (
+                "import sys\n"
+                "sys.path.insert(0, %r)\n"
+                "from chompjs import parse_js_object, LimitExceededError\n"
+                "assert parse_js_object('{a: [1, 2]}') == {'a': [1, 2]}\n"
+                "assert issubclass(LimitExceededError, ValueError)\n"
+            ) % path)
+        finally:
+            interpreters.destroy(interpreter)
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -2,7 +2,7 @@
 # encoding: utf-8
 
 from io import open
-from os import path
+from os import environ, path
 from platform import system
 from setuptools import setup, Extension
 
@@ -17,9 +17,32 @@ if system() == 'Linux':
     extra_compile_args = ['-Wl,-Bsymbolic-functions']
     extra_link_args = ['-Wl,-Bsymbolic-functions']
 
+# CHOMPJS_STATS=1 builds the extension with parser statistics, see chompjs.get_stats
+define_macros = []
+if environ.get('CHOMPJS_STATS'):
+    define_macros.append(('CHOMPJS_STATS', '1'))
+
 chompjs_extension = Extension(
     '_chompjs',
-    sources=['_chompjs/module.c', '_chompjs/parser.c', '_chompjs/buffer.c'],
+    sources=[
+        '_chompjs/module.c',
+        '_chompjs/parser.c',
+        '_chompjs/buffer.c',
+        '_chompjs/builder.c',
+        '_chompjs/scan.c',
+        '_chompjs/escape.c',
+        '_chompjs/recorder.c',
+        '_chompjs/pool.c',
+        '_chompjs/tracker.c',
+        '_chompjs/html.c',
+        '_chompjs/path.c',
+        '_chompjs/chunks.c',
+        '_chompjs/stats.c',
+        '_chompjs/number.c',
+        '_chompjs/hasher.c',
+        '_chompjs/tape.c',
+    ],
+    define_macros=define_macros,
     extra_compile_args=extra_compile_args,
     extra_link_args=extra_link_args,
 )